@@ -38,6 +38,7 @@ public:
 
 	ArchiveFile* OpenFile(const char* name) override;
 	ArchiveFile *OpenFileByCrc(u32 crc) override;
+	bool isSolid() override { return true; }
 
 protected:
 	bool Open(FILE *file) override;
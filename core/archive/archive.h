@@ -37,6 +37,8 @@ public:
 	virtual ~Archive() = default;
 	virtual ArchiveFile *OpenFile(const char *name) = 0;
 	virtual ArchiveFile *OpenFileByCrc(u32 crc) = 0;
+	// Files of a solid archive can't be extracted independently
+	virtual bool isSolid() { return false; }
 
 protected:
 	virtual bool Open(FILE *file) = 0;
@@ -1,8 +1,16 @@
 #include "audiostream.h"
+#include "cfg/option.h"
 
 #include <chrono>
 #include <thread>
 
+static u64 steadyClock()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+u64 (*nullAudioClock)() = steadyClock;
+
 class NullAudioBackend : public AudioBackend
 {
 	using the_clock = std::chrono::high_resolution_clock;
@@ -14,12 +22,21 @@ public:
 	bool init() override
 	{
 		last_time = the_clock::time_point();
+		startTime = 0;
+		starving = true;
+		status = {};
+		status.capacity = std::max<u32>(SAMPLE_COUNT * 2, config::AudioBufferSize);
 		return true;
 	}
 
 	u32 push(const void* frame, u32 samples, bool wait) override
 	{
-		if (wait && last_time.time_since_epoch() != the_clock::duration::zero())
+		if (!wait)
+		{
+			simulateDevice(samples);
+			return 1;
+		}
+		if (last_time.time_since_epoch() != the_clock::duration::zero())
 		{
 			auto fduration = std::chrono::nanoseconds(1'000'000'000LL * samples / 44100);
 			auto duration = fduration - (the_clock::now() - last_time);
@@ -37,6 +54,13 @@ public:
 		return 1;
 	}
 
+	bool getBufferStatus(BufferStatus& status) override
+	{
+		simulateDevice(0);
+		status = this->status;
+		return true;
+	}
+
 	bool initRecord(u32 sampling_freq) override
 	{
 		return true;
@@ -49,6 +73,47 @@ public:
 	}
 
 private:
+	// Non-blocking mode: simulate a device buffer played at 44.1 kHz
+	void simulateDevice(u32 samples)
+	{
+		const u64 now = nullAudioClock();
+		if (startTime == 0)
+		{
+			startTime = now;
+			played = 0;
+		}
+		else
+		{
+			const u64 total = (now - startTime) * 44100 / 1'000'000;
+			const u64 frames = total - played;
+			played = total;
+			if (frames > status.queued)
+			{
+				// count each time the buffer runs dry once
+				if (!starving)
+					status.underruns++;
+				starving = true;
+				status.queued = 0;
+			}
+			else {
+				status.queued -= frames;
+			}
+		}
+		const u32 room = status.capacity - status.queued;
+		if (samples > room)
+		{
+			status.overruns += samples - room;
+			samples = room;
+		}
+		status.queued += samples;
+		if (samples != 0)
+			starving = false;
+	}
+
 	the_clock::time_point last_time;
+	u64 startTime = 0;
+	u64 played = 0;
+	bool starving = true;
+	BufferStatus status {};
 };
 static NullAudioBackend nullBackend;
@@ -18,6 +18,9 @@ class SDLAudioBackend : AudioBackend
 	uint32_t *sample_buffer;
 	unsigned sample_buffer_size = 0;
 	unsigned sample_count = 0;
+	u32 underruns = 0;
+	u32 overruns = 0;
+	bool starving = true;
 	SDL_AudioCVT audioCvt;
 
 	SDL_AudioDeviceID recorddev {};
@@ -38,6 +41,9 @@ class SDLAudioBackend : AudioBackend
 		{
 			// No data, just output a bit of silence for the underrun
 			memset(stream, 0, len);
+			if (!backend->starving)
+				backend->underruns++;
+			backend->starving = true;
 			backend->stream_mutex.unlock();
 			backend->read_wait.Set();
 			return;
@@ -59,6 +65,7 @@ class SDLAudioBackend : AudioBackend
 		// Move samples in the buffer and consume them
 		memmove(&backend->sample_buffer[0], &backend->sample_buffer[islen], (backend->sample_count - islen) * sizeof(uint32_t));
 		backend->sample_count -= islen;
+		backend->starving = false;
 
 		backend->stream_mutex.unlock();
 		backend->read_wait.Set();
@@ -81,6 +88,9 @@ public:
 		sample_buffer_size = std::max<u32>(SAMPLE_COUNT * 2, config::AudioBufferSize);
 		sample_buffer = new uint32_t[sample_buffer_size]();
 		sample_count = 0;
+		underruns = 0;
+		overruns = 0;
+		starving = true;
 
 		// Support 44.1KHz (native) but also upsampling to 48KHz
 		SDL_AudioSpec wav_spec, out_spec;
@@ -144,11 +154,22 @@ public:
 		unsigned tocopy = samples < free_samples ? samples : free_samples;
 		memcpy(&sample_buffer[sample_count], frame, tocopy * sizeof(uint32_t));
 		sample_count += tocopy;
+		overruns += samples - tocopy;
 		stream_mutex.unlock();
 
 		return 1;
 	}
 
+	bool getBufferStatus(BufferStatus& status) override
+	{
+		std::lock_guard<std::mutex> _(stream_mutex);
+		status.queued = sample_count;
+		status.capacity = sample_buffer_size;
+		status.underruns = underruns;
+		status.overruns = overruns;
+		return true;
+	}
+
 	void term() override
 	{
 		if (audiodev)
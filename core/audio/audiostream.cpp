@@ -10,6 +10,9 @@ static SoundFrame Buffer[SAMPLE_COUNT];
 static u32 writePtr;  // next sample index
 
 static AudioBackend *currentBackend;
+static bool dynamicRate;
+static bool throttling = true;
+static DynamicRateResampler resampler;
 std::vector<AudioBackend *> *AudioBackend::backends;
 
 static bool audio_recording_started;
@@ -55,12 +58,91 @@ void WriteSample(s16 r, s16 l)
 
 	if (++writePtr == SAMPLE_COUNT)
 	{
-		if (currentBackend != nullptr)
-			currentBackend->push(Buffer, SAMPLE_COUNT, config::LimitFPS);
+		if (dynamicRate)
+			resampler.write(Buffer, SAMPLE_COUNT);
+		else if (currentBackend != nullptr)
+			currentBackend->push(Buffer, SAMPLE_COUNT, config::LimitFPS && throttling);
 		writePtr = 0;
 	}
 }
 
+void SetAudioThrottling(bool enabled)
+{
+	throttling = enabled;
+}
+
+void DynamicRateResampler::init(AudioBackend *backend)
+{
+	this->backend = backend;
+	reset();
+}
+
+void DynamicRateResampler::reset()
+{
+	prev = {};
+	cur = {};
+	position = 1.f;
+	ratio = 1.f;
+	drift = 0.f;
+	outputCount = 0;
+	primed = false;
+	input.setCapacity((SAMPLE_COUNT * 2 + 1) * sizeof(Frame));
+}
+
+void DynamicRateResampler::prime()
+{
+	primed = true;
+	AudioBackend::BufferStatus status;
+	if (!backend->getBufferStatus(status))
+		return;
+	// Start with a half-full buffer
+	static const Frame silence[SAMPLE_COUNT] {};
+	for (u32 frames = status.queued; frames + SAMPLE_COUNT <= status.capacity / 2; frames += SAMPLE_COUNT)
+		backend->push(silence, SAMPLE_COUNT, false);
+}
+
+void DynamicRateResampler::updateRatio()
+{
+	AudioBackend::BufferStatus status;
+	if (!backend->getBufferStatus(status) || status.capacity == 0)
+		return;
+	// Consume input faster when the buffer is more than half full, slower otherwise.
+	// The integral term absorbs the constant difference between the emulated and host refresh rates.
+	const float error = 2.f * std::min(1.f, (float)status.queued / status.capacity) - 1.f;
+	drift = std::clamp(drift + error * IntegralGain, -MaxDeviation, MaxDeviation);
+	ratio = std::clamp(1.f + MaxDeviation * error + drift, 1.f - MaxDeviation, 1.f + MaxDeviation);
+}
+
+void DynamicRateResampler::write(const void *frames, u32 count)
+{
+	if (!primed)
+		prime();
+	if (!input.write((const u8 *)frames, count * sizeof(Frame)))
+		return;
+	for (;;)
+	{
+		while (position >= 1.f)
+		{
+			Frame next;
+			if (!input.read((u8 *)&next, sizeof(next)))
+				return;
+			prev = cur;
+			cur = next;
+			position -= 1.f;
+		}
+		Frame& out = output[outputCount];
+		out.l = (s16)(prev.l + (cur.l - prev.l) * position);
+		out.r = (s16)(prev.r + (cur.r - prev.r) * position);
+		position += ratio;
+		if (++outputCount == SAMPLE_COUNT)
+		{
+			backend->push(output, SAMPLE_COUNT, false);
+			outputCount = 0;
+			updateRatio();
+		}
+	}
+}
+
 void InitAudio()
 {
 	registerForEvents();
@@ -96,6 +178,13 @@ void InitAudio()
 		return;
 	}
 
+	AudioBackend::BufferStatus status;
+	dynamicRate = config::DynamicRateControl && currentBackend->getBufferStatus(status);
+	if (dynamicRate)
+		resampler.init(currentBackend);
+	else if (config::DynamicRateControl)
+		WARN_LOG(AUDIO, "Audio backend \"%s\" doesn't support dynamic rate control", currentBackend->slug.c_str());
+
 	if (audio_recording_started)
 	{
 		// Restart recording
@@ -114,6 +203,7 @@ void TermAudio()
 	StopAudioRecording();
 	audio_recording_started = rec_started;
 	currentBackend->term();
+	dynamicRate = false;
 	INFO_LOG(AUDIO, "Terminating audio backend \"%s\" (%s)...", currentBackend->slug.c_str(), currentBackend->name.c_str());
 	currentBackend = nullptr;
 }
@@ -152,6 +242,8 @@ static void registerForEvents()
 	// Empty the audio buffer when loading a state or terminating the game
 	const auto& callback = [](Event, void *) {
 		writePtr = 0;
+		if (dynamicRate)
+			resampler.reset();
 	};
 	EventManager::listen(Event::Terminate, callback);
 	EventManager::listen(Event::LoadState, callback);
@@ -30,6 +30,16 @@ public:
 		return nullptr;
 	}
 
+	struct BufferStatus
+	{
+		u32 queued;		// frames waiting to be played
+		u32 capacity;	// in frames
+		u32 underruns;
+		u32 overruns;	// frames dropped
+	};
+	// Used for dynamic rate control. Returns false if not supported by the backend.
+	virtual bool getBufferStatus(BufferStatus& status) { return false; }
+
 	virtual bool initRecord(u32 sampling_freq) { return false; }
 	virtual u32 record(void *, u32) { return 0; }
 	virtual void termRecord() {}
@@ -62,6 +72,8 @@ private:
 void InitAudio();
 void TermAudio();
 void WriteSample(s16 right, s16 left);
+// When disabled, the audio output never waits for the backend so the emulation runs unthrottled
+void SetAudioThrottling(bool enabled);
 
 void StartAudioRecording(bool eight_khz);
 u32 RecordAudio(void *buffer, u32 samples);
@@ -69,6 +81,9 @@ void StopAudioRecording();
 
 constexpr u32 SAMPLE_COUNT = 512;	// AudioBackend::push() is always called with that many frames
 
+// Time source of the null audio backend in microseconds. Can be replaced to simulate the audio device offline.
+extern u64 (*nullAudioClock)();
+
 class RingBuffer
 {
 	std::vector<u8> buffer;
@@ -129,3 +144,34 @@ public:
 		writeCursor = 0;
 	}
 };
+
+// Resamples the 44.1 kHz AICA output so that the backend buffer stays half full.
+// Allows pacing the emulation on the video refresh rate instead of blocking in AudioBackend::push().
+class DynamicRateResampler
+{
+public:
+	static constexpr float MaxDeviation = 0.005f;	// max resampling ratio deviation from 1
+	static constexpr float IntegralGain = 0.00001f;
+
+	void init(AudioBackend *backend);
+	void write(const void *frames, u32 count);
+	void reset();
+	float getRatio() const { return ratio; }
+
+private:
+	void prime();
+	void updateRatio();
+
+	struct Frame { s16 l; s16 r; };
+
+	AudioBackend *backend = nullptr;
+	RingBuffer input;
+	Frame prev {};
+	Frame cur {};
+	float position = 0.f;	// between prev and cur
+	float ratio = 1.f;		// input frames consumed per output frame
+	float drift = 0.f;		// long-term ratio correction
+	Frame output[SAMPLE_COUNT];
+	u32 outputCount = 0;
+	bool primed = false;
+};
@@ -3,10 +3,12 @@
 */
 
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 
 #include "cfg/cfg.h"
 #include "stdclass.h"
+#include "profiler/benchmark.h"
 
 static int setconfig(char *arg[], int cl)
 {
@@ -80,6 +82,13 @@ static int showhelp()
 	printf("-config	section:key=value     add a virtual config value;\n");
 	printf("                              virtual config values won't be saved to the .cfg file\n");
 	printf("                              unless a different value is written to them\n");
+#ifdef BENCHMARK_FRONTEND
+	printf("-benchmark frames             run the content headless for this number of frames\n");
+	printf("                              and print a timing report in json format\n");
+	printf("-benchmark-report file        write the benchmark report to this file\n");
+	printf("-benchmark-replay file        replay the controller inputs of this file during the benchmark\n");
+	printf("                              one \"frame port kcode\" entry per line, kcode in hex\n");
+#endif
 	printf("-help                         display this help\n");
 
 	exit(0);
@@ -103,6 +112,28 @@ void ParseCommandLine(int argc,char* argv[])
 			cl-=as;
 			arg+=as;
 		}
+#ifdef BENCHMARK_FRONTEND
+		else if (stricmp(*arg, "-benchmark") == 0 || stricmp(*arg, "--benchmark") == 0)
+		{
+			if (cl >= 1)
+			{
+				benchmark::options.frames = (u32)atoi(arg[1]);
+				arg++;
+				cl--;
+			}
+			if (benchmark::options.frames == 0)
+				WARN_LOG(COMMON, "-benchmark : invalid number of frames");
+		}
+		else if ((stricmp(*arg, "-benchmark-report") == 0 || stricmp(*arg, "-benchmark-replay") == 0) && cl >= 1)
+		{
+			if (stricmp(*arg, "-benchmark-report") == 0)
+				benchmark::options.reportPath = arg[1];
+			else
+				benchmark::options.replayPath = arg[1];
+			arg++;
+			cl--;
+		}
+#endif
 #if defined(__APPLE__)
 		else if (!strncmp(*arg, "-NSDocumentRevisions", 20))
 		{
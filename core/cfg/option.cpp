@@ -25,6 +25,9 @@ namespace config {
 // Dynarec
 
 Option<bool> DynarecEnabled("Dynarec.Enabled", true);
+Option<bool> DynarecBlockCache("Dynarec.BlockCache");
+Option<bool> DynarecAsyncDecode("Dynarec.AsyncDecode");
+Option<bool> DynarecSuperblocks("Dynarec.Superblocks");
 Option<int> Sh4Clock("Sh4Clock", 200);
 
 // General
@@ -35,6 +38,7 @@ Option<int> Broadcast("Dreamcast.Broadcast", 0);	// NTSC
 Option<int> Language("Dreamcast.Language", 1);		// English
 Option<bool> AutoLoadState("Dreamcast.AutoLoadState");
 Option<bool> AutoSaveState("Dreamcast.AutoSaveState");
+Option<bool> IncrementalSavestates("Dreamcast.IncrementalSavestates");
 Option<int, false> SavestateSlot("Dreamcast.SavestateSlot");
 Option<bool> ForceFreePlay("ForceFreePlay", true);
 Option<bool, false> FetchBoxart("FetchBoxart", true);
@@ -50,6 +54,7 @@ Option<int> AudioBufferSize("aica.BufferSize", 5644);	// 128 ms
 #else
 Option<int> AudioBufferSize("aica.BufferSize", 2822);	// 64 ms
 #endif
+Option<int> AudioBatchSamples("aica.BatchSamples", 1);
 Option<bool> AutoLatency("aica.AutoLatency",
 #ifdef __ANDROID__
 		true
@@ -57,6 +62,7 @@ Option<bool> AutoLatency("aica.AutoLatency",
 		false
 #endif
 		);
+Option<bool> DynamicRateControl("aica.DynamicRateControl", false);
 
 OptionString AudioBackend("backend", "auto", "audio");
 AudioVolumeOption AudioVolume;
@@ -103,9 +109,11 @@ Option<bool> IntegerScale("rend.IntegerScale", false);
 Option<bool> LinearInterpolation("rend.LinearInterpolation", true);
 Option<bool> VSync("rend.vsync", true);
 Option<int64_t> PixelBufferSize("rend.PixelBufferSize", 512_MB);
+Option<int> TextureCacheSize("rend.TextureCacheSize", 512);
 Option<int> AnisotropicFiltering("rend.AnisotropicFiltering", 1);
 Option<int> TextureFiltering("rend.TextureFiltering", 0); // Default
 Option<bool> ThreadedRendering("rend.ThreadedRendering", true);
+Option<bool> ParseAhead("rend.ParseAhead", true);
 Option<bool> DupeFrames("rend.DupeFrames", false);
 Option<int> PerPixelLayers("rend.PerPixelLayers", 32);
 #ifdef TARGET_UWP
@@ -131,12 +139,15 @@ Option<int> GDBPort("Debug.GDBPort", debugger::DEFAULT_PORT);
 Option<bool> GDBWaitForConnection("Debug.GDBWaitForConnection");
 Option<bool> UseReios("UseReios");
 Option<bool> FastGDRomLoad("FastGDRomLoad", false);
+Option<int> ChdCacheSize("ChdCacheSize", 16);
+Option<int> ChdReadAhead("ChdReadAhead", 4);
 Option<bool> RamMod32MB("Dreamcast.RamMod32MB", false);
 
 Option<bool> OpenGlChecks("OpenGlChecks", false, "validate");
 
 Option<std::vector<std::string>, false> ContentPath("Dreamcast.ContentPath");
 Option<bool, false> HideLegacyNaomiRoms("Dreamcast.HideLegacyNaomiRoms", true);
+Option<bool, false> NaomiRomCache("Dreamcast.NaomiRomCache", false);
 Option<bool, false> UploadCrashLogs("UploadCrashLogs", true);
 Option<bool, false> DiscordPresence("DiscordPresence", true);
 #if defined(__ANDROID__) && !defined(LIBRETRO)
@@ -149,6 +160,7 @@ Option<bool> ProfilerEnabled("Profiler.Enabled");
 Option<bool> ProfilerDrawToGUI("Profiler.DrawGUI");
 Option<bool> ProfilerOutputTTY("Profiler.OutputTTY");
 Option<float> ProfilerFrameWarningTime("Profiler.FrameWarningTime", 1.0f / 55.0f);
+Option<bool> ProfilerTrace("Profiler.Trace");
 
 // Network
 
@@ -350,6 +350,9 @@ using OptionString = Option<std::string>;
 // Dynarec
 
 extern Option<bool> DynarecEnabled;
+extern Option<bool> DynarecBlockCache;
+extern Option<bool> DynarecAsyncDecode;
+extern Option<bool> DynarecSuperblocks;
 #ifndef LIBRETRO
 extern Option<int> Sh4Clock;
 #endif
@@ -362,6 +365,7 @@ extern Option<int> Broadcast;	// 0 -> NTSC, 1 -> PAL, 2 -> PAL/M, 3 -> PAL/N, 4
 extern Option<int> Language;	// 0 -> JP, 1 -> EN, 2 -> DE, 3 -> FR, 4 -> SP, 5 -> IT, 6 -> default
 extern Option<bool> AutoLoadState;
 extern Option<bool> AutoSaveState;
+extern Option<bool> IncrementalSavestates;
 extern Option<int, false> SavestateSlot;
 extern Option<bool> ForceFreePlay;
 extern Option<bool, false> FetchBoxart;
@@ -375,6 +379,8 @@ constexpr bool LimitFPS = true;
 extern Option<bool> DSPEnabled;
 extern Option<int> AudioBufferSize;	//In samples ,*4 for bytes
 extern Option<bool> AutoLatency;
+extern Option<bool> DynamicRateControl;
+extern Option<int> AudioBatchSamples;	// Samples generated per AICA update. 1 is sample accurate
 
 extern OptionString AudioBackend;
 
@@ -464,9 +470,11 @@ extern Option<bool> IntegerScale;
 extern Option<bool> LinearInterpolation;
 extern Option<bool> VSync;
 extern Option<int64_t> PixelBufferSize;
+extern Option<int> TextureCacheSize;	// in MB, 0 for unlimited
 extern Option<int> AnisotropicFiltering;
 extern Option<int> TextureFiltering; // 0: default, 1: force nearest, 2: force linear
 extern Option<bool> ThreadedRendering;
+extern Option<bool> ParseAhead;	// Parse the next TA context on a worker thread while rendering
 extern Option<bool> DupeFrames;
 extern Option<bool> NativeDepthInterpolation;
 extern Option<bool> EmulateFramebuffer;
@@ -487,12 +495,15 @@ extern Option<int> GDBPort;
 extern Option<bool> GDBWaitForConnection;
 extern Option<bool> UseReios;
 extern Option<bool> FastGDRomLoad;
+extern Option<int> ChdCacheSize;	// in hunks
+extern Option<int> ChdReadAhead;	// in hunks
 extern Option<bool> RamMod32MB;
 
 extern Option<bool> OpenGlChecks;
 
 extern Option<std::vector<std::string>, false> ContentPath;
 extern Option<bool, false> HideLegacyNaomiRoms;
+extern Option<bool, false> NaomiRomCache;
 extern Option<bool, false> UploadCrashLogs;
 extern Option<bool, false> DiscordPresence;
 #if defined(__ANDROID__) && !defined(LIBRETRO)
@@ -505,6 +516,7 @@ extern Option<bool> ProfilerEnabled;
 extern Option<bool> ProfilerDrawToGUI;
 extern Option<bool> ProfilerOutputTTY;
 extern Option<float> ProfilerFrameWarningTime;
+extern Option<bool> ProfilerTrace;
 
 // Network
 
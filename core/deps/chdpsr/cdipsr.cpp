@@ -4,11 +4,6 @@
 #include <errno.h>
 #include "cdipsr.h"
 
-// Global variables
-
-unsigned long temp_value;
-
-
 /////////////////////////////////////////////////////////////////////////////
 
 unsigned long ask_type(FILE *fsource, long header_position)
@@ -16,6 +11,7 @@ unsigned long ask_type(FILE *fsource, long header_position)
 
 unsigned char filename_length;
 unsigned long track_mode;
+unsigned long temp_value = 0;
 
     fseek(fsource, header_position, SEEK_SET);
     fread(&temp_value, 4, 1, fsource);
@@ -43,6 +39,7 @@ bool CDI_read_track (FILE *fsource, image_s *image, track_s *track)
 
      unsigned char TRACK_START_MARK[10] = { 0, 0, 0x01, 0, 0, 0, 0xFF, 0xFF, 0xFF, 0xFF };
      unsigned char current_start_mark[10];
+     unsigned long temp_value = 0;
 
          fread(&temp_value, 4, 1, fsource);
          if (temp_value != 0)
@@ -41,6 +41,7 @@
 #include "serialize.h"
 #include "hw/pvr/pvr.h"
 #include "profiler/fc_profiler.h"
+#include "profiler/benchmark.h"
 #include "oslib/storage.h"
 #include "wsi/context.h"
 #include <chrono>
@@ -694,6 +695,7 @@ void Emulator::loadGame(const char *path, LoadProgress *progress)
 
 void Emulator::runInternal()
 {
+	benchmark::Scope _(benchmark::Section::Sh4);
 	if (singleStep)
 	{
 		getSh4Executor()->Step();
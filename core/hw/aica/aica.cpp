@@ -7,6 +7,8 @@
 #include "hw/sh4/sh4_sched.h"
 #include "hw/arm7/arm7.h"
 #include "hw/arm7/arm_mem.h"
+#include "cfg/option.h"
+#include "profiler/benchmark.h"
 
 namespace aica
 {
@@ -84,11 +86,16 @@ AicaTimer timers[3];
 int aica_schid = -1;
 constexpr int AICA_TICK = 4535;		// 44.1 KHz
 
+// The ARM7 and timers are stepped for each sample, then all the samples are mixed at once.
+// Register writes and reads within a batch are thus only accurate to the batch size.
 static int AicaUpdate(int tag, int cycles, int jitter, void *arg)
 {
-	arm::run(1);
+	benchmark::Scope _(benchmark::Section::Aica);
+	const int samples = std::clamp((int)config::AudioBatchSamples, 1, sgc::MaxBatchSamples);
+	arm::run(samples);
+	sgc::AICA_Sample(samples);
 
-	return AICA_TICK;
+	return AICA_TICK * samples;
 }
 
 //Mainloop
@@ -101,8 +108,6 @@ void timeStep()
 	SCIPD->SAMPLE_DONE = 1;
 	MCIPD->SAMPLE_DONE = 1;
 
-	sgc::AICA_Sample();
-
 	//Make sure sh4/arm interrupt system is up to date
 	update_arm_interrupts();
 	UpdateSh4Ints();	
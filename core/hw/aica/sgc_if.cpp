@@ -30,6 +30,13 @@
 
 #include <algorithm>
 #include <cmath>
+#if HOST_CPU == CPU_X64
+#include <emmintrin.h>
+#define SGC_SIMD
+#elif HOST_CPU == CPU_ARM64
+#include <arm_neon.h>
+#define SGC_SIMD
+#endif
 
 #undef FAR
 
@@ -128,6 +135,113 @@ static T FPMul(T a, T b, int bits) {
 	return (a * b) >> bits;
 }
 
+bool mixFastPath = true;
+
+// Apply the volumes to a channel sample. If the direct output is muted and the DSP is disabled,
+// the DSP send is used instead.
+static void applyVolumes(SampleType sample, s32 left, s32 right, s32 dsp, bool dspEnabled,
+		SampleType& oLeft, SampleType& oRight, SampleType& oDsp)
+{
+	oLeft = FPMul(sample, left, 15);
+	oRight = FPMul(sample, right, 15);
+	oDsp = FPMul(sample, dsp, 11);	// 20 bits
+
+	clip_verify(((s16)oLeft)==oLeft);
+	clip_verify(((s16)oRight)==oRight);
+	clip_verify((oDsp << 12) >> 12 == oDsp);
+	clip_verify(sample*oLeft>=0);
+	clip_verify(sample*oRight>=0);
+	clip_verify((s64)sample*oDsp>=0);
+
+	if (oLeft + oRight == 0 && !dspEnabled)
+		oLeft = oRight = oDsp >> 4;
+}
+
+#if HOST_CPU == CPU_X64
+// SSE2 has no 32-bit multiply. The low 32 bits of the product are the same for signed and unsigned operands.
+static __m128i mullo32(__m128i a, __m128i b)
+{
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+			_mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+#endif
+
+void mixChannel(const SampleType *samples, const s32 *left, const s32 *right, const s32 *dsp, u32 count,
+		SampleType *mixl, SampleType *mixr, SampleType *mixs, bool dspEnabled)
+{
+	u32 i = 0;
+#ifdef SGC_SIMD
+	if (mixFastPath)
+	{
+#if HOST_CPU == CPU_X64
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i dspMask = dspEnabled ? zero : _mm_set1_epi32(-1);
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128i sample = _mm_loadu_si128((const __m128i *)&samples[i]);
+			__m128i oLeft = _mm_srai_epi32(mullo32(sample, _mm_loadu_si128((const __m128i *)&left[i])), 15);
+			__m128i oRight = _mm_srai_epi32(mullo32(sample, _mm_loadu_si128((const __m128i *)&right[i])), 15);
+			const __m128i oDsp = _mm_srai_epi32(mullo32(sample, _mm_loadu_si128((const __m128i *)&dsp[i])), 11);
+			// direct output muted: use the DSP send instead if the DSP is disabled
+			const __m128i mute = _mm_and_si128(_mm_cmpeq_epi32(_mm_add_epi32(oLeft, oRight), zero), dspMask);
+			const __m128i dry = _mm_and_si128(_mm_srai_epi32(oDsp, 4), mute);
+			oLeft = _mm_or_si128(_mm_andnot_si128(mute, oLeft), dry);
+			oRight = _mm_or_si128(_mm_andnot_si128(mute, oRight), dry);
+			_mm_storeu_si128((__m128i *)&mixl[i], _mm_add_epi32(_mm_loadu_si128((const __m128i *)&mixl[i]), oLeft));
+			_mm_storeu_si128((__m128i *)&mixr[i], _mm_add_epi32(_mm_loadu_si128((const __m128i *)&mixr[i]), oRight));
+			_mm_storeu_si128((__m128i *)&mixs[i], _mm_add_epi32(_mm_loadu_si128((const __m128i *)&mixs[i]), oDsp));
+		}
+#else
+		const uint32x4_t dspMask = vdupq_n_u32(dspEnabled ? 0 : ~0u);
+		for (; i + 4 <= count; i += 4)
+		{
+			const int32x4_t sample = vld1q_s32(&samples[i]);
+			int32x4_t oLeft = vshrq_n_s32(vmulq_s32(sample, vld1q_s32(&left[i])), 15);
+			int32x4_t oRight = vshrq_n_s32(vmulq_s32(sample, vld1q_s32(&right[i])), 15);
+			const int32x4_t oDsp = vshrq_n_s32(vmulq_s32(sample, vld1q_s32(&dsp[i])), 11);
+			// direct output muted: use the DSP send instead if the DSP is disabled
+			const uint32x4_t mute = vandq_u32(vceqq_s32(vaddq_s32(oLeft, oRight), vdupq_n_s32(0)), dspMask);
+			const int32x4_t dry = vshrq_n_s32(oDsp, 4);
+			oLeft = vbslq_s32(mute, dry, oLeft);
+			oRight = vbslq_s32(mute, dry, oRight);
+			vst1q_s32(&mixl[i], vaddq_s32(vld1q_s32(&mixl[i]), oLeft));
+			vst1q_s32(&mixr[i], vaddq_s32(vld1q_s32(&mixr[i]), oRight));
+			vst1q_s32(&mixs[i], vaddq_s32(vld1q_s32(&mixs[i]), oDsp));
+		}
+#endif
+	}
+#endif
+	for (; i < count; i++)
+	{
+		SampleType oLeft, oRight, oDsp;
+		applyVolumes(samples[i], left[i], right[i], dsp[i], dspEnabled, oLeft, oRight, oDsp);
+		mixl[i] += oLeft;
+		mixr[i] += oRight;
+		mixs[i] += oDsp;
+	}
+}
+
+// The DSP sends are scattered to their DSP input. This dominates, so this isn't vectorized.
+void mixChannels(const SampleType *samples, const s32 *left, const s32 *right, const s32 *dsp, const u32 *isel, u32 count,
+		SampleType& mixl, SampleType& mixr, SampleType *mixs, bool dspEnabled)
+{
+	// Accumulate locally since mixl and mixr could alias mixs
+	SampleType suml = 0;
+	SampleType sumr = 0;
+	for (u32 i = 0; i < count; i++)
+	{
+		SampleType oLeft, oRight, oDsp;
+		applyVolumes(samples[i], left[i], right[i], dsp[i], dspEnabled, oLeft, oRight, oDsp);
+		suml += oLeft;
+		sumr += oRight;
+		mixs[isel[i]] += oDsp;
+	}
+	mixl += suml;
+	mixr += sumr;
+}
+
 static void VolumePan(SampleType value, u32 vol, u32 pan, SampleType& outl, SampleType& outr)
 {
 	SampleType temp = FPMul(value, volume_lut[vol], 15);
@@ -546,100 +660,105 @@ struct ChannelEx
 		return rv;
 	}
 
-	bool Step(SampleType& oLeft, SampleType& oRight, SampleType& oDsp)
+	// Generate the next sample and its left, right and DSP send volumes, then step the channel.
+	// The channel must be enabled.
+	void Generate(SampleType& sample, s32& left, s32& right, s32& dsp)
 	{
-		if (!enabled)
-		{
-			oLeft=oRight=oDsp=0;
-			return false;
-		}
-		else
-		{
-			SampleType sample = InterpolateSample();
-
-			// Low-pass filter
-			if (FEG.active)
-			{
-				u32 fv = FEG.GetValue();
-				s32 f = (((fv & 0x1FF) | 0x200) << 3) >> ((fv >> 9) ^ 0xF);
-				if (f == 0) {
-					sample = 0;
-				}
-				else
-				{
-					sample = f * sample + (0x2000 - f + FEG.q) * FEG.prev1 - FEG.q * FEG.prev2;
-					sample >>= 13;
-					sample = std::clamp(sample, -32768, 32767);
-				}
-				FEG.prev2 = FEG.prev1;
-				FEG.prev1 = sample;
-			}
-
-			//Volume & Mixer processing
-			//All attenuations are added together then applied and mixed :)
+		sample = InterpolateSample();
 
-			//offset is up to 511
-			//*Att is up to 511
-			//logtable handles up to 1024, anything >=255 is mute
-
-			u32 ofsatt;
-			if (ccd->VOFF == 1)
-			{
-				ofsatt = 0;
+		// Low-pass filter
+		if (FEG.active)
+		{
+			u32 fv = FEG.GetValue();
+			s32 f = (((fv & 0x1FF) | 0x200) << 3) >> ((fv >> 9) ^ 0xF);
+			if (f == 0) {
+				sample = 0;
 			}
 			else
 			{
-				ofsatt = lfo.alfo + (AEG.GetValue() >> 2);
-				ofsatt = std::min(ofsatt, (u32)255); // make sure it never gets more 255 -- it can happen with some alfo/aeg combinations
+				sample = f * sample + (0x2000 - f + FEG.q) * FEG.prev1 - FEG.q * FEG.prev2;
+				sample >>= 13;
+				sample = std::clamp(sample, -32768, 32767);
 			}
-			u32 const max_att = ((16 << 4) - 1) - ofsatt;
-			
-			s32* logtable = ofsatt + tl_lut;
-
-			u32 dl = std::min(VolMix.DLAtt, max_att);
-			u32 dr = std::min(VolMix.DRAtt, max_att);
-			u32 ds = std::min(VolMix.DSPAtt, max_att);
+			FEG.prev2 = FEG.prev1;
+			FEG.prev1 = sample;
+		}
 
-			oLeft = FPMul(sample, logtable[dl], 15);
-			oRight = FPMul(sample, logtable[dr], 15);
-			oDsp = FPMul(sample, logtable[ds], 11);	// 20 bits
+		//Volume & Mixer processing
+		//All attenuations are added together then applied and mixed :)
 
-			clip_verify(((s16)oLeft)==oLeft);
-			clip_verify(((s16)oRight)==oRight);
-			clip_verify((oDsp << 12) >> 12 == oDsp);
-			clip_verify(sample*oLeft>=0);
-			clip_verify(sample*oRight>=0);
-			clip_verify((s64)sample*oDsp>=0);
+		//offset is up to 511
+		//*Att is up to 511
+		//logtable handles up to 1024, anything >=255 is mute
 
-			StepAEG(this);
-			if (enabled)
-			{
-				StepFEG(this);
-				StepStream(this);
-				lfo.Step(this);
-			}
-			return true;
+		u32 ofsatt;
+		if (ccd->VOFF == 1)
+		{
+			ofsatt = 0;
 		}
-	}
+		else
+		{
+			ofsatt = lfo.alfo + (AEG.GetValue() >> 2);
+			ofsatt = std::min(ofsatt, (u32)255); // make sure it never gets more 255 -- it can happen with some alfo/aeg combinations
+		}
+		u32 const max_att = ((16 << 4) - 1) - ofsatt;
 
-	void Step(SampleType& mixl, SampleType& mixr)
-	{
-		SampleType oLeft,oRight,oDsp;
+		s32* logtable = ofsatt + tl_lut;
 
-		Step(oLeft, oRight, oDsp);
+		left = logtable[std::min(VolMix.DLAtt, max_att)];
+		right = logtable[std::min(VolMix.DRAtt, max_att)];
+		dsp = logtable[std::min(VolMix.DSPAtt, max_att)];
 
-		*VolMix.DSPOut += oDsp;
-		if (oLeft + oRight == 0 && !config::DSPEnabled)
-			oLeft = oRight = oDsp >> 4;
+		StepAEG(this);
+		if (enabled)
+		{
+			StepFEG(this);
+			StepStream(this);
+			lfo.Step(this);
+		}
+	}
 
-		mixl+=oLeft;
-		mixr+=oRight;
+	// Generate up to count samples and mix them. Stops early if the channel gets disabled.
+	void Mix(u32 count, SampleType *mixl, SampleType *mixr, SampleType *mixs)
+	{
+		SampleType samples[MaxBatchSamples];
+		s32 left[MaxBatchSamples];
+		s32 right[MaxBatchSamples];
+		s32 dsp[MaxBatchSamples];
+		u32 n = 0;
+		for (; n < count && enabled; n++)
+			Generate(samples[n], left[n], right[n], dsp[n]);
+		mixChannel(samples, left, right, dsp, n, mixl, mixr, mixs, config::DSPEnabled);
 	}
 
-	static void StepAll(SampleType& mixl, SampleType& mixr)
+	// Channels are independent so each one is stepped for all the samples before moving to the next one.
+	// Channel registers can't change in between.
+	static void StepAll(u32 count, SampleType *mixl, SampleType *mixr, SampleType (*mixs)[MaxBatchSamples])
 	{
+		if (count == 1)
+		{
+			// Sample accurate: mix all the enabled channels at once
+			SampleType samples[64];
+			s32 left[64], right[64], dspSend[64];
+			u32 isel[64];
+			u32 n = 0;
+			for (ChannelEx& channel : Chans)
+			{
+				if (!channel.enabled)
+					continue;
+				isel[n] = channel.VolMix.DSPOut - dsp::state.MIXS;
+				channel.Generate(samples[n], left[n], right[n], dspSend[n]);
+				n++;
+			}
+			SampleType sends[16] {};
+			mixChannels(samples, left, right, dspSend, isel, n, mixl[0], mixr[0], sends, config::DSPEnabled);
+			for (int i = 0; i < 16; i++)
+				mixs[i][0] += sends[i];
+			return;
+		}
 		for (ChannelEx& channel : Chans)
-			channel.Step(mixl, mixr);
+			if (channel.enabled)
+				channel.Mix(count, mixl, mixr, mixs[channel.VolMix.DSPOut - dsp::state.MIXS]);
 	}
 
 	void SetAegState(_EG_state newstate)
@@ -1468,15 +1587,8 @@ constexpr int CDDA_SIZE = 2352 / 2;
 static s16 cdda_sector[CDDA_SIZE];
 static u32 cdda_index = CDDA_SIZE;
 
-void AICA_Sample()
+static void FinalMix(SampleType mixl, SampleType mixr)
 {
-	SampleType mixl,mixr;
-	mixl = 0;
-	mixr = 0;
-	memset(dsp::state.MIXS, 0, sizeof(dsp::state.MIXS));
-
-	ChannelEx::StepAll(mixl,mixr);
-	
 	//OK , generated all Channels  , now DSP/ect + final mix ;p
 	//CDDA EXTS input
 	
@@ -1552,6 +1664,28 @@ void AICA_Sample()
 	WriteSample(mixr,mixl);
 }
 
+void AICA_Sample(u32 count)
+{
+	verify(count <= MaxBatchSamples);
+	SampleType mixl[MaxBatchSamples];
+	SampleType mixr[MaxBatchSamples];
+	// Indexed by DSP input (ISEL) first
+	SampleType mixs[16][MaxBatchSamples];
+	memset(mixl, 0, count * sizeof(SampleType));
+	memset(mixr, 0, count * sizeof(SampleType));
+	for (auto& m : mixs)
+		memset(m, 0, count * sizeof(SampleType));
+
+	ChannelEx::StepAll(count, mixl, mixr, mixs);
+
+	for (u32 i = 0; i < count; i++)
+	{
+		for (int j = 0; j < 16; j++)
+			dsp::state.MIXS[j] = mixs[j][i];
+		FinalMix(mixl[i], mixr[i]);
+	}
+}
+
 void serialize(Serializer& ser)
 {
 	for (const ChannelEx& channel : Chans)
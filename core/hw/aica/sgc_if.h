@@ -4,10 +4,26 @@
 namespace aica::sgc
 {
 
-void AICA_Sample();
+// Maximum number of samples generated at once by AICA_Sample
+constexpr int MaxBatchSamples = 64;
+// Mix and output count stereo samples
+void AICA_Sample(u32 count = 1);
 
 void WriteChannelReg(u32 channel, u32 reg, int size);
 
+typedef s32 SampleType;
+
+// Apply the left, right and DSP send volumes to count samples of a channel and add them
+// to the mix buffers
+void mixChannel(const SampleType *samples, const s32 *left, const s32 *right, const s32 *dsp, u32 count,
+		SampleType *mixl, SampleType *mixr, SampleType *mixs, bool dspEnabled);
+// Apply the left, right and DSP send volumes to the current sample of count channels.
+// The direct outputs are added to mixl and mixr, and the DSP sends to mixs[isel[channel]].
+void mixChannels(const SampleType *samples, const s32 *left, const s32 *right, const s32 *dsp, const u32 *isel, u32 count,
+		SampleType& mixl, SampleType& mixr, SampleType *mixs, bool dspEnabled);
+// Use the SIMD implementation of mixChannel when available
+extern bool mixFastPath;
+
 void init();
 void term();
 
@@ -39,8 +55,6 @@ union fp_20_12
 	u32 full;
 };
 
-typedef s32 SampleType;
-
 void ReadCommonReg(u32 reg, bool byte);
 void serialize(Serializer& ctx);
 void deserialize(Deserializer& ctx);
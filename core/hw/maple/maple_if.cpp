@@ -6,6 +6,7 @@
 #include "hw/sh4/sh4_mem.h"
 #include "hw/sh4/sh4_sched.h"
 #include "network/ggpo.h"
+#include "profiler/benchmark.h"
 #include "hw/naomi/card_reader.h"
 
 #ifdef USE_DREAMLINK_DEVICES
@@ -159,6 +160,10 @@ static void maple_DoDma()
 #endif
 
 	ggpo::getInput(mapleInputState);
+#ifndef LIBRETRO
+	if (benchmark::enabled())
+		benchmark::getInput(mapleInputState);
+#endif
 	// TODO put this elsewhere and let the card readers handle being called multiple times
 	if (settings.platform.isNaomi())
 	{
@@ -22,11 +22,30 @@
 namespace memwatch
 {
 
+PageArena pageArena;
 VramWatcher vramWatcher;
 RamWatcher ramWatcher;
 AicaRamWatcher aramWatcher;
 ElanRamWatcher elanWatcher;
 
+void PageArena::grow()
+{
+	u8 *chunk = new u8[PAGES_PER_CHUNK * PAGE_SIZE];
+	chunks.emplace_back(chunk);
+	// so that release() never allocates
+	freePages.reserve(capacity());
+	for (size_t i = 0; i < PAGES_PER_CHUNK; i++)
+		freePages.push_back(chunk + i * PAGE_SIZE);
+}
+
+void PageArena::clear()
+{
+	verify(freePages.size() == capacity());
+	freePages.clear();
+	freePages.shrink_to_fit();
+	chunks.clear();
+}
+
 void AicaRamWatcher::protectMem(u32 addr, u32 size)
 {
 	size = std::min(ARAM_SIZE - addr, size) & ~PAGE_MASK;
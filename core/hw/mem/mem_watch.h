@@ -27,13 +27,64 @@
 #include "rend/TexCache.h"
 #include <unordered_map>
 #include <memory>
+#include <vector>
 
 namespace memwatch
 {
 
+// Page copies are allocated in large chunks and recycled to avoid allocator churn during rollbacks
+class PageArena
+{
+public:
+	u8 *alloc()
+	{
+		if (freePages.empty())
+			grow();
+		u8 *page = freePages.back();
+		freePages.pop_back();
+		return page;
+	}
+
+	void release(u8 *page) {
+		freePages.push_back(page);
+	}
+
+	size_t capacity() const {
+		return chunks.size() * PAGES_PER_CHUNK;
+	}
+	size_t available() const {
+		return freePages.size();
+	}
+	// Free all memory. All pages must have been released.
+	void clear();
+
+private:
+	void grow();
+
+	static constexpr size_t PAGES_PER_CHUNK = 256;
+	std::vector<std::unique_ptr<u8[]>> chunks;
+	std::vector<u8 *> freePages;
+};
+extern PageArena pageArena;
+
 struct Page
 {
-	std::unique_ptr<u8[]> data = std::make_unique<u8[]>(PAGE_SIZE);
+	Page() : data(pageArena.alloc()) {}
+	Page(Page&& other) noexcept : data(other.data) {
+		other.data = nullptr;
+	}
+	Page(const Page&) = delete;
+	Page& operator=(Page&& other) noexcept {
+		std::swap(data, other.data);
+		return *this;
+	}
+	Page& operator=(const Page&) = delete;
+	~Page() {
+		if (data != nullptr)
+			pageArena.release(data);
+	}
+
+	u8 *data;
 };
 using PageMap = std::unordered_map<u32, Page>;
 
@@ -21,7 +21,10 @@
 #include "serialize.h"
 #include "hw/sh4/sh4_sched.h"
 #include "naomi.h"
+#include "oslib/oslib.h"
+#include "util/worker_thread.h"
 #include <algorithm>
+#include <chrono>
 
 /*
 
@@ -450,13 +453,15 @@ void GDCartridge::read_gdrom(Disc *gdrom, u32 sector, u8* dst, u32 count, LoadPr
 
 void GDCartridge::device_start(LoadProgress *progress, std::vector<u8> *digest)
 {
+	stopPrefetch();
 	if (dimm_data != NULL)
 	{
 		free(dimm_data);
 		dimm_data = NULL;
 	}
 	dimm_data_size = 0;
-	loadedSegments.clear();
+	segments.reset();
+	segmentCount = 0;
 
 	char name[128];
 	memset(name,'\0',128);
@@ -597,9 +602,11 @@ void GDCartridge::device_start(LoadProgress *progress, std::vector<u8> *digest)
 			if (dimm_data_size != file_rounded_size)
 				memset(dimm_data + file_rounded_size, 0, dimm_data_size - file_rounded_size);
 
-			loadedSegments.resize(dimm_data_size / SEGMENT_SIZE);
-			std::fill(loadedSegments.begin() + (file_rounded_size + SEGMENT_SIZE - 1) / SEGMENT_SIZE,
-					loadedSegments.end(), true);
+			segmentCount = dimm_data_size / SEGMENT_SIZE;
+			segments = std::make_unique<std::atomic<u8>[]>(segmentCount);
+			const u32 fileSegments = (file_rounded_size + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
+			for (u32 i = 0; i < segmentCount; i++)
+				segments[i] = i < fileSegments ? SegNotLoaded : SegLoaded;
 
 			des_generate_subkeys(rev64(key), des_subkeys);
 		}
@@ -609,27 +616,181 @@ void GDCartridge::device_start(LoadProgress *progress, std::vector<u8> *digest)
 	}
 }
 
+void GDCartridge::readSegment(u32 segment)
+{
+	std::lock_guard<std::mutex> _(gdromMutex);
+	read_gdrom(gdrom.get(), file_start + (segment * SEGMENT_SIZE) / 2048,
+			dimm_data + segment * SEGMENT_SIZE,
+			SEGMENT_SIZE / 2048,
+			nullptr);
+}
+
+void GDCartridge::decryptSegment(u32 segment)
+{
+	u64 *pData = (u64 *)(dimm_data + segment * SEGMENT_SIZE);
+	for (u32 i = 0; i < SEGMENT_SIZE; i += 8, pData++)
+		*pData = des_encrypt_decrypt<true>(*pData, des_subkeys);
+}
+
+// Large loads are decrypted concurrently by several threads
+void GDCartridge::decryptSegments(const std::vector<u32>& list)
+{
+	const u32 threadCount = std::min<u32>(DECRYPT_THREADS, std::thread::hardware_concurrency());
+	if (list.size() < PARALLEL_DECRYPT_SEGMENTS || threadCount < 2)
+	{
+		for (u32 segment : list)
+			decryptSegment(segment);
+		return;
+	}
+	while (decryptThreads.size() < threadCount - 1)
+		decryptThreads.push_back(std::make_unique<WorkerThread>("GDDecrypt"));
+
+	const size_t chunk = (list.size() + threadCount - 1) / threadCount;
+	std::vector<std::future<void>> futures;
+	for (u32 i = 0; i < threadCount - 1; i++)
+	{
+		const size_t begin = std::min(list.size(), (i + 1) * chunk);
+		const size_t end = std::min(list.size(), begin + chunk);
+		futures.push_back(decryptThreads[i]->runFuture([this, &list, begin, end]() {
+			for (size_t j = begin; j < end; j++)
+				decryptSegment(list[j]);
+		}));
+	}
+	for (size_t j = 0; j < std::min(list.size(), chunk); j++)
+		decryptSegment(list[j]);
+	for (auto& future : futures)
+		future.get();
+}
+
 void GDCartridge::loadSegments(u32 offset, u32 size)
 {
+	if (size == 0 || segments == nullptr)
+		return;
+	const u32 firstSegment = offset / SEGMENT_SIZE;
 	const u32 lastSegment = (offset + size - 1) / SEGMENT_SIZE;
-	for (u32 segment = offset / SEGMENT_SIZE; segment <= lastSegment; segment++)
+	claimedSegments.clear();
+	bool prefetching = false;
+	u32 hits = 0;
+	for (u32 segment = firstSegment; segment <= lastSegment; segment++)
+	{
+		u8 state = segments[segment].load(std::memory_order_acquire);
+		if (state == SegLoaded)
+			hits++;
+		else if (state == SegNotLoaded && segments[segment].compare_exchange_strong(state, SegLoading))
+			claimedSegments.push_back(segment);
+		else
+			prefetching = true;
+	}
+	if (hits != 0)
+		segmentHits += hits;
+
+	if (!claimedSegments.empty() || prefetching)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		if (!claimedSegments.empty())
+		{
+			DEBUG_LOG(NAOMI, "Loading %d segments from %d", (int)claimedSegments.size(), claimedSegments[0]);
+			for (u32 segment : claimedSegments)
+				readSegment(segment);
+			decryptSegments(claimedSegments);
+			for (u32 segment : claimedSegments)
+				segments[segment].store(SegLoaded, std::memory_order_release);
+			segmentMisses += claimedSegments.size();
+		}
+		if (prefetching)
+		{
+			std::unique_lock<std::mutex> lock(segmentMutex);
+			for (u32 segment = firstSegment; segment <= lastSegment; segment++)
+			{
+				if (segments[segment].load(std::memory_order_acquire) == SegLoaded)
+					continue;
+				segmentWaits++;
+				segmentLoadedCond.wait(lock, [this, segment]() {
+					return segments[segment].load(std::memory_order_acquire) == SegLoaded;
+				});
+			}
+		}
+		const u64 us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+		stallTimeUs += us;
+		if (us > maxStallTimeUs)
+			maxStallTimeUs = us;
+	}
+	prefetch(lastSegment + 1);
+}
+
+// Load the segments following the last access in the background
+void GDCartridge::prefetch(u32 segment)
+{
+	if (segment == lastPrefetchRequest)
+		return;
+	lastPrefetchRequest = segment;
+	const u32 end = std::min(segment + PREFETCH_SEGMENTS, segmentCount);
+	while (segment < end && segments[segment].load(std::memory_order_relaxed) != SegNotLoaded)
+		segment++;
+	if (segment >= end)
+		return;
 	{
-		if (loadedSegments[segment])
+		std::lock_guard<std::mutex> _(segmentMutex);
+		prefetchNext = segment;
+		prefetchEnd = end;
+		if (!prefetchThread.joinable())
+			prefetchThread = std::thread(&GDCartridge::prefetchLoop, this);
+	}
+	prefetchCond.notify_one();
+}
+
+void GDCartridge::prefetchLoop()
+{
+	ThreadName _("GDPrefetch");
+	std::unique_lock<std::mutex> lock(segmentMutex);
+	while (true)
+	{
+		prefetchCond.wait(lock, [this]() {
+			return prefetchExit || prefetchNext < prefetchEnd;
+		});
+		if (prefetchExit)
+			break;
+		const u32 segment = prefetchNext++;
+		u8 state = SegNotLoaded;
+		if (!segments[segment].compare_exchange_strong(state, SegLoading))
 			continue;
-		DEBUG_LOG(NAOMI, "Loading segment %d", segment);
-		// load data
-		read_gdrom(gdrom.get(), file_start + (segment * SEGMENT_SIZE) / 2048,
-				dimm_data + segment * SEGMENT_SIZE,
-				SEGMENT_SIZE / 2048,
-				nullptr);
-		// decrypt loaded data
-		u64 *pData = (u64 *)(dimm_data + segment * SEGMENT_SIZE);
-		for (u32 i = 0; i < SEGMENT_SIZE; i += 8, pData++)
-			*pData = des_encrypt_decrypt<true>(*pData, des_subkeys);
-		loadedSegments[segment] = true;
+		lock.unlock();
+		readSegment(segment);
+		decryptSegment(segment);
+		segmentsPrefetched++;
+		lock.lock();
+		segments[segment].store(SegLoaded, std::memory_order_release);
+		segmentLoadedCond.notify_all();
 	}
 }
 
+void GDCartridge::stopPrefetch()
+{
+	{
+		std::lock_guard<std::mutex> _(segmentMutex);
+		prefetchExit = true;
+	}
+	prefetchCond.notify_one();
+	if (prefetchThread.joinable())
+		prefetchThread.join();
+	prefetchExit = false;
+	prefetchNext = 0;
+	prefetchEnd = 0;
+	lastPrefetchRequest = ~0u;
+}
+
+GDSegmentStats GDCartridge::getSegmentStats() const
+{
+	GDSegmentStats stats;
+	stats.hits = segmentHits;
+	stats.misses = segmentMisses;
+	stats.waits = segmentWaits;
+	stats.prefetched = segmentsPrefetched;
+	stats.stallTimeUs = stallTimeUs;
+	stats.maxStallTimeUs = maxStallTimeUs;
+	return stats;
+}
+
 void GDCartridge::device_reset()
 {
 	dimm_cur_address = 0;
@@ -670,6 +831,7 @@ GDCartridge::GDCartridge(u32 size) : NaomiCartridge(size)
 
 GDCartridge::~GDCartridge()
 {
+	stopPrefetch();
 	free(dimm_data);
 	sh4_sched_unregister(schedId);
 }
@@ -12,6 +12,23 @@
 #pragma once
 #include "naomi_cart.h"
 #include "imgread/common.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+class WorkerThread;
+
+struct GDSegmentStats
+{
+	u64 hits = 0;			// already loaded when accessed
+	u64 misses = 0;			// loaded synchronously by the emulation thread
+	u64 waits = 0;			// being prefetched when accessed
+	u64 prefetched = 0;		// loaded by the background thread
+	u64 stallTimeUs = 0;	// time spent by the emulation thread loading or waiting for segments
+	u64 maxStallTimeUs = 0;
+};
 
 class GDCartridge: public NaomiCartridge
 {
@@ -33,10 +50,14 @@ public:
 	void Serialize(Serializer &ser) const override;
 	void Deserialize(Deserializer &deser) override;
 
+	GDSegmentStats getSegmentStats() const;
+
 protected:
 	virtual void process();
 	virtual int schedCallback();
 	void returnToNaomi(bool failed, u16 offsetl, u32 parameter);
+	// Make sure the segments covering this area are loaded and decrypted
+	void loadSegments(u32 offset, u32 size);
 
 	template<typename T>
 	void peek(u32 address)
@@ -91,8 +112,37 @@ private:
 	static const u32 DES_MASK_TABLE[];
 	static const u8 DES_ROTATE_TABLE[16];
 
-	std::vector<bool> loadedSegments;
+	enum SegmentState : u8 {
+		SegNotLoaded,
+		SegLoading,
+		SegLoaded
+	};
+	std::unique_ptr<std::atomic<u8>[]> segments;
+	u32 segmentCount = 0;
 	static constexpr u32 SEGMENT_SIZE = 16_KB;
+	static constexpr u32 PREFETCH_SEGMENTS = 64;	// 1 MB ahead of the last access
+	static constexpr u32 PARALLEL_DECRYPT_SEGMENTS = 4;
+	static constexpr u32 DECRYPT_THREADS = 4;
+	std::vector<u32> claimedSegments;
+	std::vector<std::unique_ptr<WorkerThread>> decryptThreads;
+
+	// Background loader
+	std::thread prefetchThread;
+	std::mutex segmentMutex;
+	std::condition_variable prefetchCond;
+	std::condition_variable segmentLoadedCond;
+	u32 prefetchNext = 0;
+	u32 prefetchEnd = 0;
+	u32 lastPrefetchRequest = ~0u;
+	bool prefetchExit = false;
+	std::mutex gdromMutex;
+
+	std::atomic<u64> segmentHits { 0 };
+	std::atomic<u64> segmentMisses { 0 };
+	std::atomic<u64> segmentWaits { 0 };
+	std::atomic<u64> segmentsPrefetched { 0 };
+	std::atomic<u64> stallTimeUs { 0 };
+	std::atomic<u64> maxStallTimeUs { 0 };
 	std::unique_ptr<Disc> gdrom;
 	u32 file_start = 0;
 	u32 des_subkeys[32];
@@ -107,6 +157,11 @@ private:
 	u64 des_encrypt_decrypt(u64 src, const u32 *des_subkeys);
 	u64 rev64(u64 src);
 	void read_gdrom(Disc *gdrom, u32 sector, u8* dst, u32 count = 1, LoadProgress *progress = nullptr);
-	void loadSegments(u32 offset, u32 size);
+	void readSegment(u32 segment);
+	void decryptSegment(u32 segment);
+	void decryptSegments(const std::vector<u32>& list);
+	void prefetch(u32 segment);
+	void prefetchLoop();
+	void stopPrefetch();
 	void systemCmd(int cmd);
 };
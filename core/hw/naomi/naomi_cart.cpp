@@ -46,6 +46,8 @@
 #include "systemsp.h"
 #include "hopper.h"
 #include "midiffb.h"
+#include "util/worker_thread.h"
+#include <future>
 
 Cartridge *CurrentCartridge;
 bool bios_loaded = false;
@@ -226,6 +228,132 @@ void naomi_cart_LoadBios(const char *filename)
 	bios_loaded = true;
 }
 
+static ArchiveFile *openRomFile(const Game *game, int romid, Archive *archive, Archive *parent_archive)
+{
+	std::unique_ptr<ArchiveFile> file;
+	// Find by CRC
+	if (archive != NULL)
+		file.reset(archive->OpenFileByCrc(game->blobs[romid].crc));
+	if (!file && parent_archive != NULL)
+		file.reset(parent_archive->OpenFileByCrc(game->blobs[romid].crc));
+	// Fallback to find by filename
+	if (!file && archive != NULL)
+		file.reset(archive->OpenFile(game->blobs[romid].filename));
+	if (!file && parent_archive != NULL)
+		file.reset(parent_archive->OpenFile(game->blobs[romid].filename));
+
+	return file.release();
+}
+
+// Load a Normal or InterleavedWord blob into the cartridge ROM
+static void loadRomBlob(const Game *game, int romid, Archive *archive, Archive *parent_archive, std::vector<u8>& buffer)
+{
+	std::unique_ptr<ArchiveFile> file(openRomFile(game, romid, archive, parent_archive));
+	if (!file) {
+		WARN_LOG(NAOMI, "%s: Cannot open %s", game->name, game->blobs[romid].filename);
+		throw NaomiCartException(std::string("Cannot find ") + game->blobs[romid].filename);
+	}
+	u32 len = game->blobs[romid].length;
+	if (game->blobs[romid].blob_type == Normal)
+	{
+		u8 *dst = (u8 *)CurrentCartridge->GetPtr(game->blobs[romid].offset, len);
+		if (dst == nullptr)
+			throw NaomiCartException(std::string("Invalid ROM: truncated ") + game->blobs[romid].filename);
+		u32 read = file->Read(dst, game->blobs[romid].length);
+		DEBUG_LOG(NAOMI, "Mapped %s: %x bytes at %07x", game->blobs[romid].filename, read, game->blobs[romid].offset);
+	}
+	else
+	{
+		buffer.resize(game->blobs[romid].length);
+		u32 read = file->Read(buffer.data(), game->blobs[romid].length);
+		u16 *to = (u16 *)CurrentCartridge->GetPtr(game->blobs[romid].offset, len);
+		if (to == nullptr)
+			throw NaomiCartException(std::string("Invalid ROM: truncated ") + game->blobs[romid].filename);
+		const u16 *from = (const u16 *)buffer.data();
+		for (int i = game->blobs[romid].length / 2; --i >= 0; to++)
+			*to++ = *from++;
+		DEBUG_LOG(NAOMI, "Mapped %s: %x bytes (interleaved word) at %07x", game->blobs[romid].filename, read, game->blobs[romid].offset);
+	}
+}
+
+constexpr u32 ROM_LOADER_THREADS = 4;
+static std::vector<std::unique_ptr<WorkerThread>> romLoaderThreads;
+
+// Load the consecutive Normal and InterleavedWord blobs [first, last[.
+// Zip archive members are decompressed in parallel, each loader thread using its own archive instances.
+static void loadRomBlobs(const Game *game, int first, int last, int romCount,
+		Archive *archive, const std::string& archivePath, Archive *parent_archive, const std::string& parentPath,
+		LoadProgress *progress)
+{
+	const bool solid = (archive != nullptr && archive->isSolid())
+			|| (parent_archive != nullptr && parent_archive->isSolid());
+	const u32 threadCount = std::min<u32>(std::min<u32>(ROM_LOADER_THREADS, std::thread::hardware_concurrency()), last - first);
+	std::vector<u8> buffer;
+	if (solid || threadCount < 2)
+	{
+		for (int romid = first; romid < last; romid++)
+		{
+			if (progress != nullptr && progress->cancelled)
+				throw LoadCancelledException();
+			loadRomBlob(game, romid, archive, parent_archive, buffer);
+		}
+		return;
+	}
+	std::atomic<int> next { first };
+	std::atomic<int> loaded { first };
+	auto load = [&](Archive *threadArchive, Archive *threadParent, std::vector<u8>& threadBuffer)
+	{
+		for (int romid = next++; romid < last; romid = next++)
+		{
+			if (progress != nullptr && progress->cancelled)
+				throw LoadCancelledException();
+			try {
+				loadRomBlob(game, romid, threadArchive, threadParent, threadBuffer);
+			} catch (...) {
+				// stop the other threads
+				next = last;
+				throw;
+			}
+			const int count = ++loaded;
+			if (progress != nullptr && game->cart_type != GD)
+				progress->progress = (float)count / romCount;
+		}
+	};
+	while (romLoaderThreads.size() < threadCount - 1)
+		romLoaderThreads.push_back(std::make_unique<WorkerThread>("RomLoader"));
+
+	std::vector<std::future<void>> futures;
+	for (u32 i = 0; i < threadCount - 1; i++)
+		futures.push_back(romLoaderThreads[i]->runFuture([&]() {
+			std::unique_ptr<Archive> threadArchive;
+			std::unique_ptr<Archive> threadParent;
+			if (archive != nullptr)
+				threadArchive.reset(OpenArchive(archivePath));
+			if (parent_archive != nullptr)
+				threadParent.reset(OpenArchive(parentPath));
+			std::vector<u8> threadBuffer;
+			load(threadArchive.get(), threadParent.get(), threadBuffer);
+		}));
+	std::exception_ptr error;
+	try {
+		load(archive, parent_archive, buffer);
+	} catch (...) {
+		error = std::current_exception();
+	}
+	// wait for all threads before returning since they use local variables
+	for (auto& future : futures)
+	{
+		try {
+			future.get();
+		} catch (...) {
+			if (!error)
+				error = std::current_exception();
+		}
+	}
+	if (error)
+		std::rethrow_exception(error);
+}
+
 static void loadMameRom(const std::string& path, const std::string& fileName, LoadProgress *progress)
 {
 	const Game *game = FindGame(fileName.c_str());
@@ -238,20 +366,24 @@ static void loadMameRom(const std::string& path, const std::string& fileName, Lo
 		INFO_LOG(NAOMI, "Opened %s", path.c_str());
 
 	std::unique_ptr<Archive> parent_archive;
+	std::string parentPath;
 	if (game->parent_name != nullptr)
 	{
 		try {
-			std::string parentPath = hostfs::storage().getParentPath(path);
+			parentPath = hostfs::storage().getParentPath(path);
 			parentPath = hostfs::storage().getSubPath(parentPath, game->parent_name);
 			parent_archive.reset(OpenArchive(parentPath));
 		} catch (const FlycastException& e) {
 		}
-		if (parent_archive != nullptr)
+		if (parent_archive != nullptr) {
 			INFO_LOG(NAOMI, "Opened %s", game->parent_name);
-		else
+		}
+		else {
 			WARN_LOG(NAOMI, "Parent not found: %s", game->parent_name);
-
+			parentPath.clear();
+		}
 	}
+	const std::string archivePath = archive != nullptr ? path : "";
 
 	if (archive == nullptr && parent_archive == nullptr)
 	{
@@ -310,6 +442,21 @@ static void loadMameRom(const std::string& path, const std::string& fileName, Lo
 		NaomiGameInputs = game->inputs;
 		CurrentCartridge->game = game;
 
+		// GD-ROM games load their data from the GD-ROM image
+		const bool useRomCache = config::NaomiRomCache && !config::GGPOEnable && game->cart_type != GD;
+		bool romCached = false;
+		if (useRomCache)
+		{
+			u32 romSize;
+			CurrentCartridge->GetRomData(romSize);
+			std::unique_ptr<romcache::MappedRom> rom = romcache::open(game, archivePath, parentPath, romSize);
+			if (rom != nullptr)
+			{
+				CurrentCartridge->SetMappedRom(std::move(rom));
+				romCached = true;
+			}
+		}
+
 		MD5Sum md5;
 
 		int romCount = 0;
@@ -332,7 +479,27 @@ static void loadMameRom(const std::string& path, const std::string& fileName, Lo
 
 			u32 len = game->blobs[romid].length;
 
-			if (game->blobs[romid].blob_type == Copy)
+			if (romCached && (game->blobs[romid].blob_type == Normal
+					|| game->blobs[romid].blob_type == InterleavedWord
+					|| game->blobs[romid].blob_type == Copy))
+				continue;
+			if (game->blobs[romid].blob_type == Normal || game->blobs[romid].blob_type == InterleavedWord)
+			{
+				int last = romid + 1;
+				while (last < romCount && (game->blobs[last].blob_type == Normal || game->blobs[last].blob_type == InterleavedWord))
+					last++;
+				loadRomBlobs(game, romid, last, romCount, archive.get(), archivePath, parent_archive.get(), parentPath, progress);
+				if (config::GGPOEnable)
+				{
+					for (; romid < last; romid++)
+					{
+						len = game->blobs[romid].length;
+						md5.add((u8 *)CurrentCartridge->GetPtr(game->blobs[romid].offset, len), game->blobs[romid].length);
+					}
+				}
+				romid = last - 1;
+			}
+			else if (game->blobs[romid].blob_type == Copy)
 			{
 				u8 *dst = (u8 *)CurrentCartridge->GetPtr(game->blobs[romid].offset, len);
 				u8 *src = (u8 *)CurrentCartridge->GetPtr(game->blobs[romid].src_offset, len);
@@ -343,17 +510,7 @@ static void loadMameRom(const std::string& path, const std::string& fileName, Lo
 			}
 			else
 			{
-				std::unique_ptr<ArchiveFile> file;
-				// Find by CRC
-				if (archive != NULL)
-					file.reset(archive->OpenFileByCrc(game->blobs[romid].crc));
-				if (!file && parent_archive != NULL)
-					file.reset(parent_archive->OpenFileByCrc(game->blobs[romid].crc));
-				// Fallback to find by filename
-				if (!file && archive != NULL)
-					file.reset(archive->OpenFile(game->blobs[romid].filename));
-				if (!file && parent_archive != NULL)
-					file.reset(parent_archive->OpenFile(game->blobs[romid].filename));
+				std::unique_ptr<ArchiveFile> file(openRomFile(game, romid, archive.get(), parent_archive.get()));
 				if (!file) {
 					WARN_LOG(NAOMI, "%s: Cannot open %s", fileName.c_str(), game->blobs[romid].filename);
 					if (game->blobs[romid].blob_type != Eeprom)
@@ -364,38 +521,6 @@ static void loadMameRom(const std::string& path, const std::string& fileName, Lo
 				}
 				switch (game->blobs[romid].blob_type)
 				{
-					case Normal:
-						{
-							u8 *dst = (u8 *)CurrentCartridge->GetPtr(game->blobs[romid].offset, len);
-							if (dst == nullptr)
-								throw NaomiCartException(std::string("Invalid ROM: truncated ") + game->blobs[romid].filename);
-							u32 read = file->Read(dst, game->blobs[romid].length);
-							if (config::GGPOEnable)
-								md5.add(dst, game->blobs[romid].length);
-							DEBUG_LOG(NAOMI, "Mapped %s: %x bytes at %07x", game->blobs[romid].filename, read, game->blobs[romid].offset);
-						}
-						break;
-
-					case InterleavedWord:
-						{
-							u8 *buf = (u8 *)malloc(game->blobs[romid].length);
-							if (buf == nullptr)
-								throw NaomiCartException("Memory allocation failed");
-
-							u32 read = file->Read(buf, game->blobs[romid].length);
-							u16 *to = (u16 *)CurrentCartridge->GetPtr(game->blobs[romid].offset, len);
-							if (to == nullptr)
-								throw NaomiCartException(std::string("Invalid ROM: truncated ") + game->blobs[romid].filename);
-							u16 *from = (u16 *)buf;
-							for (int i = game->blobs[romid].length / 2; --i >= 0; to++)
-								*to++ = *from++;
-							free(buf);
-							if (config::GGPOEnable)
-								md5.add((u8*)CurrentCartridge->GetPtr(game->blobs[romid].offset, len), game->blobs[romid].length);
-							DEBUG_LOG(NAOMI, "Mapped %s: %x bytes (interleaved word) at %07x", game->blobs[romid].filename, read, game->blobs[romid].offset);
-						}
-						break;
-
 					case Key:
 						{
 							u8 *buf = (u8 *)malloc(game->blobs[romid].length);
@@ -446,6 +571,13 @@ static void loadMameRom(const std::string& path, const std::string& fileName, Lo
 			naomi_default_eeprom = game->eeprom_dump;
 		if (game->rotation_flag == ROT270)
 			config::Rotate90.override(true);
+		if (useRomCache && !romCached)
+		{
+			// save before Init() modifies the ROM
+			u32 romSize;
+			const u8 *romData = CurrentCartridge->GetRomData(romSize);
+			romcache::save(game, archivePath, parentPath, romData, romSize);
+		}
 
 		std::vector<u8> gdromDigest;
 		CurrentCartridge->Init(progress, config::GGPOEnable ? &gdromDigest : nullptr);
@@ -846,10 +978,18 @@ Cartridge::Cartridge(u32 size)
 
 Cartridge::~Cartridge()
 {
-	if (RomPtr != NULL)
+	if (RomPtr != NULL && mappedRom == nullptr)
 		free(RomPtr);
 }
 
+void Cartridge::SetMappedRom(std::unique_ptr<romcache::MappedRom> rom)
+{
+	verify(rom->size == RomSize);
+	free(RomPtr);
+	RomPtr = rom->data;
+	mappedRom = std::move(rom);
+}
+
 bool Cartridge::Read(u32 offset, u32 size, void* dst)
 {
 	offset &= 0x1FFFFFFF;
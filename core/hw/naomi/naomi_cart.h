@@ -2,6 +2,7 @@
 
 #include "types.h"
 #include "emulator.h"
+#include "romcache.h"
 
 #include <string>
 #include <vector>
@@ -70,12 +71,21 @@ public:
 	virtual void SetKey(u32 key) { }
 	virtual void SetKeyData(u8 *key_data) { }
 	virtual bool GetBootId(RomBootID *bootId) = 0;
+	// Use a memory-mapped ROM cache file instead of the allocated ROM
+	void SetMappedRom(std::unique_ptr<romcache::MappedRom> rom);
+	const u8 *GetRomData(u32& size) const {
+		size = RomSize;
+		return RomPtr;
+	}
 
 	const Game *game = nullptr;
 
 protected:
 	u8* RomPtr;
 	u32 RomSize;
+
+private:
+	std::unique_ptr<romcache::MappedRom> mappedRom;
 };
 
 class NaomiCartridge : public Cartridge
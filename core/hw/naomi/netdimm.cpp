@@ -58,7 +58,10 @@ bool NetDimm::Write(u32 offset, u32 size, u32 data)
 	if (dimm_data != nullptr)
 	{
 		u32 addr = offset & (dimm_data_size - 1);
-		memcpy(&dimm_data[addr], &data, std::min(size, dimm_data_size - addr));
+		size = std::min(size, dimm_data_size - addr);
+		// don't let a later segment load overwrite this
+		loadSegments(addr, size);
+		memcpy(&dimm_data[addr], &data, size);
 	}
 	return true;
 }
@@ -481,8 +484,9 @@ void NetDimm::netCmd(int cmd)
 			}
 			else
 			{
-				u32 len = buffer[3];
 				u32 offset = buffer[2] & (dimm_data_size - 1);
+				u32 len = std::min(buffer[3], dimm_data_size - offset);
+				loadSegments(offset, len);
 				u8 *data = &dimm_data[offset];
 				rc = recv(sockfd, (char *)data, len, 0);
 				if (rc == -1)
@@ -527,8 +531,9 @@ void NetDimm::netCmd(int cmd)
 			}
 			else
 			{
-				u32 len = buffer[3];
 				u32 offset = buffer[2] & (dimm_data_size - 1);
+				u32 len = std::min(buffer[3], dimm_data_size - offset);
+				loadSegments(offset, len);
 				u8 *data = &dimm_data[offset];
 				rc = send(sockfd, (const char *)data, len, 0);
 				if (rc == -1)
@@ -0,0 +1,230 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "romcache.h"
+#include "naomi_roms.h"
+#include "stdclass.h"
+#include "oslib/storage.h"
+
+#if defined(__SWITCH__) || defined(TARGET_UWP)
+#define ROMCACHE_UNSUPPORTED
+#elif defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace romcache
+{
+
+#ifndef ROMCACHE_UNSUPPORTED
+
+constexpr char Magic[8] { 'F', 'L', 'Y', 'R', 'O', 'M', 'C', '1' };
+constexpr u32 Version = 1;
+// ROM data starts at this offset, which is a multiple of the page size and of the windows allocation granularity
+constexpr u32 HeaderSize = 64 * 1024;
+
+struct Header
+{
+	char magic[8];
+	u32 version;
+	u32 romSize;
+	u64 archiveSize;
+	u64 archiveTime;
+	u64 parentSize;
+	u64 parentTime;
+};
+
+static std::string getCachePath(const Game *game) {
+	return get_writable_data_path("romcache/") + game->name + ".rom";
+}
+
+// Archive paths may have no extension, as with OpenArchive()
+static bool getArchiveInfo(const std::string& path, u64& size, u64& updateTime)
+{
+	for (const char *ext : { "", ".7z", ".7Z", ".zip", ".ZIP" })
+	{
+		try {
+			hostfs::FileInfo info = hostfs::storage().getFileInfo(path + ext);
+			if (info.isDirectory)
+				continue;
+			size = info.size;
+			updateTime = info.updateTime;
+			return true;
+		} catch (const hostfs::StorageException& e) {
+		}
+	}
+	return false;
+}
+
+// Returns false if an archive can't be found
+static bool makeHeader(Header& header, const std::string& path, const std::string& parentPath, u32 size)
+{
+	header = {};
+	memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	header.romSize = size;
+	if (!path.empty() && !getArchiveInfo(path, header.archiveSize, header.archiveTime))
+		return false;
+	if (!parentPath.empty() && !getArchiveInfo(parentPath, header.parentSize, header.parentTime))
+		return false;
+	return true;
+}
+
+static u8 *mapFile(const std::string& cachePath, u32 size)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileW(nowide::widen(cachePath).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return nullptr;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || (u64)fileSize.QuadPart < (u64)HeaderSize + size)
+	{
+		CloseHandle(file);
+		return nullptr;
+	}
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (mapping == nullptr)
+		return nullptr;
+	// copy-on-write: the cartridge can patch its rom without altering the cache file
+	void *data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, HeaderSize, size);
+	// the view keeps a reference to the mapping
+	CloseHandle(mapping);
+
+	return (u8 *)data;
+#else
+	int fd = ::open(cachePath.c_str(), O_RDONLY);
+	if (fd == -1)
+		return nullptr;
+	struct stat st;
+	// accessing pages past the end of file would raise SIGBUS
+	if (fstat(fd, &st) != 0 || (u64)st.st_size < (u64)HeaderSize + size)
+	{
+		close(fd);
+		return nullptr;
+	}
+	// copy-on-write: the cartridge can patch its rom without altering the cache file
+	void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, HeaderSize);
+	close(fd);
+	if (data == MAP_FAILED)
+		return nullptr;
+
+	return (u8 *)data;
+#endif
+}
+
+MappedRom::~MappedRom()
+{
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+#else
+	munmap(data, size);
+#endif
+}
+
+std::unique_ptr<MappedRom> open(const Game *game, const std::string& path, const std::string& parentPath, u32 size)
+{
+	if (size == 0)
+		return nullptr;
+	Header expected;
+	if (!makeHeader(expected, path, parentPath, size))
+		return nullptr;
+
+	const std::string cachePath = getCachePath(game);
+	FILE *f = nowide::fopen(cachePath.c_str(), "rb");
+	if (f == nullptr)
+		return nullptr;
+	Header header;
+	bool valid = std::fread(&header, sizeof(header), 1, f) == 1;
+	std::fclose(f);
+	if (!valid || memcmp(&header, &expected, sizeof(header)) != 0)
+	{
+		if (valid)
+			INFO_LOG(NAOMI, "ROM cache %s is out of date", cachePath.c_str());
+		return nullptr;
+	}
+	u8 *data = mapFile(cachePath, size);
+	if (data == nullptr)
+	{
+		WARN_LOG(NAOMI, "Can't map ROM cache %s", cachePath.c_str());
+		return nullptr;
+	}
+	INFO_LOG(NAOMI, "Mapped ROM cache %s", cachePath.c_str());
+
+	return std::make_unique<MappedRom>(data, size);
+}
+
+void save(const Game *game, const std::string& path, const std::string& parentPath, const u8 *data, u32 size)
+{
+	if (size == 0)
+		return;
+	Header header;
+	if (!makeHeader(header, path, parentPath, size))
+		return;
+
+	const std::string dir = get_writable_data_path("romcache");
+	if (!file_exists(dir))
+		make_directory(dir);
+	const std::string cachePath = getCachePath(game);
+	// write to a temporary file so that an interrupted write never leaves a valid-looking cache file
+	const std::string tempPath = cachePath + ".tmp";
+	FILE *f = nowide::fopen(tempPath.c_str(), "wb");
+	if (f == nullptr)
+	{
+		WARN_LOG(NAOMI, "Can't create ROM cache %s", tempPath.c_str());
+		return;
+	}
+	std::vector<u8> headerBlock(HeaderSize);
+	memcpy(headerBlock.data(), &header, sizeof(header));
+	bool success = std::fwrite(headerBlock.data(), headerBlock.size(), 1, f) == 1
+			&& std::fwrite(data, size, 1, f) == 1;
+	success = std::fclose(f) == 0 && success;
+	if (success)
+	{
+		nowide::remove(cachePath.c_str());
+		success = nowide::rename(tempPath.c_str(), cachePath.c_str()) == 0;
+	}
+	if (!success)
+	{
+		WARN_LOG(NAOMI, "Error writing ROM cache %s", cachePath.c_str());
+		nowide::remove(tempPath.c_str());
+		return;
+	}
+	INFO_LOG(NAOMI, "Saved ROM cache %s", cachePath.c_str());
+}
+
+#else	// ROMCACHE_UNSUPPORTED
+
+MappedRom::~MappedRom() {
+}
+
+std::unique_ptr<MappedRom> open(const Game *game, const std::string& path, const std::string& parentPath, u32 size) {
+	return nullptr;
+}
+
+void save(const Game *game, const std::string& path, const std::string& parentPath, const u8 *data, u32 size) {
+}
+
+#endif
+
+}
@@ -0,0 +1,45 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+// Cache of the decompressed cartridge ROM of MAME rom sets.
+// Cache files are memory-mapped copy-on-write so the cartridge can modify its ROM.
+#pragma once
+#include "types.h"
+#include <memory>
+#include <string>
+
+struct Game;
+
+namespace romcache
+{
+
+class MappedRom
+{
+public:
+	MappedRom(u8 *data, u32 size) : data(data), size(size) {}
+	~MappedRom();
+
+	u8 * const data;
+	const u32 size;
+};
+
+// Returns nullptr if there is no valid cache file for this game
+std::unique_ptr<MappedRom> open(const Game *game, const std::string& path, const std::string& parentPath, u32 size);
+void save(const Game *game, const std::string& path, const std::string& parentPath, const u8 *data, u32 size);
+
+}
@@ -7,12 +7,18 @@
 #include "serialize.h"
 #include "hw/holly/holly_intc.h"
 #include "hw/sh4/sh4_if.h"
+#include "hw/sh4/sh4_sched.h"
 #include "hw/sh4/sh4_core.h"
 #include "profiler/fc_profiler.h"
+#include "profiler/benchmark.h"
 #include "network/ggpo.h"
+#include "util/worker_thread.h"
+#include "ta.h"
 
+#include <atomic>
 #include <mutex>
 #include <deque>
+#include <future>
 
 #ifdef LIBRETRO
 void retro_rend_present();
@@ -41,6 +47,16 @@ TA_context* _pvrrc;
 static bool presented;
 static u32 fbAddrHistory[2] { 1, 1 };
 
+static WorkerThread taParser("TAParser");
+static std::future<void> parseAheadDone;
+// Context parsed by parseAheadDone
+static TA_context *parseAheadCtx;
+// parseAheadDone is waited on by both the emulator and the render threads
+static std::mutex parseAheadMutex;
+// Set by the render thread when the renderer is initialized, so that the emulator thread doesn't access it
+static std::atomic<bool> parseAheadEnabled;
+static std::atomic<bool> parseAheadPrimRestart;
+
 class PvrMessageQueue
 {
 	using lock_guard = std::lock_guard<std::mutex>;
@@ -191,6 +207,7 @@ private:
 			retro_resize_renderer(_pvrrc->rend.framebufferWidth, _pvrrc->rend.framebufferHeight,
 					getOutputFramebufferAspectRatio());
 #endif
+		rend_wait_parse_ahead(_pvrrc);
 		{
 			FC_PROFILE_SCOPE_NAMED("Renderer::Process");
 			renderer->Process(_pvrrc);
@@ -276,6 +293,11 @@ static void rend_create_renderer()
 #ifdef NO_REND
 	renderer	 = rend_norend();
 #else
+	if (benchmark::enabled())
+	{
+		renderer = rend_norend();
+		return;
+	}
 	switch (config::RendererType)
 	{
 	default:
@@ -325,11 +347,14 @@ bool rend_init_renderer()
 		renderer = rend_norend();
 		renderer->Init();
 	}
+	parseAheadPrimRestart = renderer->primRestart();
+	parseAheadEnabled = true;
 	return success;
 }
 
 void rend_term_renderer()
 {
+	parseAheadEnabled = false;
 	if (renderer != nullptr)
 	{
 		renderer->Term();
@@ -340,6 +365,7 @@ void rend_term_renderer()
 
 void rend_reset()
 {
+	rend_wait_parse_ahead();
 	FinishRender(DequeueRender());
 	render_called = false;
 	pend_rend = false;
@@ -351,6 +377,35 @@ void rend_reset()
 	fbAddrHistory[1] = 1;
 }
 
+// Parse the geometry of a context on the worker thread while the previous frame is being rendered.
+// Textures are still fetched by the renderer in Process().
+void rend_parse_ahead(TA_context *ctx)
+{
+	if (!config::ParseAhead || !parseAheadEnabled)
+		return;
+	std::lock_guard<std::mutex> _(parseAheadMutex);
+	if (parseAheadDone.valid())
+		parseAheadDone.get();
+	const bool primRestart = parseAheadPrimRestart;
+	parseAheadCtx = ctx;
+	parseAheadDone = taParser.runFuture([ctx, primRestart]() {
+		ta_parse_geometry(ctx, primRestart);
+	});
+}
+
+// Must be called before using or recycling a context passed to rend_parse_ahead.
+// Only waits if ctx is being parsed, or for any context if ctx is null.
+void rend_wait_parse_ahead(TA_context *ctx)
+{
+	// The lock is held while waiting so that a concurrent caller doesn't return before parsing is done
+	std::lock_guard<std::mutex> _(parseAheadMutex);
+	if (parseAheadDone.valid() && (ctx == nullptr || ctx == parseAheadCtx))
+	{
+		parseAheadDone.get();
+		parseAheadCtx = nullptr;
+	}
+}
+
 void rend_start_render()
 {
 	render_called = true;
@@ -462,6 +517,8 @@ void rend_vblank()
 	}
 	render_called = false;
 	check_framebuffer_write();
+	FC_PROFILE_INSTANT("vblank");
+	FC_PROFILE_COUNTER("Emulated time (ms)", sh4_sched_now64() / (SH4_MAIN_CLOCK / 1000.0));
 	emu.vblank();
 }
 
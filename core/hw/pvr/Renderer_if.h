@@ -16,6 +16,8 @@ bool rend_single_frame(const bool& enabled);
 void rend_swap_frame(u32 fb_r_sof1);
 void rend_set_fb_write_addr(u32 fb_w_sof1);
 void rend_reset();
+void rend_parse_ahead(TA_context *ctx);
+void rend_wait_parse_ahead(TA_context *ctx = nullptr);
 void rend_disable_rollback();
 void rend_start_rollback();
 void rend_allow_rollback();
@@ -82,6 +84,8 @@ struct Renderer
 	virtual bool Present() { return true; }
 
 	virtual BaseTextureCacheData *GetTexture(TSP tsp, TCW tcw) { return nullptr; }
+	// Whether primitive restart can be used in index buffers
+	virtual bool primRestart() const { return true; }
 
 protected:
 	bool resetTextureCache = false;
@@ -14,6 +14,10 @@ void ta_vtx_SoftReset();
 void DYNACALL ta_vtx_data32(const SQBuffer *data);
 void ta_vtx_data(const SQBuffer *data, u32 size);
 
+// Build the geometry, render passes and indexes of a context. Doesn't touch the texture cache
+// so it can be done on any thread.
+void ta_parse_geometry(TA_context *ctx, bool primRestart);
+// Parse the context if not done already and fetch its textures. Must be called on the render thread.
 void ta_parse(TA_context *ctx, bool primRestart);
 
 class TaTypeLut
@@ -58,14 +58,19 @@ bool QueueRender(TA_context* ctx)
 			skipFrame = true;
 		else if (config::ThreadedRendering && rqueue != nullptr
 				&& (config::AutoSkipFrame == 0 || (config::AutoSkipFrame == 1 && SH4FastEnough)))
+		{
 			// The previous render hasn't completed yet so we wait.
 			// If autoskipframe is enabled (normal level), we only do so if the CPU is running
 			// fast enough over the last frames
+			// Meanwhile the context can be parsed on a worker thread.
+			rend_parse_ahead(ctx);
 			frame_finished.Wait();
+		}
 	}
 
 	if (skipFrame || rqueue)
 	{
+		rend_wait_parse_ahead(ctx);
 		tactx_Recycle(ctx);
 		if (rend_is_enabled())
 			fskip++;
@@ -233,6 +233,7 @@ struct rend_context
 
 	bool isRTT;
 	bool clearFramebuffer;
+	bool parsed;
 	
 	TA_GLOB_TILE_CLIP_type ta_GLOB_TILE_CLIP;
 	SCALER_CTL_type scaler_ctl;
@@ -283,6 +284,7 @@ struct rend_context
 		matrices.clear();
 		lightModels.clear();
 		clearFramebuffer = false;
+		parsed = false;
 	}
 
 	void newRenderPass();
@@ -430,6 +432,8 @@ void getRegionTileAddrAndSize(u32& address, u32& size);
 
 void sortTriangles(rend_context& ctx, RenderPass& pass, const RenderPass& previousPass);
 void sortPolyParams(std::vector<PolyParam>& polys, int first, int end, rend_context& ctx);
+// Use a radix sort instead of std::stable_sort in sortTriangles and sortPolyParams
+extern bool ta_radix_sort;
 void fix_texture_bleeding(const std::vector<PolyParam>& polys, int first, int end, rend_context& ctx);
 void makeIndex(std::vector<PolyParam>& polys, int first, int end, bool merge, rend_context& ctx);
 void makePrimRestartIndex(std::vector<PolyParam>& polys, int first, int end, bool merge, rend_context& ctx);
@@ -18,10 +18,15 @@
  */
 #include "ta_ctx.h"
 #include "pvr_mem.h"
+#include "util/radix_sort.h"
+#include "util/worker_thread.h"
 #include <algorithm>
+#include <thread>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+bool ta_radix_sort = true;
+
 //
 // Check if a vertex has NaN or huge x,y,z values
 //
@@ -63,6 +68,58 @@ static float getProjectedZ(const Vertex *v, const float *mat)
 	return -1 / (mat[2] * v->x + mat[1 * 4 + 2] * v->y + mat[2 * 4 + 2] * v->z + mat[3 * 4 + 2]);
 }
 
+//
+// Radix sort the items by key. Large lists are split in two halves that are sorted
+// concurrently and then merged. Equal keys keep their original order.
+//
+static const radix::Item *radixSort(std::vector<radix::Item>& items)
+{
+	constexpr size_t ParallelThreshold = 32768;
+	static std::vector<radix::Item> temp;
+	static std::vector<radix::Item> merged;
+	static WorkerThread sortThread("RadixSort");
+
+	const size_t count = items.size();
+	temp.resize(count);
+	if (count < ParallelThreshold || std::thread::hardware_concurrency() < 2)
+		return radix::sort(items.data(), temp.data(), count);
+
+	const size_t half = count / 2;
+	auto future = sortThread.runFuture(radix::sort, items.data(), temp.data(), half);
+	const radix::Item *second = radix::sort(items.data() + half, temp.data() + half, count - half);
+	const radix::Item *first = future.get();
+	merged.resize(count);
+	// std::merge takes equal elements from the first range first
+	std::merge(first, first + half, second, second + count - half, merged.begin(),
+			[](const radix::Item& a, const radix::Item& b) { return a.key < b.key; });
+	return merged.data();
+}
+
+//
+// Stable sort by increasing z. Same order as std::stable_sort with operator< on z,
+// except for NaN values.
+//
+template<typename T, typename GetZ>
+static void sortByZ(T *begin, T *end, GetZ getZ)
+{
+	if (!ta_radix_sort)
+	{
+		std::stable_sort(begin, end);
+		return;
+	}
+	static std::vector<radix::Item> items;
+	static std::vector<T> sorted;
+	const size_t count = end - begin;
+	items.resize(count);
+	for (size_t i = 0; i < count; i++)
+		items[i] = { radix::floatKey(getZ(begin[i])), (u32)i };
+	const radix::Item *order = radixSort(items);
+	sorted.resize(count);
+	for (size_t i = 0; i < count; i++)
+		sorted[i] = begin[order[i].index];
+	std::copy(sorted.begin(), sorted.end(), begin);
+}
+
 void sortTriangles(rend_context& ctx, RenderPass& pass, const RenderPass& previousPass)
 {
 	int first = previousPass.tr_count;
@@ -130,7 +187,8 @@ void sortTriangles(rend_context& ctx, RenderPass& pass, const RenderPass& previo
 	}
 
 	//sort them
-	std::stable_sort(triangleList.begin(), triangleList.end());
+	sortByZ(triangleList.data(), triangleList.data() + triangleList.size(),
+			[](const IndexTrig& t) { return t.z; });
 
 	//Merge pids/draw cmds if two different pids are actually equal
 	for (size_t k = 1; k < triangleList.size(); k++)
@@ -254,7 +312,7 @@ void sortPolyParams(std::vector<PolyParam>& polys, int first, int end, rend_cont
 		}
 	}
 
-	std::stable_sort(&polys[first], pp_end);
+	sortByZ(&polys[first], pp_end, [](const PolyParam& pp) { return pp.zvZ; });
 }
 
 void getRegionTileAddrAndSize(u32& address, u32& size)
@@ -9,8 +9,11 @@
 #include "pvr_mem.h"
 #include "Renderer_if.h"
 #include "cfg/option.h"
+#include "profiler/fc_profiler.h"
+#include "profiler/benchmark.h"
 
 #include <algorithm>
+#include <mutex>
 #include <utility>
 
 #define TACALL DYNACALL
@@ -159,7 +162,6 @@ public:
 	static std::vector<PolyParam> *CurrentPPlist;
 	static PolyParam* CurrentPP;
 	static TaListFP* TaCmd;
-	inline static bool fetchTextures = true;
 };
 
 const u32 *BaseTAParser::ta_type_lut = TaTypeLut::instance().table;
@@ -541,9 +543,6 @@ private:
 		d_pp->tcw = pp->tcw;
 		d_pp->pcw = pp->pcw;
 		d_pp->tileclip = tileclip_val;
-
-		if (d_pp->pcw.Texture && fetchTextures)
-			d_pp->texture = renderer->GetTexture(d_pp->tsp, d_pp->tcw);
 	}
 
 	#define glob_param_bdc(pp) glob_param_bdc_( (TA_PolyParam0*)pp)
@@ -602,8 +601,6 @@ private:
 
 		CurrentPP->tsp1.full = pp->tsp1.full;
 		CurrentPP->tcw1.full = pp->tcw1.full;
-		if (pp->pcw.Texture && fetchTextures)
-			CurrentPP->texture1 = renderer->GetTexture(pp->tsp1, pp->tcw1);
 	}
 
 	// Intensity, with Two Volumes
@@ -615,8 +612,6 @@ private:
 
 		CurrentPP->tsp1.full = pp->tsp1.full;
 		CurrentPP->tcw1.full = pp->tcw1.full;
-		if (pp->pcw.Texture && fetchTextures)
-			CurrentPP->texture1 = renderer->GetTexture(pp->tsp1, pp->tcw1);
 	}
 
 	static void TACALL AppendPolyParam4B(void* vpp)
@@ -970,9 +965,6 @@ private:
 		d_pp->pcw = spr->pcw;
 		d_pp->tileclip = tileclip_val;
 
-		if (d_pp->pcw.Texture && fetchTextures)
-			d_pp->texture = renderer->GetTexture(d_pp->tsp, d_pp->tcw);
-
 		SFaceBaseColor = spr->BaseCol;
 		SFaceOffsColor = spr->OffsCol;
         
@@ -1203,10 +1195,6 @@ static void ta_parse_vdrc(TA_context* ctx, bool primRestart)
 
 	ta_parse_reset();
 
-	PolyParam *bgpp = &vd_rc.global_param_op.front();
-	if (bgpp->pcw.Texture)
-		bgpp->texture = renderer->GetTexture(bgpp->tsp, bgpp->tcw);
-
 	TA_context *childCtx = ctx;
 	int pass = 0;
 	RenderPass previousPass{};
@@ -1267,28 +1255,6 @@ static void ta_parse_vdrc(TA_context* ctx, bool primRestart)
 
 static void ta_parse_naomi2(TA_context* ctx, bool primRestart)
 {
-	for (PolyParam& pp : ctx->rend.global_param_op)
-	{
-		if (pp.pcw.Texture)
-			pp.texture = renderer->GetTexture(pp.tsp, pp.tcw);
-		if (pp.tsp1.full != (u32)-1)
-			pp.texture1 = renderer->GetTexture(pp.tsp1, pp.tcw1);
-	}
-	for (PolyParam& pp : ctx->rend.global_param_pt)
-	{
-		if (pp.pcw.Texture)
-			pp.texture = renderer->GetTexture(pp.tsp, pp.tcw);
-		if (pp.tsp1.full != (u32)-1)
-			pp.texture1 = renderer->GetTexture(pp.tsp1, pp.tcw1);
-	}
-	for (PolyParam& pp : ctx->rend.global_param_tr)
-	{
-		if (pp.pcw.Texture)
-			pp.texture = renderer->GetTexture(pp.tsp, pp.tcw);
-		if (pp.tsp1.full != (u32)-1)
-			pp.texture1 = renderer->GetTexture(pp.tsp1, pp.tcw1);
-	}
-
 	ctx->rend.newRenderPass();
 	RenderPass previousPass{};
 
@@ -1314,12 +1280,43 @@ static void ta_parse_naomi2(TA_context* ctx, bool primRestart)
 	ctx->rend.fb_Y_CLIP.max = std::min(ctx->rend.fb_Y_CLIP.max, ymax + 31);
 }
 
-void ta_parse(TA_context *ctx, bool primRestart)
+void ta_parse_geometry(TA_context *ctx, bool primRestart)
 {
+	FC_PROFILE_SCOPE;
+	// The parser state is static, so the render thread and the parse-ahead worker must take turns
+	static std::mutex mutex;
+	std::lock_guard<std::mutex> _(mutex);
+	verify(!ctx->rend.parsed);
 	if (settings.platform.isNaomi2())
 		ta_parse_naomi2(ctx, primRestart);
 	else
 		ta_parse_vdrc(ctx, primRestart);
+	ctx->rend.parsed = true;
+}
+
+static void fetchTextures(std::vector<PolyParam>& polys, bool naomi2)
+{
+	for (PolyParam& pp : polys)
+	{
+		if (pp.pcw.Texture)
+			pp.texture = renderer->GetTexture(pp.tsp, pp.tcw);
+		// The second volume texture of Naomi 2 polys doesn't depend on pcw.Texture
+		if (pp.tsp1.full != (u32)-1 && (pp.pcw.Texture || naomi2))
+			pp.texture1 = renderer->GetTexture(pp.tsp1, pp.tcw1);
+	}
+}
+
+void ta_parse(TA_context *ctx, bool primRestart)
+{
+	benchmark::Scope _(benchmark::Section::TaParse);
+	if (!ctx->rend.parsed)
+		ta_parse_geometry(ctx, primRestart);
+
+	// Textures are uploaded by the renderer so this must be done on the render thread
+	const bool naomi2 = settings.platform.isNaomi2();
+	fetchTextures(ctx->rend.global_param_op, naomi2);
+	fetchTextures(ctx->rend.global_param_pt, naomi2);
+	fetchTextures(ctx->rend.global_param_tr, naomi2);
 }
 
 //
@@ -1433,7 +1430,6 @@ u32 ta_add_ta_data(u32 *data, u32 size)
 {
 	verify(vd_ctx == nullptr);
 	vd_ctx = ta_ctx;
-	BaseTAParser::fetchTextures = false;
 
 	Ta_Dma *ta_data = (Ta_Dma *)data;
 	Ta_Dma *ta_data_end = (Ta_Dma *)(data + size / 4);
@@ -1441,12 +1437,10 @@ u32 ta_add_ta_data(u32 *data, u32 size)
 		ta_data = BaseTAParser::TaCmd(ta_data, ta_data_end);
 	} catch (const FlycastException& e) {
 		vd_ctx = nullptr;
-		BaseTAParser::fetchTextures = true;
 		throw;
 	}
 
 	vd_ctx = nullptr;
-	BaseTAParser::fetchTextures = true;
 
 	return (u8 *)ta_data - (u8 *)data;
 }
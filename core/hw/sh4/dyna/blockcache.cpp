@@ -0,0 +1,568 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "types.h"
+
+#if FEAT_SHREC != DYNAREC_NONE
+#include "blockcache.h"
+#include "blockmanager.h"
+#include "hw/sh4/sh4_core.h"
+#include "hw/sh4/sh4_mem.h"
+#include "hw/sh4/modules/mmu.h"
+#include "hw/sh4/sh4_sched.h"
+#include "cfg/option.h"
+#include "stdclass.h"
+#include "util/worker_thread.h"
+#include "version.h"
+#include <nowide/cstdio.hpp>
+#include <xxhash.h>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+void AnalyseBlock(RuntimeBlockInfo* blk);
+
+namespace blockcache
+{
+
+constexpr u32 MAGIC = 0x48435342;	// "BSCH"
+constexpr u32 VERSION = 2;
+constexpr u32 MAX_ENTRIES = 256 * 1024;
+constexpr u32 MAX_OPS = 512;
+// op, size, guest offset and delay slot, then 5 params: type, value and up to 16 SSA versions
+constexpr u32 OP_MAX_SIZE = 5 + 5 * (5 + 16 * sizeof(u16));
+
+struct Header
+{
+	u32 magic;
+	u32 version;
+	u64 buildHash;
+	u32 sh4Clock;
+	u32 ramSize;
+	u32 entryCount;
+	u32 reserved;
+};
+
+struct Entry
+{
+	u64 pageHash;
+	u32 sh4_code_size;
+	u32 guest_cycles;
+	u32 guest_opcodes;
+	u32 BranchBlock;
+	u32 NextBlock;
+	u32 BlockType;
+	bool has_fpu_op;
+	u32 opCount;
+	std::vector<u8> ops;
+};
+
+// Entries can be added by the background decoder thread
+static std::mutex mutex;
+static std::unordered_map<u64, Entry> entries;
+static std::string gameId;
+static bool dirty;
+static Stats stats;
+
+static WorkerThread decoderThread("SH4Decoder");
+static RuntimeBlockInfo *speculativeBlock;
+static std::atomic<int> pendingDecodes;
+
+// The decoder output only depends on these fpscr bits
+static u64 makeKey(u32 addr, fpscr_t fpu_cfg)
+{
+	u32 fpuBits = fpu_cfg.PR | (fpu_cfg.SZ << 1) | ((fpu_cfg.RM == 1) << 2);
+	return ((u64)fpuBits << 32) | addr;
+}
+
+// The cached op lists are only valid for the decoder and optimizer that produced them
+static u64 getBuildHash()
+{
+	std::string stamp = GIT_HASH;
+	for (int op = 0; op < shop_max; op++)
+	{
+		stamp += shil_opcode_name(op);
+		stamp += ',';
+	}
+	stamp += std::to_string(sh4_reg_count) + ',' + std::to_string(FMT_V16) + ',' + std::to_string(sizeof(shil_param));
+	return XXH3_64bits(stamp.data(), stamp.size());
+}
+
+static std::string getCachePath(const std::string& gameId)
+{
+	std::string name;
+	for (char c : gameId)
+		name += std::isalnum((u8)c) || c == '-' ? c : '_';
+	return get_writable_data_path(name + ".sh4cache");
+}
+
+// The SSA optimizer may read constants anywhere in the pages the block spans,
+// so the whole pages are hashed.
+static bool hashPages(u32 addr, u32 size, u64& hash)
+{
+	u32 start = addr & ~PAGE_MASK;
+	u32 end = (addr + std::max(size, 1u) - 1) | PAGE_MASK;
+	const u8 *p = GetMemPtr(start, end - start + 1);
+	if (p == nullptr)
+		return false;
+	hash = XXH3_64bits(p, end - start + 1);
+	return true;
+}
+
+static bool isPersistent() {
+	return config::DynarecBlockCache && !gameId.empty();
+}
+
+static bool isEnabled() {
+	return isPersistent() || config::DynarecAsyncDecode;
+}
+
+static bool isCacheable(u32 addr)
+{
+	// Same rules as RuntimeBlockInfo::SetProtectedFlags
+	return !mmu_enabled() && IsOnRam(addr) && (addr & 0x1FFF0000) != 0x0c000000;
+}
+
+// Returns true if the block will be write-protected if compiled now
+static bool canProtect(u32 addr, u32 size)
+{
+	if (!isCacheable(addr))
+		return false;
+	for (u32 a = addr & ~PAGE_MASK; a < addr + size; a += PAGE_SIZE)
+		if (!bm_IsRamPageProtected(a))
+			return false;
+	return true;
+}
+
+static void writeParam(std::vector<u8>& v, const shil_param& param)
+{
+	v.push_back((u8)param.type);
+	v.insert(v.end(), (const u8 *)&param._imm, (const u8 *)&param._imm + sizeof(u32));
+	// SSA versions are used by the register allocator
+	if (param.is_reg())
+		v.insert(v.end(), (const u8 *)&param.version[0], (const u8 *)&param.version[param.count()]);
+}
+
+static bool isValidReg(const shil_param& param)
+{
+	if (param.type == FMT_I32 && param._imm == reg_sq_buffer)
+		return true;
+	return param._imm < sh4_reg_count && param._imm + param.count() <= sh4_reg_count;
+}
+
+static bool readParam(const u8 *&p, const u8 *end, shil_param& param)
+{
+	param = shil_param();
+	if (end - p < 5 || *p > FMT_V16)
+		return false;
+	param.type = *p++;
+	memcpy(&param._imm, p, sizeof(u32));
+	p += sizeof(u32);
+	if (param.is_reg())
+	{
+		if (!isValidReg(param))
+			return false;
+		const size_t size = param.count() * sizeof(u16);
+		if ((size_t)(end - p) < size)
+			return false;
+		memcpy(param.version, p, size);
+		p += size;
+	}
+	return true;
+}
+
+static void writeOp(std::vector<u8>& v, const shil_opcode& op)
+{
+	v.push_back((u8)op.op);
+	v.push_back((u8)op.size);
+	v.push_back(op.guest_offs & 0xff);
+	v.push_back(op.guest_offs >> 8);
+	v.push_back(op.delay_slot);
+	writeParam(v, op.rd);
+	writeParam(v, op.rd2);
+	writeParam(v, op.rs1);
+	writeParam(v, op.rs2);
+	writeParam(v, op.rs3);
+}
+
+static bool readOp(const u8 *&p, const u8 *end, u32 codeSize, shil_opcode& op)
+{
+	if (end - p < 5)
+		return false;
+	if (p[0] >= shop_max
+			|| (p[1] != 0 && p[1] != 1 && p[1] != 2 && p[1] != 4 && p[1] != 8)
+			|| p[4] > 1)
+		return false;
+	op.op = (shilop)p[0];
+	op.size = p[1];
+	op.guest_offs = p[2] | (p[3] << 8);
+	op.delay_slot = p[4] != 0;
+	op.host_offs = 0;
+	p += 5;
+	if (op.guest_offs > codeSize)
+		return false;
+	return readParam(p, end, op.rd)
+			&& readParam(p, end, op.rd2)
+			&& readParam(p, end, op.rs1)
+			&& readParam(p, end, op.rs2)
+			&& readParam(p, end, op.rs3);
+}
+
+// Decodes the op list of an entry. Returns false if it's invalid.
+static bool readOps(const Entry& entry, std::vector<shil_opcode>& oplist)
+{
+	oplist.resize(entry.opCount);
+	const u8 *p = entry.ops.data();
+	const u8 *end = p + entry.ops.size();
+	for (shil_opcode& op : oplist)
+		if (!readOp(p, end, entry.sh4_code_size, op))
+			return false;
+	return p == end;
+}
+
+static bool isValidEntry(u64 key, const Entry& entry)
+{
+	const u32 addr = (u32)key;
+	if ((addr & 1) || (key >> 32) > 7)
+		return false;
+	if (entry.sh4_code_size == 0 || entry.sh4_code_size > PAGE_SIZE || (entry.sh4_code_size & 1)
+			|| entry.guest_opcodes == 0 || entry.guest_opcodes > entry.sh4_code_size / 2
+			|| entry.opCount == 0 || entry.opCount > MAX_OPS)
+		return false;
+	switch (entry.BlockType)
+	{
+	case BET_StaticJump:
+	case BET_StaticCall:
+	case BET_StaticIntr:
+	case BET_DynamicJump:
+	case BET_DynamicCall:
+	case BET_DynamicRet:
+	case BET_DynamicIntr:
+	case BET_Cond_0:
+	case BET_Cond_1:
+		break;
+	default:
+		return false;
+	}
+	std::vector<shil_opcode> oplist;
+	return readOps(entry, oplist);
+}
+
+static void store(const RuntimeBlockInfo *block, u64 pageHash)
+{
+	Entry entry;
+	entry.pageHash = pageHash;
+	entry.sh4_code_size = block->sh4_code_size;
+	entry.guest_cycles = block->guest_cycles;
+	entry.guest_opcodes = block->guest_opcodes;
+	entry.BranchBlock = block->BranchBlock;
+	entry.NextBlock = block->NextBlock;
+	entry.BlockType = block->BlockType;
+	entry.has_fpu_op = block->has_fpu_op;
+	entry.opCount = block->oplist.size();
+	if (entry.opCount > MAX_OPS)
+		return;
+	for (const shil_opcode& op : block->oplist)
+		writeOp(entry.ops, op);
+
+	std::lock_guard<std::mutex> _(mutex);
+	if (entries.size() >= MAX_ENTRIES)
+		return;
+	entries[makeKey(block->addr, block->fpu_cfg)] = std::move(entry);
+	dirty = isPersistent();
+}
+
+bool restore(RuntimeBlockInfo *block)
+{
+	if (!isEnabled() || !isCacheable(block->addr))
+		return false;
+	std::lock_guard<std::mutex> _(mutex);
+	if (entries.empty())
+		return false;
+	auto it = entries.find(makeKey(block->addr, block->fpu_cfg));
+	if (it == entries.end())
+	{
+		stats.misses++;
+		return false;
+	}
+	const Entry& entry = it->second;
+	// Let the decoder raise the FPU disabled exception
+	if (entry.has_fpu_op && Sh4cntx.sr.FD == 1)
+		return false;
+	// The block must be write-protected again, or the optimizations applied to it may not be valid anymore
+	if (!canProtect(block->addr, entry.sh4_code_size))
+		return false;
+	u64 hash;
+	if (!hashPages(block->addr, entry.sh4_code_size, hash) || hash != entry.pageHash)
+	{
+		stats.stale++;
+		entries.erase(it);
+		dirty = isPersistent();
+		return false;
+	}
+	if (!readOps(entry, block->oplist))
+	{
+		stats.stale++;
+		entries.erase(it);
+		dirty = isPersistent();
+		block->oplist.clear();
+		return false;
+	}
+	block->sh4_code_size = entry.sh4_code_size;
+	block->guest_cycles = entry.guest_cycles;
+	block->guest_opcodes = entry.guest_opcodes;
+	block->BranchBlock = entry.BranchBlock;
+	block->NextBlock = entry.NextBlock;
+	block->BlockType = (BlockEndType)entry.BlockType;
+	block->has_fpu_op = entry.has_fpu_op;
+	stats.hits++;
+	if (!isPersistent())
+		// Speculatively decoded blocks are only used once
+		entries.erase(it);
+
+	return true;
+}
+
+void add(const RuntimeBlockInfo *block)
+{
+	if (!isPersistent() || !block->read_only || block->temp_block || !isCacheable(block->addr))
+		return;
+	u64 pageHash;
+	if (hashPages(block->addr, block->sh4_code_size, pageHash))
+		store(block, pageHash);
+}
+
+// Runs on the decoder thread
+static void decodeSpeculatively(u32 addr, fpscr_t fpu_cfg)
+{
+	// Make sure the memory doesn't change while the block is decoded
+	// by hashing the 2 pages it may span before and after decoding.
+	const u32 pageAddr = addr & ~PAGE_MASK;
+	u64 hashBefore;
+	if (!hashPages(pageAddr, PAGE_SIZE * 2, hashBefore))
+		return;
+
+	RuntimeBlockInfo *block = speculativeBlock;
+	block->vaddr = block->addr = addr;
+	block->fpu_cfg = fpu_cfg;
+	block->sh4_code_size = 0;
+	block->guest_cycles = 0;
+	block->has_fpu_op = false;
+	block->temp_block = false;
+	block->BranchBlock = NullAddress;
+	block->NextBlock = NullAddress;
+	block->BlockType = BET_SCL_Intr;
+	block->oplist.clear();
+	try {
+		if (!dec_DecodeBlock(block, SH4_TIMESLICE / 2, true))
+			return;
+	} catch (const SH4ThrownException&) {
+		return;
+	} catch (const FlycastException&) {
+		return;
+	}
+	// Only protected blocks can be reused
+	block->read_only = canProtect(addr, block->sh4_code_size);
+	if (!block->read_only)
+		return;
+	AnalyseBlock(block);
+
+	u64 pageHash;
+	u64 hashAfter;
+	if (hashPages(addr, block->sh4_code_size, pageHash)
+			&& hashPages(pageAddr, PAGE_SIZE * 2, hashAfter)
+			&& hashBefore == hashAfter)
+	{
+		store(block, pageHash);
+		std::lock_guard<std::mutex> _(mutex);
+		stats.speculative++;
+	}
+}
+
+void decodeAhead(u32 addr, fpscr_t fpu_cfg)
+{
+	if (!config::DynarecAsyncDecode || addr == NullAddress || (addr & 1) || !isCacheable(addr)
+			|| pendingDecodes >= 16)
+		return;
+	{
+		std::lock_guard<std::mutex> _(mutex);
+		if (entries.count(makeKey(addr, fpu_cfg)) != 0)
+			return;
+	}
+	if (speculativeBlock == nullptr)
+		speculativeBlock = new RuntimeBlockInfo();
+	pendingDecodes++;
+	decoderThread.run([addr, fpu_cfg]() {
+		decodeSpeculatively(addr, fpu_cfg);
+		pendingDecodes--;
+	});
+}
+
+void term()
+{
+	decoderThread.stop();
+	if (speculativeBlock != nullptr)
+	{
+		// Not counted as a protected or unprotected block
+		speculativeBlock->sh4_code_size = 0;
+		delete speculativeBlock;
+		speculativeBlock = nullptr;
+	}
+	pendingDecodes = 0;
+	save();
+	clear();
+}
+
+void load()
+{
+	clear();
+	if (!config::DynarecBlockCache || settings.content.gameId.empty())
+		return;
+	std::lock_guard<std::mutex> _(mutex);
+	gameId = settings.content.gameId;
+	std::string path = getCachePath(gameId);
+	FILE *f = nowide::fopen(path.c_str(), "rb");
+	if (f == nullptr)
+		return;
+	Header header;
+	if (std::fread(&header, sizeof(header), 1, f) != 1
+			|| header.magic != MAGIC || header.version != VERSION || header.buildHash != getBuildHash()
+			|| header.entryCount > MAX_ENTRIES
+			|| header.sh4Clock != (u32)config::Sh4Clock || header.ramSize != settings.platform.ram_size)
+	{
+		INFO_LOG(DYNAREC, "Ignoring obsolete block cache %s", path.c_str());
+		std::fclose(f);
+		return;
+	}
+	u32 invalid = 0;
+	for (u32 i = 0; i < header.entryCount; i++)
+	{
+		u64 key;
+		Entry entry;
+		u32 fields[6];
+		u8 hasFpuOp;
+		u32 opsSize;
+		if (std::fread(&key, sizeof(key), 1, f) != 1
+				|| std::fread(&entry.pageHash, sizeof(entry.pageHash), 1, f) != 1
+				|| std::fread(fields, sizeof(fields), 1, f) != 1
+				|| std::fread(&hasFpuOp, 1, 1, f) != 1
+				|| std::fread(&entry.opCount, sizeof(entry.opCount), 1, f) != 1
+				|| std::fread(&opsSize, sizeof(opsSize), 1, f) != 1
+				|| entry.opCount > MAX_OPS || opsSize > MAX_OPS * OP_MAX_SIZE)
+		{
+			invalid++;
+			break;
+		}
+		entry.sh4_code_size = fields[0];
+		entry.guest_cycles = fields[1];
+		entry.guest_opcodes = fields[2];
+		entry.BranchBlock = fields[3];
+		entry.NextBlock = fields[4];
+		entry.BlockType = fields[5];
+		entry.has_fpu_op = hasFpuOp != 0;
+		entry.ops.resize(opsSize);
+		if (std::fread(entry.ops.data(), 1, entry.ops.size(), f) != entry.ops.size())
+		{
+			invalid++;
+			break;
+		}
+		if (hasFpuOp > 1 || !isValidEntry(key, entry))
+			invalid++;
+		else
+			entries[key] = std::move(entry);
+	}
+	std::fclose(f);
+	// Rewrite the file without the invalid entries
+	dirty = invalid != 0;
+	if (invalid != 0)
+		WARN_LOG(DYNAREC, "Block cache %s is corrupted: %d entries ignored", path.c_str(), invalid);
+	INFO_LOG(DYNAREC, "Loaded %d blocks from block cache %s", (int)entries.size(), path.c_str());
+}
+
+void save()
+{
+	std::lock_guard<std::mutex> _(mutex);
+	if (gameId.empty() || !dirty)
+		return;
+	std::string path = getCachePath(gameId);
+	// write to a temporary file so that an interrupted write never leaves a truncated cache file
+	std::string tempPath = path + ".tmp";
+	FILE *f = nowide::fopen(tempPath.c_str(), "wb");
+	if (f == nullptr)
+	{
+		WARN_LOG(DYNAREC, "Cannot save block cache to %s", tempPath.c_str());
+		return;
+	}
+	Header header{};
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.buildHash = getBuildHash();
+	header.sh4Clock = config::Sh4Clock;
+	header.ramSize = settings.platform.ram_size;
+	header.entryCount = entries.size();
+	bool success = std::fwrite(&header, sizeof(header), 1, f) == 1;
+	for (const auto& [key, entry] : entries)
+	{
+		if (!success)
+			break;
+		u32 fields[6] { entry.sh4_code_size, entry.guest_cycles, entry.guest_opcodes,
+			entry.BranchBlock, entry.NextBlock, entry.BlockType };
+		u8 hasFpuOp = entry.has_fpu_op;
+		u32 opsSize = entry.ops.size();
+		success = std::fwrite(&key, sizeof(key), 1, f) == 1
+				&& std::fwrite(&entry.pageHash, sizeof(entry.pageHash), 1, f) == 1
+				&& std::fwrite(fields, sizeof(fields), 1, f) == 1
+				&& std::fwrite(&hasFpuOp, 1, 1, f) == 1
+				&& std::fwrite(&entry.opCount, sizeof(entry.opCount), 1, f) == 1
+				&& std::fwrite(&opsSize, sizeof(opsSize), 1, f) == 1
+				&& std::fwrite(entry.ops.data(), 1, entry.ops.size(), f) == entry.ops.size();
+	}
+	success = std::fclose(f) == 0 && success;
+	if (success)
+	{
+		nowide::remove(path.c_str());
+		success = nowide::rename(tempPath.c_str(), path.c_str()) == 0;
+	}
+	if (!success)
+		nowide::remove(tempPath.c_str());
+	if (success)
+		INFO_LOG(DYNAREC, "Saved %d blocks to block cache %s", (int)entries.size(), path.c_str());
+	else
+		WARN_LOG(DYNAREC, "Error saving block cache to %s", path.c_str());
+	dirty = false;
+}
+
+void clear()
+{
+	std::lock_guard<std::mutex> _(mutex);
+	entries.clear();
+	gameId.clear();
+	dirty = false;
+	stats = {};
+}
+
+Stats getStats()
+{
+	std::lock_guard<std::mutex> _(mutex);
+	Stats s = stats;
+	s.entries = entries.size();
+	return s;
+}
+
+}	// namespace blockcache
+#endif	// FEAT_SHREC != DYNAREC_NONE
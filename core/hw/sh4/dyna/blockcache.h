@@ -0,0 +1,64 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "types.h"
+#include "hw/sh4/sh4_if.h"
+
+struct RuntimeBlockInfo;
+
+//
+// Cache of decoded and optimized SH4 blocks.
+// Each entry holds the shil opcode list of a block and is keyed by its address and FPU configuration.
+// An entry is only reused if the hash of the RAM pages the block was decoded from still matches,
+// so that the decoder and SSA passes can be skipped when the block is compiled.
+// Entries are either saved to disk and reused on the next run of the same game,
+// or decoded ahead of execution by a background thread.
+// Only write-protected blocks are cached. Host code is always generated by the dynarec backend.
+//
+namespace blockcache
+{
+
+// Load the cache file of the current game. Called when a game is started.
+void load();
+// Write the cache file of the game that was loaded. Called when the game is terminated.
+void save();
+// Drop all entries without saving them
+void clear();
+// Stop the background decoder, save and drop all entries
+void term();
+
+// Fill the block decoding information from the cache if available. The block address and fpu config must be set.
+// Returns false if the block isn't in the cache or is stale.
+bool restore(RuntimeBlockInfo *block);
+// Add a newly decoded block to the cache.
+void add(const RuntimeBlockInfo *block);
+// Decode the block at the given address on a background thread so that it's ready when compiled.
+void decodeAhead(u32 addr, fpscr_t fpu_cfg);
+
+struct Stats
+{
+	u32 entries;
+	u32 hits;
+	u32 misses;
+	u32 stale;
+	u32 speculative;
+};
+Stats getStats();
+
+}
@@ -4,8 +4,8 @@
 */
 
 #include <algorithm>
-#include <set>
-#include <map>
+#include <array>
+#include <memory>
 #include "blockmanager.h"
 #include "ngen.h"
 
@@ -26,17 +26,108 @@ op_agent_t          oprofHandle;
 
 
 typedef std::vector<RuntimeBlockInfoPtr> bm_List;
-typedef std::set<RuntimeBlockInfoPtr> bm_Set;
-typedef std::map<void*, RuntimeBlockInfoPtr> bm_Map;
 
-static bm_Set all_temp_blocks;
+static bm_List all_temp_blocks;
 static bm_List del_blocks;
 
 static u32 pageCount;
 bool *unprotected_pages;
-static std::set<RuntimeBlockInfo*> *blocks_per_page;
+// Head of the intrusive list of protected blocks for each RAM page
+static RuntimeBlockInfo **blocks_per_page;
 
-static bm_Map blkmap;
+// Blocks sorted by host code address.
+// Discarded blocks leave a tombstone (null block) so that removing a block doesn't require moving the whole array.
+// Tombstones are reused when a new block is emitted at the same address, or removed when they become too numerous.
+class BlockMap
+{
+public:
+	struct Entry
+	{
+		void *code;
+		RuntimeBlockInfo *block;
+
+		bool operator<(const void *other) const {
+			return code < other;
+		}
+	};
+
+	void insert(RuntimeBlockInfo *block)
+	{
+		void *code = (void *)block->code;
+		if (entries.empty() || entries.back().code < code)
+		{
+			// Most common case since the code buffer is filled sequentially
+			entries.push_back({ code, block });
+			return;
+		}
+		auto it = std::lower_bound(entries.begin(), entries.end(), code);
+		if (it != entries.end() && it->code == code)
+		{
+			if (it->block != nullptr) {
+				ERROR_LOG(DYNAREC, "DUP: %08X %p %08X %p", it->block->addr, it->block->code, block->addr, block->code);
+				die("Duplicated block");
+			}
+			it->block = block;
+			tombstones--;
+		}
+		else {
+			entries.insert(it, { code, block });
+		}
+	}
+
+	void erase(RuntimeBlockInfo *block)
+	{
+		auto it = std::lower_bound(entries.begin(), entries.end(), (void *)block->code);
+		verify(it != entries.end() && it->block == block);
+		it->block = nullptr;
+		tombstones++;
+		if (tombstones >= 1024 && tombstones >= entries.size() / 2)
+			compact();
+	}
+
+	// Returns the block containing the given host code address
+	RuntimeBlockInfo *find(void *code) const
+	{
+		// Find the first block whose code addr is bigger than code (or end)
+		auto it = std::upper_bound(entries.begin(), entries.end(), code,
+				[](const void *code, const Entry& entry) { return code < entry.code; });
+		// Go back to find the potential candidate
+		while (it != entries.begin())
+		{
+			--it;
+			if (it->block != nullptr)
+				// However it might be out of bounds, check for that
+				return it->block->containsCode(code) ? it->block : nullptr;
+		}
+		return nullptr;
+	}
+
+	void clear() {
+		entries.clear();
+		tombstones = 0;
+	}
+
+	template<typename F>
+	void forEach(F func) const
+	{
+		for (const Entry& entry : entries)
+			if (entry.block != nullptr)
+				func(entry.block);
+	}
+
+private:
+	void compact()
+	{
+		entries.erase(std::remove_if(entries.begin(), entries.end(),
+				[](const Entry& entry) { return entry.block == nullptr; }), entries.end());
+		tombstones = 0;
+	}
+
+	std::vector<Entry> entries;
+	size_t tombstones = 0;
+};
+
+static BlockMap blkmap;
 // Stats
 u32 protected_blocks;
 u32 unprotected_blocks;
@@ -124,25 +215,13 @@ RuntimeBlockInfoPtr DYNACALL bm_GetBlock(u32 addr)
 // This takes a RX address and returns the info block ptr (RW space)
 RuntimeBlockInfoPtr bm_GetBlock(void* dynarec_code)
 {
-	if (blkmap.empty())
-		return NULL;
-
-	void *dynarecrw = CC_RX2RW(dynarec_code);
-	// Returns a block who's code addr is bigger than dynarec_code (or end)
-	auto iter = blkmap.upper_bound(dynarecrw);
-	if (iter == blkmap.begin())
-		return NULL;
-	iter--;  // Need to go back to find the potential candidate
-
-	// However it might be out of bounds, check for that
-	if (!iter->second->containsCode(dynarecrw))
-		return NULL;
-
-	return iter->second;
+	return blkmap.find(CC_RX2RW(dynarec_code));
 }
 
 static void bm_CleanupDeletedBlocks()
 {
+	for (RuntimeBlockInfo *block : del_blocks)
+		delete block;
 	del_blocks.clear();
 }
 
@@ -164,17 +243,11 @@ RuntimeBlockInfoPtr bm_GetStaleBlock(void* dynarec_code)
 	return NULL;
 }
 
-void bm_AddBlock(RuntimeBlockInfo* blk)
+void bm_AddBlock(RuntimeBlockInfo* block)
 {
-	RuntimeBlockInfoPtr block(blk);
 	if (block->temp_block)
-		all_temp_blocks.insert(block);
-	auto iter = blkmap.find((void*)blk->code);
-	if (iter != blkmap.end()) {
-		ERROR_LOG(DYNAREC, "DUP: %08X %p %08X %p", iter->second->addr, iter->second->code, block->addr, block->code);
-		die("Duplicated block");
-	}
-	blkmap[(void*)block->code] = block;
+		all_temp_blocks.push_back(block);
+	blkmap.insert(block);
 
 	verify((void*)bm_GetCode(block->addr) == (void*)ngen_FailedToFindBlock);
 	FPCA(block->addr) = (DynarecCodeEntryPtr)CC_RW2RX(block->code);
@@ -195,28 +268,35 @@ void bm_AddBlock(RuntimeBlockInfo* blk)
 
 }
 
+static void removeTempBlock(RuntimeBlockInfo *block)
+{
+	// Most recent blocks are more likely to be discarded
+	auto it = std::find(all_temp_blocks.rbegin(), all_temp_blocks.rend(), block);
+	if (it != all_temp_blocks.rend())
+	{
+		*it = all_temp_blocks.back();
+		all_temp_blocks.pop_back();
+	}
+}
+
 void bm_DiscardBlock(RuntimeBlockInfo* block)
 {
 	// Remove from block map
-	auto it = blkmap.find((void*)block->code);
-	verify(it != blkmap.end());
-	RuntimeBlockInfoPtr block_ptr = it->second;
-
-	blkmap.erase(it);
+	blkmap.erase(block);
+	block->Discard();
 
-	block_ptr->pNextBlock = NULL;
-	block_ptr->pBranchBlock = NULL;
-	block_ptr->Relink();
+	block->pNextBlock = NULL;
+	block->pBranchBlock = NULL;
+	block->Relink();
 
 	// Remove from jump table
-	verify((void*)bm_GetCode(block_ptr->addr) == CC_RW2RX((void*)block_ptr->code));
-	FPCA(block_ptr->addr) = ngen_FailedToFindBlock;
+	verify((void*)bm_GetCode(block->addr) == CC_RW2RX((void*)block->code));
+	FPCA(block->addr) = ngen_FailedToFindBlock;
 
-	if (block_ptr->temp_block)
-		all_temp_blocks.erase(block_ptr);
+	if (block->temp_block)
+		removeTempBlock(block);
 
-	del_blocks.push_back(block_ptr);
-	block_ptr->Discard();
+	del_blocks.push_back(block);
 }
 
 void bm_Periodical_1s()
@@ -286,25 +366,21 @@ void bm_ResetCache()
 	sh4Dynarec->reset();
 	addrspace::bm_reset();
 
-	for (const auto& it : blkmap)
-	{
-		RuntimeBlockInfoPtr block = it.second;
+	blkmap.forEach([](RuntimeBlockInfo *block) {
+		block->Discard();
 		block->relink_data = 0;
 		block->pNextBlock = NULL;
 		block->pBranchBlock = NULL;
 		// needed for the transition to full mmu. Could perhaps limit it to the current block.
 		block->Relink();
-		// Avoid circular references
-		block->Discard();
 		del_blocks.push_back(block);
-	}
+	});
 
 	blkmap.clear();
 	// blkmap includes temp blocks as well
 	all_temp_blocks.clear();
 
-	for (size_t i = 0; i < pageCount; i++)
-		blocks_per_page[i].clear();
+	memset(blocks_per_page, 0, pageCount * sizeof(blocks_per_page[0]));
 
 	memset(unprotected_pages, 0, pageCount);
 
@@ -326,13 +402,11 @@ void bm_ResetTempCache(bool full)
 {
 	if (!full)
 	{
-		for (const auto& block : all_temp_blocks)
-		{
-			FPCA(block->addr) = ngen_FailedToFindBlock;
-			blkmap.erase((void*)block->code);
-		}
+		// Blocks must be unlinked from their predecessors since their code will be overwritten
+		while (!all_temp_blocks.empty())
+			bm_DiscardBlock(all_temp_blocks.back());
 	}
-	del_blocks.insert(del_blocks.begin(),all_temp_blocks.begin(),all_temp_blocks.end());
+	// otherwise temp blocks have already been discarded with all other blocks
 	all_temp_blocks.clear();
 }
 
@@ -340,7 +414,7 @@ void bm_Init()
 {
 	pageCount = RAM_SIZE_MAX / PAGE_SIZE;
 	unprotected_pages = new bool[pageCount];
-	blocks_per_page = new std::set<RuntimeBlockInfo*>[pageCount];
+	blocks_per_page = new RuntimeBlockInfo *[pageCount]();
 
 #ifdef DYNA_OPROF
 	oprofHandle=op_open_agent();
@@ -358,6 +432,12 @@ void bm_Term()
 	
 	oprofHandle=0;
 #endif
+	blkmap.forEach([](RuntimeBlockInfo *block) {
+		block->pre_refs.clear();
+		del_blocks.push_back(block);
+	});
+	blkmap.clear();
+	all_temp_blocks.clear();
 	bm_Reset();
 	delete[] unprotected_pages;
 	delete[] blocks_per_page;
@@ -369,12 +449,11 @@ void bm_WriteBlockMap(const std::string& file)
 	if (f)
 	{
 		INFO_LOG(DYNAREC, "Writing block map !");
-		for (const auto& [_, block] : blkmap)
-		{
+		blkmap.forEach([f](RuntimeBlockInfo *block) {
 			fprintf(f, "block: %d:%08X:%p:%d:%d:%d\n", block->BlockType, block->addr, block->code, block->host_code_size, block->guest_cycles, block->guest_opcodes);
 			for(size_t j = 0; j < block->oplist.size(); j++)
 				fprintf(f,"\top: %zd:%d:%s\n", j, block->oplist[j].guest_offs, block->oplist[j].dissasm().c_str());
-		}
+		});
 		fclose(f);
 		INFO_LOG(DYNAREC, "Finished writing block map");
 	}
@@ -382,10 +461,9 @@ void bm_WriteBlockMap(const std::string& file)
 
 void sh4_jitsym(FILE* out)
 {
-	for (const auto& [_, block] : blkmap)
-	{
+	blkmap.forEach([out](RuntimeBlockInfo *block) {
 		fprintf(out, "%p %d %08X\n", block->code, block->host_code_size, block->addr);
-	}
+	});
 }
 
 RuntimeBlockInfo::~RuntimeBlockInfo()
@@ -399,22 +477,127 @@ RuntimeBlockInfo::~RuntimeBlockInfo()
 	}
 }
 
-void RuntimeBlockInfo::AddRef(const RuntimeBlockInfoPtr& other)
+// Size-segregated free lists of RuntimeBlockInfo objects, including the derived classes of each dynarec.
+// Blocks are allocated and freed at a high rate by self-modifying code.
+class BlockPool
+{
+public:
+	void *alloc(size_t size)
+	{
+		const size_t idx = index(size);
+		if (idx >= freeLists.size())
+			return ::operator new(size);
+		if (freeLists[idx] == nullptr)
+		{
+			const size_t objSize = (idx + 1) * Granularity;
+			chunks.push_back(std::make_unique<u8[]>(objSize * ChunkCount));
+			u8 *p = chunks.back().get();
+			for (size_t i = 0; i < ChunkCount; i++, p += objSize)
+				free(p, idx);
+		}
+		FreeObject *obj = freeLists[idx];
+		freeLists[idx] = obj->next;
+		return obj;
+	}
+
+	void release(void *p, size_t size)
+	{
+		const size_t idx = index(size);
+		if (idx >= freeLists.size())
+			::operator delete(p);
+		else
+			free(p, idx);
+	}
+
+private:
+	struct FreeObject {
+		FreeObject *next;
+	};
+
+	static size_t index(size_t size) {
+		return (size - 1) / Granularity;
+	}
+
+	void free(void *p, size_t idx)
+	{
+		FreeObject *obj = (FreeObject *)p;
+		obj->next = freeLists[idx];
+		freeLists[idx] = obj;
+	}
+
+	static constexpr size_t Granularity = 16;
+	static constexpr size_t ChunkCount = 256;
+	std::array<FreeObject *, 1024 / Granularity> freeLists {};
+	std::vector<std::unique_ptr<u8[]>> chunks;
+};
+static BlockPool blockPool;
+
+void *RuntimeBlockInfo::operator new(size_t size)
+{
+	return blockPool.alloc(size);
+}
+
+void RuntimeBlockInfo::operator delete(void *p, size_t size)
+{
+	blockPool.release(p, size);
+}
+
+void RuntimeBlockInfo::AddRef(RuntimeBlockInfo *other)
 { 
 	pre_refs.push_back(other); 
 }
 
-void RuntimeBlockInfo::RemRef(const RuntimeBlockInfoPtr& other)
+void RuntimeBlockInfo::RemRef(RuntimeBlockInfo *other)
 {
 	auto it = std::find(pre_refs.begin(), pre_refs.end(), other);
 	if (it != pre_refs.end())
-		pre_refs.erase(it);
+	{
+		*it = pre_refs.back();
+		pre_refs.pop_back();
+	}
+}
+
+RuntimeBlockInfo::PageLink& RuntimeBlockInfo::pageLink(u32 page)
+{
+	// index of the page in the block, which may wrap around the end of ram
+	const u32 index = (page - (addr & RAM_MASK) / PAGE_SIZE) & (RAM_SIZE / PAGE_SIZE - 1);
+	if (index < std::size(page_links))
+		return page_links[index];
+	else
+		return extra_page_links[index - std::size(page_links)];
+}
+
+static void addToPage(RuntimeBlockInfo *block, u32 page)
+{
+	RuntimeBlockInfo *&head = blocks_per_page[page];
+	auto& link = block->pageLink(page);
+	link.prev = nullptr;
+	link.next = head;
+	if (head != nullptr)
+		head->pageLink(page).prev = block;
+	head = block;
+}
+
+static void removeFromPage(RuntimeBlockInfo *block, u32 page)
+{
+	auto& link = block->pageLink(page);
+	if (link.prev != nullptr)
+		link.prev->pageLink(page).next = link.next;
+	else if (blocks_per_page[page] == block)
+		blocks_per_page[page] = link.next;
+	if (link.next != nullptr)
+		link.next->pageLink(page).prev = link.prev;
+	link.prev = link.next = nullptr;
 }
 
 void RuntimeBlockInfo::Discard()
 {
+	// Remove references to this block from its successors since it's going to be deleted
+	for (RuntimeBlockInfo *next : { pNextBlock, pBranchBlock })
+		if (next != nullptr)
+			next->pre_refs.erase(std::remove(next->pre_refs.begin(), next->pre_refs.end(), this), next->pre_refs.end());
 	// Update references
-	for (RuntimeBlockInfoPtr& ref : pre_refs)
+	for (RuntimeBlockInfo *ref : pre_refs)
 	{
 		if (ref->pNextBlock == this)
 			ref->pNextBlock = nullptr;
@@ -429,10 +612,7 @@ void RuntimeBlockInfo::Discard()
 	{
 		// Remove this block from the per-page block lists
 		for (u32 addr = this->addr & ~PAGE_MASK; addr < this->addr + this->sh4_code_size; addr += PAGE_SIZE)
-		{
-			auto& block_list = blocks_per_page[(addr & RAM_MASK) / PAGE_SIZE];
-			block_list.erase(this);
-		}
+			removeFromPage(this, (addr & RAM_MASK) / PAGE_SIZE);
 	}
 }
 
@@ -456,12 +636,15 @@ void RuntimeBlockInfo::SetProtectedFlags()
 	}
 	this->read_only = true;
 	protected_blocks++;
+	const u32 pageCount = (((this->addr + sh4_code_size - 1) & ~PAGE_MASK) - (this->addr & ~PAGE_MASK)) / PAGE_SIZE + 1;
+	if (pageCount > std::size(page_links))
+		extra_page_links.resize(pageCount - std::size(page_links));
 	for (u32 addr = this->addr & ~PAGE_MASK; addr < this->addr + sh4_code_size; addr += PAGE_SIZE)
 	{
-		auto& block_list = blocks_per_page[(addr & RAM_MASK) / PAGE_SIZE];
-		if (block_list.empty())
+		const u32 page = (addr & RAM_MASK) / PAGE_SIZE;
+		if (blocks_per_page[page] == nullptr)
 			bm_LockPage(addr);
-		block_list.insert(this);
+		addToPage(this, page);
 	}
 }
 
@@ -473,16 +656,13 @@ void bm_RamWriteAccess(u32 addr)
 
 	unprotected_pages[addr / PAGE_SIZE] = true;
 	bm_UnlockPage(addr);
-	std::set<RuntimeBlockInfo*>& block_list = blocks_per_page[addr / PAGE_SIZE];
-	if (!block_list.empty())
+	RuntimeBlockInfo *&head = blocks_per_page[addr / PAGE_SIZE];
+	if (head != nullptr)
 	{
-		std::vector<RuntimeBlockInfo*> list_copy;
-		list_copy.insert(list_copy.begin(), block_list.begin(), block_list.end());
-		if (!list_copy.empty())
-			DEBUG_LOG(DYNAREC, "bm_RamWriteAccess write access to %08x pc %08x", addr, Sh4cntx.pc);
-		for (auto& block : list_copy)
-			bm_DiscardBlock(block);
-		verify(block_list.empty());
+		DEBUG_LOG(DYNAREC, "bm_RamWriteAccess write access to %08x pc %08x", addr, Sh4cntx.pc);
+		// Discarding a block removes it from the list
+		while (head != nullptr)
+			bm_DiscardBlock(head);
 	}
 }
 
@@ -553,11 +733,10 @@ void print_blocks()
 		INFO_LOG(DYNAREC, "Writing blocks to %p", f);
 	}
 
-	for (const auto& [_, blk] : blkmap)
-	{
+	blkmap.forEach([f](RuntimeBlockInfo *blk) {
 		if (f)
 		{
-			fprintf(f,"block: %p\n",blk.get());
+			fprintf(f,"block: %p\n",blk);
 			fprintf(f,"vaddr: %08X\n",blk->vaddr);
 			fprintf(f,"paddr: %08X\n",blk->addr);
 			fprintf(f,"code: %p\n",blk->code);
@@ -605,7 +784,7 @@ void print_blocks()
 
 			fprintf(f,"}\n");
 		}
-	}
+	});
 
 	if (f) fclose(f);
 }
@@ -5,15 +5,15 @@
 #include "shil.h"
 #include "stdclass.h"
 
-#include <memory>
+#include <vector>
 
 typedef void (*DynarecCodeEntryPtr)();
 struct RuntimeBlockInfo;
-typedef std::shared_ptr<RuntimeBlockInfo> RuntimeBlockInfoPtr;
+typedef RuntimeBlockInfo* RuntimeBlockInfoPtr;
 
 struct RuntimeBlockInfo
 {
-	bool Setup(u32 pc,fpscr_t fpu_cfg);
+	bool Setup(u32 pc, fpscr_t fpu_cfg, bool superblock = false);
 
 	u32 addr;
 	u32 vaddr;
@@ -28,6 +28,7 @@ struct RuntimeBlockInfo
 	u32 host_opcodes;	// set by host code generator, optional
 	bool has_fpu_op;
 	bool temp_block;
+	bool superblock;	// spans several unconditional branches
 	u32 blockcheck_failures;
 
 	u32 BranchBlock; //if not 0xFFFFFFFF then jump target
@@ -47,6 +48,16 @@ struct RuntimeBlockInfo
 	std::vector<shil_opcode> oplist;
 	//predecessors references
 	std::vector<RuntimeBlockInfoPtr> pre_refs;
+	// links in the per-page lists of protected blocks
+	struct PageLink {
+		RuntimeBlockInfo *prev;
+		RuntimeBlockInfo *next;
+	};
+	PageLink page_links[2];
+	// for the rare blocks spanning more than 2 pages
+	std::vector<PageLink> extra_page_links;
+
+	PageLink& pageLink(u32 page);
 
 	bool containsCode(const void *ptr)
 	{
@@ -55,12 +66,16 @@ struct RuntimeBlockInfo
 
 	virtual ~RuntimeBlockInfo();
 
+	// Blocks are allocated from a pool
+	static void *operator new(size_t size);
+	static void operator delete(void *p, size_t size);
+
 	virtual u32 Relink() {
 		return 0;
 	}
 	
-	void AddRef(const RuntimeBlockInfoPtr& other);
-	void RemRef(const RuntimeBlockInfoPtr& other);
+	void AddRef(RuntimeBlockInfo *other);
+	void RemRef(RuntimeBlockInfo *other);
 
 	void Discard();
 	void SetProtectedFlags();
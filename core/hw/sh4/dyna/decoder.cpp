@@ -21,9 +21,14 @@
 
 #define BLOCK_MAX_SH_OPS_SOFT 500
 #define BLOCK_MAX_SH_OPS_HARD 511
+// Superblocks follow unconditional static branches as long as the code stays within this distance
+// from the start of the block, so that it spans 2 pages at most and can be protected and checked as a whole
+#define SUPERBLOCK_MAX_SIZE 2048
+#define SUPERBLOCK_MAX_BRANCHES 4
 
-static RuntimeBlockInfo* blk;
-static Sh4Cycles cycleCounter;
+// Blocks can be decoded by the emulation thread and the background decoder thread
+static thread_local RuntimeBlockInfo* blk;
+static thread_local Sh4Cycles cycleCounter;
 
 static inline shil_param mk_imm(u32 immv)
 {
@@ -40,7 +45,7 @@ static inline shil_param mk_regi(int reg)
 	return mk_reg((Sh4RegType)reg);
 }
 
-static state_t state;
+static thread_local state_t state;
 
 static void Emit(shilop op, shil_param rd = shil_param(), shil_param rs1 = shil_param(), shil_param rs2 = shil_param(),
 		u32 size = 0, shil_param rs3 = shil_param(), shil_param rd2 = shil_param())
@@ -558,9 +563,9 @@ static void dec_param(DecParam p,shil_param& r1,shil_param& r2, u32 op)
 #define DIV1_KEY 0x3004
 #define ROTCL_KEY 0x4024
 
-static Sh4RegType div_som_reg1;
-static Sh4RegType div_som_reg2;
-static Sh4RegType div_som_reg3;
+static thread_local Sh4RegType div_som_reg1;
+static thread_local Sh4RegType div_som_reg2;
+static thread_local Sh4RegType div_som_reg3;
 
 static u32 MatchDiv32(u32 pc , Sh4RegType &reg1,Sh4RegType &reg2 , Sh4RegType &reg3)
 {
@@ -950,7 +955,7 @@ void dec_updateBlockCycles(RuntimeBlockInfo *block, u16 op)
 	block->guest_cycles += cycleCounter.countCycles(op);
 }
 
-bool dec_DecodeBlock(RuntimeBlockInfo* rbi,u32 max_cycles)
+bool dec_DecodeBlock(RuntimeBlockInfo* rbi, u32 max_cycles, bool speculative, bool superblock)
 {
 	blk=rbi;
 	state_Setup(blk->vaddr, blk->fpu_cfg);
@@ -959,6 +964,12 @@ bool dec_DecodeBlock(RuntimeBlockInfo* rbi,u32 max_cycles)
 	cycleCounter.reset();
 	// If full MMU, don't allow the block to extend past the end of the current 4K page
 	u32 max_pc = mmu_enabled() ? ((state.cpu.rpc >> 12) + 1) << 12 : 0xFFFFFFFF;
+	superblock = superblock && !mmu_enabled();
+	if (superblock)
+		max_pc = blk->vaddr + SUPERBLOCK_MAX_SIZE;
+	// Highest address decoded. The code of a superblock isn't contiguous but the whole range is covered.
+	u32 end_pc = state.cpu.rpc;
+	int branches = 0;
 	
 	for(;;)
 	{
@@ -984,7 +995,8 @@ bool dec_DecodeBlock(RuntimeBlockInfo* rbi,u32 max_cycles)
 
 					if (!blk->has_fpu_op && OpDesc[op]->IsFloatingPoint())
 					{
-						if (Sh4cntx.sr.FD == 1)
+						// The FPU state is checked again before a speculatively decoded block is used
+						if (Sh4cntx.sr.FD == 1 && !speculative)
 						{
 							// We need to know FPSCR to compile the block, so let the exception handler run first
 							// as it may change the fp registers
@@ -1017,11 +1029,26 @@ bool dec_DecodeBlock(RuntimeBlockInfo* rbi,u32 max_cycles)
 						OpDesc[op]->rec_oph(op);
 					}
 					state.cpu.rpc+=2;
+					end_pc = std::max(end_pc, state.cpu.rpc);
 				}
 			}
 			break;
 
 		case NDO_End:
+			// Continue decoding at the target of a bra or bsr. Their delay slot has been decoded.
+			if (superblock && state.cpu.is_delayslot
+					&& (state.BlockType == BET_StaticJump || state.BlockType == BET_StaticCall)
+					&& state.JumpAddr >= blk->vaddr && state.JumpAddr < max_pc
+					&& branches < SUPERBLOCK_MAX_BRANCHES)
+			{
+				branches++;
+				state.cpu.rpc = state.JumpAddr;
+				state.cpu.is_delayslot = false;
+				state.NextOp = NDO_NextOp;
+				state.JumpAddr = NullAddress;
+				state.NextAddr = NullAddress;
+				continue;
+			}
 			// Disabled for now since we need to know if the block is read-only,
 			// which isn't determined until after the decoding.
 			// This is a relatively rare optimization anyway
@@ -1053,7 +1080,7 @@ bool dec_DecodeBlock(RuntimeBlockInfo* rbi,u32 max_cycles)
 	}
 
 _end:
-	blk->sh4_code_size=state.cpu.rpc-blk->vaddr;
+	blk->sh4_code_size = end_pc - blk->vaddr;
 	blk->NextBlock=state.NextAddr;
 	blk->BranchBlock=state.JumpAddr;
 	blk->BlockType=state.BlockType;
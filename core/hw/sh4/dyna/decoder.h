@@ -37,7 +37,9 @@ enum NextDecoderOperation
 };
 
 struct RuntimeBlockInfo;
-bool dec_DecodeBlock(RuntimeBlockInfo* rbi,u32 max_cycles);
+// If speculative is true, the block is decoded ahead of execution and no exception is raised.
+// If superblock is true, decoding continues at the target of unconditional static branches.
+bool dec_DecodeBlock(RuntimeBlockInfo* rbi, u32 max_cycles, bool speculative = false, bool superblock = false);
 void dec_updateBlockCycles(RuntimeBlockInfo *block, u16 op);
 
 struct state_t
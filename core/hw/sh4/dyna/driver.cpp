@@ -1,4 +1,5 @@
 #include "types.h"
+#include <unordered_map>
 #include <unordered_set>
 
 #include "hw/sh4/sh4_interpreter.h"
@@ -9,9 +10,12 @@
 #include "hw/sh4/modules/mmu.h"
 
 #include "blockmanager.h"
+#include "blockcache.h"
 #include "ngen.h"
 #include "decoder.h"
 #include "oslib/virtmem.h"
+#include "emulator.h"
+#include "cfg/option.h"
 
 #if FEAT_SHREC != DYNAREC_NONE
 
@@ -40,6 +44,15 @@ ptrdiff_t cc_rx_offset;
 
 static std::unordered_set<u32> smc_hotspots;
 
+// The pc is sampled at the end of each time slice. Blocks that are sampled often enough
+// are recompiled as superblocks.
+constexpr u32 SUPERBLOCK_HOT_SAMPLES = 32;
+// The samples are discarded when this many addresses have been sampled
+constexpr size_t MAX_SAMPLED_BLOCKS = 4096;
+constexpr size_t MAX_SUPERBLOCKS = 1024;
+static std::unordered_map<u32, u32> hot_samples;
+static std::unordered_set<u32> superblocks;
+
 static Sh4CodeBuffer codeBuffer;
 Sh4Dynarec *sh4Dynarec;
 Sh4Recompiler *Sh4Recompiler::Instance;
@@ -96,6 +109,8 @@ void Sh4Recompiler::ResetCache()
 	codeBuffer.reset(false);
 	bm_ResetCache();
 	smc_hotspots.clear();
+	hot_samples.clear();
+	superblocks.clear();
 	clear_temp_cache(true);
 }
 
@@ -114,7 +129,7 @@ void Sh4Recompiler::Run()
 
 void AnalyseBlock(RuntimeBlockInfo* blk);
 
-bool RuntimeBlockInfo::Setup(u32 rpc,fpscr_t rfpu_cfg)
+bool RuntimeBlockInfo::Setup(u32 rpc, fpscr_t rfpu_cfg, bool superblock)
 {
 	addr = host_code_size = 0;
 	guest_cycles = guest_opcodes = host_opcodes = 0;
@@ -127,6 +142,7 @@ bool RuntimeBlockInfo::Setup(u32 rpc,fpscr_t rfpu_cfg)
 	BlockType = BET_SCL_Intr;
 	has_fpu_op = false;
 	temp_block = false;
+	this->superblock = superblock;
 	
 	vaddr = rpc;
 	if (vaddr & 1)
@@ -152,17 +168,28 @@ bool RuntimeBlockInfo::Setup(u32 rpc,fpscr_t rfpu_cfg)
 	
 	oplist.clear();
 
-	try {
-		if (!dec_DecodeBlock(this, SH4_TIMESLICE / 2))
+	// The cache may hold the first tier version of a superblock
+	const bool cached = !superblock && blockcache::restore(this);
+	if (!cached)
+	{
+		try {
+			if (!dec_DecodeBlock(this, SH4_TIMESLICE / 2, false, superblock))
+				return false;
+		}
+		catch (const SH4ThrownException& ex) {
+			Do_Exception(rpc, ex.expEvn);
 			return false;
-	}
-	catch (const SH4ThrownException& ex) {
-		Do_Exception(rpc, ex.expEvn);
-		return false;
+		}
 	}
 	SetProtectedFlags();
 
-	AnalyseBlock(this);
+	if (!cached)
+	{
+		AnalyseBlock(this);
+		// Superblocks are recompiled from their first tier version
+		if (!superblock)
+			blockcache::add(this);
+	}
 
 	return true;
 }
@@ -176,7 +203,7 @@ DynarecCodeEntryPtr rdv_CompilePC(u32 blockcheck_failures)
 
 	RuntimeBlockInfo* rbi = sh4Dynarec->allocateBlock();
 
-	if (!rbi->Setup(pc, Sh4cntx.fpscr))
+	if (!rbi->Setup(pc, Sh4cntx.fpscr, superblocks.count(pc) != 0))
 	{
 		delete rbi;
 		return nullptr;
@@ -200,9 +227,46 @@ DynarecCodeEntryPtr rdv_CompilePC(u32 blockcheck_failures)
 
 	codeBuffer.useTempBuffer(false);
 
+	if (!rbi->temp_block)
+	{
+		// Get the most likely next blocks ready
+		if (rbi->BranchBlock != NullAddress && bm_GetCodeByVAddr(rbi->BranchBlock) == ngen_FailedToFindBlock)
+			blockcache::decodeAhead(rbi->BranchBlock, Sh4cntx.fpscr);
+		if (rbi->NextBlock != NullAddress && bm_GetCodeByVAddr(rbi->NextBlock) == ngen_FailedToFindBlock)
+			blockcache::decodeAhead(rbi->NextBlock, Sh4cntx.fpscr);
+	}
+
 	return rbi->code;
 }
 
+static void sampleHotBlock(u32 pc)
+{
+	if (!config::DynarecSuperblocks || mmu_enabled() || superblocks.size() >= MAX_SUPERBLOCKS)
+		return;
+	if (hot_samples.size() >= MAX_SAMPLED_BLOCKS && hot_samples.count(pc) == 0)
+		hot_samples.clear();
+	auto it = hot_samples.emplace(pc, 0).first;
+	if (++it->second < SUPERBLOCK_HOT_SAMPLES)
+		return;
+	hot_samples.erase(it);
+	RuntimeBlockInfoPtr block = bm_GetBlock(pc);
+	// Only blocks ending with an unconditional static branch can be extended.
+	// Unprotected blocks are likely to be modified.
+	if (block == nullptr || block->superblock || block->temp_block || !block->read_only
+			|| (block->BlockType != BET_StaticJump && block->BlockType != BET_StaticCall))
+		return;
+	DEBUG_LOG(DYNAREC, "Hot block %08x recompiled as superblock", pc);
+	superblocks.insert(pc);
+	// The block may be running. Its code stays valid until the cache is reset.
+	bm_DiscardBlock(block);
+}
+
+int rdv_UpdateSystem()
+{
+	sampleHotBlock(Sh4cntx.pc);
+	return UpdateSystem_INTC();
+}
+
 DynarecCodeEntryPtr DYNACALL rdv_FailedToFindBlock_pc()
 {
 	return rdv_FailedToFindBlock(Sh4cntx.pc);
@@ -243,7 +307,7 @@ DynarecCodeEntryPtr DYNACALL rdv_BlockCheckFail(u32 addr)
 				if (inserted)
 					DEBUG_LOG(DYNAREC, "rdv_BlockCheckFail SMC hotspot @ %08x fails %d", addr, blockcheck_failures);
 			}
-			bm_DiscardBlock(block.get());
+			bm_DiscardBlock(block);
 		}
 	}
 	else
@@ -314,13 +378,13 @@ void* DYNACALL rdv_LinkBlock(u8* code,u32 dpc)
 			}
 			else if (rbi->relink_data == 0)
 			{
-				rbi->pBranchBlock = bm_GetBlock(Sh4cntx.pc).get();
+				rbi->pBranchBlock = bm_GetBlock(Sh4cntx.pc);
 				rbi->pBranchBlock->AddRef(rbi);
 			}
 		}
 		else
 		{
-			RuntimeBlockInfo* nxt = bm_GetBlock(Sh4cntx.pc).get();
+			RuntimeBlockInfo* nxt = bm_GetBlock(Sh4cntx.pc);
 
 			if (rbi->BranchBlock == Sh4cntx.pc)
 				rbi->pBranchBlock = nxt;
@@ -349,11 +413,22 @@ void Sh4Recompiler::Reset(bool hard)
 		bm_Reset();
 }
 
+// The block cache is saved when the game is terminated, not each time it's paused
+static void emuEventCallback(Event event, void *)
+{
+	if (event == Event::Start)
+		blockcache::load();
+	else
+		blockcache::save();
+}
+
 void Sh4Recompiler::Init()
 {
 	INFO_LOG(DYNAREC, "Sh4Recompiler::Init");
 	super::Init();
 	bm_Init();
+	EventManager::listen(Event::Start, emuEventCallback);
+	EventManager::listen(Event::Terminate, emuEventCallback);
 	
 	if (addrspace::virtmemEnabled())
 		verify(&mem_b[0] == ((u8*)getContext()->sq_buffer + sizeof(Sh4Context) + 0x0C000000));
@@ -386,6 +461,9 @@ void Sh4Recompiler::Term()
 #endif
 	CodeCache = nullptr;
 	TempCodeCache = nullptr;
+	EventManager::unlisten(Event::Start, emuEventCallback);
+	EventManager::unlisten(Event::Terminate, emuEventCallback);
+	blockcache::term();
 	bm_Term();
 	super::Term();
 }
@@ -28,6 +28,8 @@ DynarecCodeEntryPtr DYNACALL rdv_BlockCheckFail(u32 addr);
 DynarecCodeEntryPtr rdv_CompilePC(u32 blockcheck_failures);
 //Finds or compiles code @pc
 DynarecCodeEntryPtr rdv_FindOrCompile();
+// Called by the main loop at the end of each time slice instead of UpdateSystem_INTC
+int rdv_UpdateSystem();
 // Registers a custom FailedToFindBlock handler function
 void rdv_SetFailedToFindBlockHandler(void (*handler)());
 
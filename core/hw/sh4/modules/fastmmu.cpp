@@ -21,6 +21,9 @@
 #include "hw/sh4/sh4_core.h"
 #include "types.h"
 #include "stdclass.h"
+#include <algorithm>
+#include <bitset>
+#include <vector>
 
 #ifdef FAST_MMU
 
@@ -67,10 +70,147 @@ static void cache_entry(const TLB_Entry &entry)
 	full_table_size++;
 }
 
+// ASID-tagged set-associative cache of 4K page translations, looked up before walking the entry buckets.
+// Entries of other address spaces are kept when the ASID changes.
+#define TC_SETS 1024
+#define TC_WAYS 4
+#define TC_VALID 0x200
+#define TC_SHARED 0x100
+
+struct TranslationCacheEntry {
+	u32 tag;	// 4K page number << 10 | TC_VALID | TC_SHARED | ASID
+	const TLB_Entry *entry;
+};
+static TranslationCacheEntry translation_cache[TC_SETS][TC_WAYS];
+static u8 translation_cache_next[TC_SETS];
+static MmuCacheStats cache_stats;
+
+static u32 tc_set(u32 vpn)
+{
+	return (vpn ^ (vpn >> 10)) & (TC_SETS - 1);
+}
+
+static const TLB_Entry *tc_lookup(u32 address)
+{
+	const u32 vpn = address >> 12;
+	const u32 tag = (vpn << 10) | TC_VALID;
+	const TranslationCacheEntry *set = translation_cache[tc_set(vpn)];
+	for (int i = 0; i < TC_WAYS; i++)
+		if ((set[i].tag & ~0x1ff) == tag
+				&& ((set[i].tag & TC_SHARED) != 0 || (set[i].tag & 0xff) == CCN_PTEH.ASID))
+			return set[i].entry;
+
+	return nullptr;
+}
+
+static void tc_add(u32 address, const TLB_Entry *entry)
+{
+	const u32 vpn = address >> 12;
+	const u32 setIdx = tc_set(vpn);
+	u32 way = translation_cache_next[setIdx];
+	translation_cache_next[setIdx] = (way + 1) % TC_WAYS;
+	translation_cache[setIdx][way].tag = (vpn << 10) | TC_VALID
+			| (entry->Data.SH == 1 ? TC_SHARED : entry->Address.ASID);
+	translation_cache[setIdx][way].entry = entry;
+}
+
+// Remove the pages covered by a new TLB entry, whatever their ASID
+static void tc_invalidate(const TLB_Entry &entry)
+{
+	const u32 sz = entry.Data.SZ1 * 2 + entry.Data.SZ0;
+	const u32 start = (entry.Address.VPN << 10) & mmu_mask[sz];
+	const u32 pages = std::max(1u, (~mmu_mask[sz] + 1) >> 12);
+	for (u32 vpn = start >> 12; vpn < (start >> 12) + pages; vpn++)
+	{
+		TranslationCacheEntry *set = translation_cache[tc_set(vpn)];
+		for (int i = 0; i < TC_WAYS; i++)
+			if ((set[i].tag >> 10) == vpn)
+				set[i].tag = 0;
+	}
+}
+
+// Slot 0 (0-1FFFFFF) is mapped to the current process by WinCE. Its translations in the dynarec LUT
+// are only valid for the current ASID, so they are saved when the ASID changes and restored
+// when switching back.
+constexpr u32 SLOT0_PAGES = (32 * 1024 * 1024) >> 12;
+constexpr size_t MAX_SAVED_PAGES = 1024;
+static std::vector<u32> lut_slot0_pages;	// slot 0 pages set in the LUT for the current ASID
+static std::bitset<SLOT0_PAGES> lut_slot0_tracked;
+static std::vector<std::pair<u32, u32>> lut_saved_pages[256];	// page number, LUT value
+
+void mmuAddressLUTAdd(u32 vaddr, u32 paddr)
+{
+	if (vaddr >> 31 != 0)
+		return;
+	const u32 vpn = vaddr >> 12;
+	if (vpn < SLOT0_PAGES && !lut_slot0_tracked[vpn])
+	{
+		lut_slot0_tracked.set(vpn);
+		lut_slot0_pages.push_back(vpn);
+	}
+	mmuAddressLUT[vpn] = paddr & ~0xfff;
+}
+
+void mmuAddressLUTSwitchAsid(u32 asid)
+{
+	std::vector<std::pair<u32, u32>>& saved = lut_saved_pages[CCN_PTEH.ASID];
+	saved.clear();
+	for (u32 vpn : lut_slot0_pages)
+	{
+		// the page may have been invalidated since
+		if (mmuAddressLUT[vpn] != 0 && saved.size() < MAX_SAVED_PAGES)
+			saved.emplace_back(vpn, mmuAddressLUT[vpn]);
+		mmuAddressLUT[vpn] = 0;
+	}
+	lut_slot0_pages.clear();
+	lut_slot0_tracked.reset();
+	for (const auto& page : lut_saved_pages[asid & 0xff])
+	{
+		mmuAddressLUT[page.first] = page.second;
+		lut_slot0_tracked.set(page.first);
+		lut_slot0_pages.push_back(page.first);
+	}
+}
+
+void mmuAddressLUTFlush()
+{
+	memset(mmuAddressLUT, 0, sizeof(mmuAddressLUT) / 2);	// flush user memory
+	lut_slot0_pages.clear();
+	lut_slot0_tracked.reset();
+	for (auto& saved : lut_saved_pages)
+		saved.clear();
+}
+
+// Remove the user pages covered by a new TLB entry from the LUT and from the saved translations
+static void lut_invalidate(const TLB_Entry &entry)
+{
+	const u32 sz = entry.Data.SZ1 * 2 + entry.Data.SZ0;
+	const u32 start = (entry.Address.VPN << 10) & mmu_mask[sz];
+	if (start >> 31 != 0)
+		return;
+	const u32 firstPage = start >> 12;
+	const u32 endPage = firstPage + std::max(1u, (~mmu_mask[sz] + 1) >> 12);
+	for (u32 vpn = firstPage; vpn < endPage; vpn++)
+		mmuAddressLUT[vpn] = 0;
+	if (firstPage >= SLOT0_PAGES)
+		return;
+	const auto inRange = [firstPage, endPage](const std::pair<u32, u32>& page) {
+		return page.first >= firstPage && page.first < endPage;
+	};
+	for (u32 asid = 0; asid < std::size(lut_saved_pages); asid++)
+	{
+		if (entry.Data.SH == 0 && asid != entry.Address.ASID)
+			continue;
+		std::vector<std::pair<u32, u32>>& saved = lut_saved_pages[asid];
+		saved.erase(std::remove_if(saved.begin(), saved.end(), inRange), saved.end());
+	}
+}
+
 static void flush_cache()
 {
 	full_table_size = 0;
 	memset(entry_buckets, 0, sizeof(entry_buckets));
+	memset(translation_cache, 0, sizeof(translation_cache));
 }
 
 template<u32 size>
@@ -188,6 +328,8 @@ bool UTLB_Sync(u32 entry)
 	lru_mask = mmu_mask[sz];
 	lru_address = tlb_entry.Address.VPN << 10;
 
+	tc_invalidate(tlb_entry);
+	lut_invalidate(tlb_entry);
 	cache_entry(tlb_entry);
 
 	if (!mmu_enabled() && (tlb_entry.Address.VPN & (0xFC000000 >> 10)) == (0xE0000000 >> 10))
@@ -218,6 +360,7 @@ MmuError mmu_full_lookup(u32 va, const TLB_Entry** tlb_entry_ret, u32& rv)
 			rv = (lru_entry->Data.PPN << 10) | (va & ~lru_mask);
 			if (tlb_entry_ret != nullptr)
 				*tlb_entry_ret = lru_entry;
+			cache_stats.lastEntryHits++;
 
 			return MmuError::NONE;
 		}
@@ -226,7 +369,18 @@ MmuError mmu_full_lookup(u32 va, const TLB_Entry** tlb_entry_ret, u32& rv)
 	if (tlb_entry_ret == nullptr)
 		tlb_entry_ret = &localEntry;
 
-	if (find_entry(va, tlb_entry_ret))
+	*tlb_entry_ret = tc_lookup(va);
+	if (*tlb_entry_ret != nullptr)
+		cache_stats.hits++;
+	else
+	{
+		cache_stats.misses++;
+		if (find_entry(va, tlb_entry_ret))
+			tc_add(va, *tlb_entry_ret);
+		else
+			*tlb_entry_ret = nullptr;
+	}
+	if (*tlb_entry_ret != nullptr)
 	{
 		u32 mask = mmu_mask[(*tlb_entry_ret)->Data.SZ1 * 2 + (*tlb_entry_ret)->Data.SZ0];
 		rv = ((*tlb_entry_ret)->Data.PPN << 10) | (va & ~mask);
@@ -321,6 +475,16 @@ void mmu_flush_table()
 {
 	lru_entry = nullptr;
 	flush_cache();
-	mmuAddressLUTFlush(true);
+	mmuAddressLUTFlush();
+}
+
+MmuCacheStats mmu_getCacheStats()
+{
+	return cache_stats;
+}
+
+void mmu_resetCacheStats()
+{
+	cache_stats = {};
 }
 #endif 	// FAST_MMU
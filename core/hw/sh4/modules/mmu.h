@@ -120,16 +120,22 @@ void mmu_TranslateSQW(u32 adr, u32* out);
 // maps 4K virtual page number to physical address
 extern u32 mmuAddressLUT[0x100000];
 
-static inline void mmuAddressLUTFlush(bool full)
+struct MmuCacheStats
 {
-	if (full)
-		memset(mmuAddressLUT, 0, sizeof(mmuAddressLUT) / 2);	// flush user memory
-	else
-	{
-		constexpr u32 slotPages = (32 * 1024 * 1024) >> 12;
-		memset(mmuAddressLUT, 0, slotPages * sizeof(u32));		// flush slot 0
-	}
-}
+	u64 lastEntryHits;	// same entry as the previous lookup
+	u64 hits;			// translation cache hits
+	u64 misses;			// TLB entry table walks
+};
+MmuCacheStats mmu_getCacheStats();
+void mmu_resetCacheStats();
+
+// Flushes the user memory translations
+void mmuAddressLUTFlush();
+// Adds a translation to the LUT
+void mmuAddressLUTAdd(u32 vaddr, u32 paddr);
+// Called before the ASID changes. The slot 0 translations of the current address space are saved
+// and those of the new one are restored.
+void mmuAddressLUTSwitchAsid(u32 asid);
 #endif
 
 #if FEAT_SHREC == DYNAREC_JIT
@@ -153,8 +159,7 @@ static inline u32 DYNACALL mmuDynarecLookup(u32 vaddr, u32 write, u32 pc)
 		return 0;
 	}
 #ifdef FAST_MMU
-	if (vaddr >> 31 == 0)
-		mmuAddressLUT[vaddr >> 12] = paddr & ~0xfff;
+	mmuAddressLUTAdd(vaddr, paddr);
 #endif
 
 	return paddr;
@@ -2,6 +2,7 @@
 #include "sh4_if.h"
 #include "sh4_sched.h"
 #include "serialize.h"
+#include "profiler/benchmark.h"
 
 #include <algorithm>
 #include <vector>
@@ -20,6 +21,7 @@
 
 	sh4_sched_now()
 
+	Scheduled callbacks are kept in a binary min-heap ordered by end time.
 */
 struct sched_list
 {
@@ -28,14 +30,107 @@ struct sched_list
 	int tag;
 	int start;
 	int end;
+	int heapIndex;	// -1 if not in the heap
+	int heapKey;	// end time used to order the heap
+	u32 lastTick;	// tick during which the callback was last called
 };
 
 static u64 sh4_sched_ffb;
 static std::vector<sched_list> sch_list;
+static std::vector<int> sch_heap;
 static int sh4_sched_next_id = -1;
+static u32 sh4_sched_tick_count;
 
 static u32 sh4_sched_now();
 
+// All scheduled callbacks end less than 2^31 cycles from now so the difference is meaningful.
+// Ties are broken by id so that the order doesn't depend on the heap history.
+static bool heap_before(int id1, int id2)
+{
+	int diff = (int)((u32)sch_list[id1].heapKey - (u32)sch_list[id2].heapKey);
+	return diff < 0 || (diff == 0 && id1 < id2);
+}
+
+static void heap_set(size_t index, int id)
+{
+	sch_heap[index] = id;
+	sch_list[id].heapIndex = index;
+}
+
+static void heap_sift_up(size_t index)
+{
+	int id = sch_heap[index];
+	while (index > 0)
+	{
+		size_t parent = (index - 1) / 2;
+		if (!heap_before(id, sch_heap[parent]))
+			break;
+		heap_set(index, sch_heap[parent]);
+		index = parent;
+	}
+	heap_set(index, id);
+}
+
+static void heap_sift_down(size_t index)
+{
+	int id = sch_heap[index];
+	const size_t size = sch_heap.size();
+	while (true)
+	{
+		size_t child = index * 2 + 1;
+		if (child >= size)
+			break;
+		if (child + 1 < size && heap_before(sch_heap[child + 1], sch_heap[child]))
+			child++;
+		if (!heap_before(sch_heap[child], id))
+			break;
+		heap_set(index, sch_heap[child]);
+		index = child;
+	}
+	heap_set(index, id);
+}
+
+static void heap_remove(int id)
+{
+	int index = sch_list[id].heapIndex;
+	if (index == -1)
+		return;
+	sch_list[id].heapIndex = -1;
+	int last = sch_heap.back();
+	sch_heap.pop_back();
+	if (last != id)
+	{
+		heap_set(index, last);
+		heap_sift_down(index);
+		heap_sift_up(sch_list[last].heapIndex);
+	}
+}
+
+// Insert, move or remove the callback in the heap according to its end time
+static void heap_update(int id)
+{
+	sched_list& sched = sch_list[id];
+	if (sched.end == -1)
+	{
+		heap_remove(id);
+	}
+	else if (sched.heapIndex == -1)
+	{
+		sched.heapKey = sched.end;
+		sch_heap.push_back(id);
+		heap_sift_up(sch_heap.size() - 1);
+	}
+	else if (sched.heapKey != sched.end)
+	{
+		const bool later = (int)((u32)sched.end - (u32)sched.heapKey) > 0;
+		sched.heapKey = sched.end;
+		if (later)
+			heap_sift_down(sched.heapIndex);
+		else
+			heap_sift_up(sched.heapIndex);
+	}
+}
+
 static u32 sh4_sched_remaining(const sched_list& sched, u32 reference)
 {
 	if (sched.end != -1)
@@ -49,15 +144,10 @@ void sh4_sched_ffts()
 	u32 diff = -1;
 	int slot = -1;
 
-	u32 now = sh4_sched_now();
-	for (const sched_list& sched : sch_list)
+	if (!sch_heap.empty())
 	{
-		u32 remaining = sh4_sched_remaining(sched, now);
-		if (remaining < diff)
-		{
-			slot = &sched - &sch_list[0];
-			diff = remaining;
-		}
+		slot = sch_heap[0];
+		diff = sh4_sched_remaining(sch_list[slot], sh4_sched_now());
 	}
 
 	sh4_sched_ffb -= Sh4cntx.sh4_sched_next;
@@ -73,7 +163,7 @@ void sh4_sched_ffts()
 
 int sh4_sched_register(int tag, sh4_sched_callback* ssc, void *arg)
 {
-	sched_list t{ ssc, arg, tag, -1, -1};
+	sched_list t{ ssc, arg, tag, -1, -1, -1, -1, 0 };
 	for (sched_list& sched : sch_list)
 		if (sched.cb == nullptr)
 		{
@@ -91,6 +181,7 @@ void sh4_sched_unregister(int id)
 	if (id == -1)
 		return;
 	verify(id < (int)sch_list.size());
+	heap_remove(id);
 	if (id == (int)sch_list.size() - 1)
 		sch_list.resize(sch_list.size() - 1);
 	else
@@ -134,6 +225,7 @@ void sh4_sched_request(int id, int cycles)
 		if (sched.end == -1)
 			sched.end++;
 	}
+	heap_update(id);
 
 	sh4_sched_ffts();
 }
@@ -162,11 +254,20 @@ static void handle_cb(sched_list& sched)
 	int elapsd = sh4_sched_elapsed(sched);
 	int jitter = elapsd - remain;
 
+	// The callback stays in the heap with its previous end time until it's rescheduled or removed,
+	// which saves a removal and an insertion for periodic callbacks.
 	sched.end = -1;
-	int re_sch = sched.cb(sched.tag, remain, jitter, sched.arg);
+	const int id = &sched - &sch_list[0];
+	int re_sch;
+	{
+		benchmark::Scope _(benchmark::Section::Scheduler);
+		re_sch = sched.cb(sched.tag, remain, jitter, sched.arg);
+	}
 
 	if (re_sch > 0)
-		sh4_sched_request(&sched - &sch_list[0], std::max(0, re_sch - jitter));
+		sh4_sched_request(id, std::max(0, re_sch - jitter));
+	else if (sched.end == -1)
+		heap_remove(id);
 }
 
 void sh4_sched_tick(int cycles)
@@ -177,12 +278,32 @@ void sh4_sched_tick(int cycles)
 	u32 fztime = sh4_sched_now() - cycles;
 	if (sh4_sched_next_id != -1)
 	{
-		for (sched_list& sched : sch_list)
+		// Due callbacks are called in chronological order, and in id order if they end at the same time.
+		// Callbacks scheduled by a callback are called during this tick if they are due,
+		// but each callback is called at most once per tick.
+		static std::vector<int> deferred;
+		sh4_sched_tick_count++;
+		while (!sch_heap.empty())
 		{
+			const int id = sch_heap[0];
+			sched_list& sched = sch_list[id];
 			int remaining = sh4_sched_remaining(sched, fztime);
-			if (remaining >= 0 && remaining <= (int)cycles)
-				handle_cb(sched);
+			if (remaining > cycles)
+				break;
+			if (sched.lastTick == sh4_sched_tick_count)
+			{
+				heap_remove(id);
+				deferred.push_back(id);
+				continue;
+			}
+			sched.lastTick = sh4_sched_tick_count;
+			handle_cb(sched);
 		}
+		for (int id : deferred)
+			// the callback may have been unregistered
+			if (id < (int)sch_list.size() && sch_list[id].heapIndex == -1)
+				heap_update(id);
+		deferred.clear();
 	}
 	sh4_sched_ffts();
 }
@@ -194,7 +315,11 @@ void sh4_sched_reset(bool hard)
 		sh4_sched_ffb = 0;
 		sh4_sched_next_id = -1;
 		for (sched_list& sched : sch_list)
+		{
 			sched.start = sched.end = -1;
+			sched.heapIndex = -1;
+		}
+		sch_heap.clear();
 		Sh4cntx.sh4_sched_next = 0;
 	}
 }
@@ -211,6 +336,7 @@ void sh4_sched_deserialize(Deserializer& deser, int id)
 	deser >> sch_list[id].tag;
 	deser >> sch_list[id].start;
 	deser >> sch_list[id].end;
+	heap_update(id);
 }
 
 // FIXME modules should save their scheduling data so that it doesn't depend on their scheduler id
@@ -43,6 +43,7 @@ bool sh4_sched_is_scheduled(int id);
 
 /*
 	Tick for *cycles*
+	Due callbacks are called in chronological order, at most once per tick.
 */
 void sh4_sched_tick(int cycles);
 
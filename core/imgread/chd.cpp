@@ -1,8 +1,15 @@
 #include "common.h"
 #include "stdclass.h"
 #include "oslib/storage.h"
+#include "cfg/option.h"
+#include "util/worker_thread.h"
 
 #include <libchdr/chd.h>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <memory>
+#include <mutex>
 
 struct CHDDisc : Disc
 {
@@ -13,25 +20,169 @@ struct CHDDisc : Disc
 
 	chd_file *chd = nullptr;
 	FILE *fp = nullptr;
-	u8* hunk_mem = nullptr;
-	u32 old_hunk = 0;
 
 	u32 hunkbytes = 0;
 	u32 sph = 0;
+	u32 hunkCount = 0;
 
 	void tryOpen(const char* file);
+	bool readHunk(u32 hunk, u32 offset, u8 *dst, u32 size);
+
+	ReadStats getReadStats() const override
+	{
+		std::lock_guard<std::mutex> _(cacheMutex);
+		return stats;
+	}
 
 	~CHDDisc() override
 	{
-		delete[] hunk_mem;
+		prefetcher.stop();
+		if (stats.hits + stats.misses != 0)
+			INFO_LOG(GDROM, "chd: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64 " prefetched, decompression time %" PRIu64 " ms",
+					stats.hits, stats.misses, stats.prefetched, stats.decompressTime / 1000);
 
 		if (chd)
 			chd_close(chd);
 		if (fp)
 			std::fclose(fp);
 	}
+
+private:
+	// LRU cache of decompressed hunks
+	struct CachedHunk
+	{
+		u32 hunk = ~0u;
+		u32 lastUse = 0;
+		std::unique_ptr<u8[]> data;
+	};
+
+	int findHunk(u32 hunk);
+	bool decompress(u32 hunk, std::unique_ptr<u8[]>& buffer);
+	void insertHunk(u32 hunk, std::unique_ptr<u8[]>& buffer);
+	void prefetch();
+
+	std::vector<CachedHunk> cache;
+	u32 useCounter = 0;
+	int lastHit = -1;
+	ReadStats stats;
+	mutable std::mutex cacheMutex;	// protects the cache and stats
+	std::mutex chdMutex;			// serializes chd_read calls
+	std::unique_ptr<u8[]> readBuffer;
+
+	// The next hunks are decompressed ahead of time by a background thread
+	WorkerThread prefetcher { "CHDPrefetch" };
+	std::unique_ptr<u8[]> prefetchBuffer;
+	u32 readAhead = 0;
+	std::atomic<u32> prefetchFrom { ~0u };
+	std::atomic<bool> prefetchPending { false };
+	// The emulation thread is waiting for a hunk
+	std::atomic<bool> readWaiting { false };
 };
 
+int CHDDisc::findHunk(u32 hunk)
+{
+	if (lastHit != -1 && cache[lastHit].hunk == hunk)
+		return lastHit;
+	for (size_t i = 0; i < cache.size(); i++)
+		if (cache[i].hunk == hunk)
+			return lastHit = i;
+	return -1;
+}
+
+bool CHDDisc::decompress(u32 hunk, std::unique_ptr<u8[]>& buffer)
+{
+	auto start = std::chrono::steady_clock::now();
+	if (chd_read(chd, hunk, buffer.get()) != CHDERR_NONE)
+		return false;
+	u64 duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+	std::lock_guard<std::mutex> _(cacheMutex);
+	stats.decompressTime += duration;
+	return true;
+}
+
+// Swap the buffer with the least recently used cache entry. Must be called with cacheMutex held.
+void CHDDisc::insertHunk(u32 hunk, std::unique_ptr<u8[]>& buffer)
+{
+	size_t lru = 0;
+	for (size_t i = 1; i < cache.size(); i++)
+		if ((s32)(cache[i].lastUse - cache[lru].lastUse) < 0)
+			lru = i;
+	CachedHunk& entry = cache[lru];
+	entry.hunk = hunk;
+	entry.lastUse = ++useCounter;
+	std::swap(entry.data, buffer);
+	lastHit = lru;
+}
+
+bool CHDDisc::readHunk(u32 hunk, u32 offset, u8 *dst, u32 size)
+{
+	if (hunk >= hunkCount)
+		return false;
+	std::unique_lock<std::mutex> lock(cacheMutex);
+	int index = findHunk(hunk);
+	if (index != -1) {
+		stats.hits++;
+	}
+	else
+	{
+		stats.misses++;
+		lock.unlock();
+		{
+			readWaiting = true;
+			std::lock_guard<std::mutex> _(chdMutex);
+			readWaiting = false;
+			lock.lock();
+			// may have been prefetched in the meantime
+			index = findHunk(hunk);
+			if (index == -1)
+			{
+				lock.unlock();
+				if (!decompress(hunk, readBuffer))
+					return false;
+				lock.lock();
+				insertHunk(hunk, readBuffer);
+				index = lastHit;
+			}
+		}
+	}
+	CachedHunk& entry = cache[index];
+	entry.lastUse = ++useCounter;
+	memcpy(dst, entry.data.get() + offset, size);
+	lock.unlock();
+
+	if (readAhead != 0 && prefetchFrom.exchange(hunk + 1) != hunk + 1
+			&& !prefetchPending.exchange(true))
+		prefetcher.run([this]() { prefetch(); });
+
+	return true;
+}
+
+void CHDDisc::prefetch()
+{
+	prefetchPending = false;
+	const u32 from = prefetchFrom;
+	for (u32 hunk = from; hunk < from + readAhead && hunk < hunkCount; hunk++)
+	{
+		// give up if the emulation thread needs the chd file or has moved elsewhere
+		if (readWaiting || prefetchFrom != from)
+			break;
+		{
+			std::lock_guard<std::mutex> _(cacheMutex);
+			if (findHunk(hunk) != -1)
+				continue;
+		}
+		std::lock_guard<std::mutex> _(chdMutex);
+		if (!decompress(hunk, prefetchBuffer))
+			break;
+		std::lock_guard<std::mutex> __(cacheMutex);
+		if (findHunk(hunk) == -1)
+		{
+			insertHunk(hunk, prefetchBuffer);
+			stats.prefetched++;
+		}
+	}
+}
+
 struct CHDTrack : TrackFile
 {
 	CHDDisc* disc;
@@ -50,17 +201,11 @@ struct CHDTrack : TrackFile
 	bool Read(u32 FAD, u8* dst, SectorFormat* sector_type, u8* subcode, SubcodeFormat* subcode_type) override
 	{
 		u32 fad_offs = FAD + Offset;
-		u32 hunk=(fad_offs)/disc->sph;
-		if (disc->old_hunk!=hunk)
-		{
-			if (chd_read(disc->chd,hunk,disc->hunk_mem) != CHDERR_NONE)
-				return false;
-			disc->old_hunk = hunk;
-		}
+		u32 hunk = fad_offs / disc->sph;
+		u32 hunk_ofs = fad_offs % disc->sph;
 
-		u32 hunk_ofs = fad_offs%disc->sph;
-
-		memcpy(dst, disc->hunk_mem + hunk_ofs * (2352+96), fmt);
+		if (!disc->readHunk(hunk, hunk_ofs * (2352 + 96), dst, fmt))
+			return false;
 
 		if (swap_bytes)
 		{
@@ -128,14 +273,22 @@ void CHDDisc::tryOpen(const char* file)
 	const chd_header* head = chd_get_header(chd);
 
 	hunkbytes = head->hunkbytes;
-	hunk_mem = new u8[hunkbytes];
-	old_hunk=0xFFFFFFF;
+	hunkCount = head->totalhunks;
 
 	sph = hunkbytes/(2352+96);
 
 	if (hunkbytes % (2352 + 96) != 0)
 		throw FlycastException(std::string("Invalid hunkbytes for CHD file ") + file);
 
+	cache.resize(std::max(2, (int)config::ChdCacheSize));
+	for (CachedHunk& entry : cache)
+		entry.data = std::make_unique<u8[]>(hunkbytes);
+	readBuffer = std::make_unique<u8[]>(hunkbytes);
+	// Keep at least half of the cache for hunks already read
+	readAhead = std::clamp((int)config::ChdReadAhead, 0, (int)cache.size() / 2);
+	if (readAhead != 0)
+		prefetchBuffer = std::make_unique<u8[]>(hunkbytes);
+
 	u32 tag;
 	u8 flags;
 	char temp[512];
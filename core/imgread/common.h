@@ -120,6 +120,18 @@ struct Disc
 
 	u32 ReadSectors(u32 FAD, u32 count, u8 *dst, u32 fmt, bool stopOnMiss = false, LoadProgress *progress = nullptr);
 
+	// Statistics of compressed images
+	struct ReadStats
+	{
+		u64 hits = 0;			// reads served from the decompressed data cache
+		u64 misses = 0;			// reads that needed to decompress data
+		u64 prefetched = 0;		// blocks decompressed ahead of time
+		u64 decompressTime = 0;	// total decompression time in microseconds
+	};
+	virtual ReadStats getReadStats() const {
+		return {};
+	}
+
 	virtual ~Disc() 
 	{
 		for (auto& track : tracks)
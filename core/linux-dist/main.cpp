@@ -10,6 +10,7 @@
 #include "oslib/directory.h"
 #include "oslib/oslib.h"
 #include "stdclass.h"
+#include "profiler/benchmark.h"
 
 #include <csignal>
 #include <string>
@@ -266,6 +267,14 @@ int main(int argc, char* argv[])
 	auto async = std::async(std::launch::async, uploadCrashes, "/tmp");
 #endif
 
+	if (benchmark::enabled())
+	{
+		// headless: no window nor input devices have been created
+		int rc = benchmark::run();
+		emu.term();
+		os_UninstallFaultHandler();
+		return rc;
+	}
 	mainui_loop();
 
 	flycast_term();
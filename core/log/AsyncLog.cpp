@@ -0,0 +1,620 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "AsyncLog.h"
+#include "LogManager.h"
+#include "oslib/oslib.h"
+#include "stdclass.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+namespace
+{
+
+enum class ArgType
+{
+	None,	// %%
+	Int,
+	UInt,
+	Char,
+	Double,
+	String,
+	Pointer,
+	Unsupported
+};
+
+// A printf conversion specification
+struct ConvSpec
+{
+	ArgType type = ArgType::None;
+	char conv = 0;
+	char length = 0;	// 0, 'H' (hh), 'h', 'l', 'L' (ll), 'j', 'z' or 't'
+	char flags[6] {};
+	int width = -1;
+	int precision = -1;
+	bool starWidth = false;
+	bool starPrecision = false;
+};
+
+// Parse the conversion specification starting after the '%'. Returns a pointer to the following character.
+const char *parseSpec(const char *p, ConvSpec& spec)
+{
+	int nflags = 0;
+	while (*p != '\0' && strchr("-+ #0", *p) != nullptr)
+	{
+		if (nflags < (int)sizeof(spec.flags) - 1)
+			spec.flags[nflags++] = *p;
+		p++;
+	}
+	if (*p == '*') {
+		spec.starWidth = true;
+		p++;
+	}
+	else if (*p >= '0' && *p <= '9')
+	{
+		spec.width = 0;
+		for (; *p >= '0' && *p <= '9'; p++)
+			spec.width = spec.width * 10 + *p - '0';
+	}
+	if (*p == '.')
+	{
+		p++;
+		if (*p == '*') {
+			spec.starPrecision = true;
+			p++;
+		}
+		else
+		{
+			spec.precision = 0;
+			for (; *p >= '0' && *p <= '9'; p++)
+				spec.precision = spec.precision * 10 + *p - '0';
+		}
+	}
+	switch (*p)
+	{
+	case 'h':
+		p++;
+		spec.length = 'h';
+		if (*p == 'h') {
+			spec.length = 'H';
+			p++;
+		}
+		break;
+	case 'l':
+		p++;
+		spec.length = 'l';
+		if (*p == 'l') {
+			spec.length = 'L';
+			p++;
+		}
+		break;
+	case 'j':
+	case 'z':
+	case 't':
+		spec.length = *p++;
+		break;
+	case 'L':
+	case 'q':
+	case 'I':
+		// long double and non-standard sizes
+		spec.type = ArgType::Unsupported;
+		return p;
+	default:
+		break;
+	}
+	spec.conv = *p;
+	switch (*p)
+	{
+	case '%':
+		spec.type = ArgType::None;
+		break;
+	case 'd':
+	case 'i':
+		spec.type = ArgType::Int;
+		break;
+	case 'u':
+	case 'o':
+	case 'x':
+	case 'X':
+		spec.type = ArgType::UInt;
+		break;
+	case 'c':
+		spec.type = spec.length == 0 ? ArgType::Char : ArgType::Unsupported;
+		break;
+	case 'f':
+	case 'F':
+	case 'e':
+	case 'E':
+	case 'g':
+	case 'G':
+	case 'a':
+	case 'A':
+		spec.type = ArgType::Double;
+		break;
+	case 's':
+		spec.type = spec.length == 0 ? ArgType::String : ArgType::Unsupported;
+		break;
+	case 'p':
+		spec.type = ArgType::Pointer;
+		break;
+	default:
+		// %n, wide chars, end of string...
+		spec.type = ArgType::Unsupported;
+		return p;
+	}
+	return p + 1;
+}
+
+// Rebuild a conversion specification with explicit width and precision
+void buildSpec(char *fmt, size_t size, const ConvSpec& spec, const char *length)
+{
+	int n = snprintf(fmt, size, "%%%s", spec.flags);
+	if (spec.starWidth || spec.width >= 0)
+		n += snprintf(fmt + n, size - n, "%d", spec.width);
+	if (spec.precision >= 0)
+		n += snprintf(fmt + n, size - n, ".%d", spec.precision);
+	snprintf(fmt + n, size - n, "%s%c", length, spec.conv);
+}
+
+class Writer
+{
+public:
+	Writer(uint8_t *data, size_t size) : data(data), size(size) {}
+
+	template<typename T>
+	bool put(const T& v)
+	{
+		if (pos + sizeof(T) > size)
+			return false;
+		memcpy(data + pos, &v, sizeof(T));
+		pos += sizeof(T);
+		return true;
+	}
+	bool putString(const char *s, int maxLen)
+	{
+		if (s == nullptr)
+			s = "(null)";
+		size_t len = maxLen >= 0 ? strnlen(s, maxLen) : strlen(s);
+		if (pos + sizeof(uint16_t) > size)
+			return false;
+		len = std::min(len, size - pos - sizeof(uint16_t));
+		put((uint16_t)len);
+		memcpy(data + pos, s, len);
+		pos += len;
+		return true;
+	}
+	size_t position() const {
+		return pos;
+	}
+
+private:
+	uint8_t *data;
+	size_t size;
+	size_t pos = 0;
+};
+
+class Reader
+{
+public:
+	Reader(const uint8_t *data, size_t size) : data(data), size(size) {}
+
+	template<typename T>
+	T get()
+	{
+		T v {};
+		if (pos + sizeof(T) <= size)
+		{
+			memcpy(&v, data + pos, sizeof(T));
+			pos += sizeof(T);
+		}
+		return v;
+	}
+	const char *getString(int& len)
+	{
+		len = get<uint16_t>();
+		len = std::min<int>(len, size - pos);
+		const char *s = (const char *)data + pos;
+		pos += len;
+		return s;
+	}
+
+private:
+	const uint8_t *data;
+	size_t size;
+	size_t pos = 0;
+};
+
+}
+
+thread_local AsyncLogger::ThreadRing AsyncLogger::localRing;
+thread_local bool AsyncLogger::workerThread;
+std::atomic<uint32_t> AsyncLogger::lastId;
+
+AsyncLogger::AsyncLogger(LogManager *logManager)
+	: logManager(logManager), id(++lastId)
+{
+}
+
+void AsyncLogger::Start()
+{
+	if (running)
+		return;
+	running = true;
+	worker = std::thread(&AsyncLogger::run, this);
+}
+
+void AsyncLogger::Stop()
+{
+	if (!running)
+		return;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		running = false;
+	}
+	workerCond.notify_one();
+	worker.join();
+	// Write the messages queued in the meantime
+	std::unique_lock<std::mutex> lock(mutex);
+	drain(lock);
+}
+
+AsyncLogger::Ring *AsyncLogger::threadRing()
+{
+	if (localRing.ownerId != id)
+	{
+		if (localRing.ring)
+			localRing.ring->orphaned = true;
+		std::shared_ptr<Ring> ring = std::make_shared<Ring>();
+		std::lock_guard<std::mutex> lock(mutex);
+		rings.push_back(ring);
+		localRing.ring = ring;
+		localRing.ownerId = id;
+	}
+	return localRing.ring.get();
+}
+
+bool AsyncLogger::Push(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char *file, int line,
+		const char *format, va_list args)
+{
+	if (!IsRunning() || workerThread)
+		return false;
+	Ring *ring = threadRing();
+	const uint32_t head = ring->head.load(std::memory_order_relaxed);
+	const uint32_t used = head - ring->tail.load(std::memory_order_acquire);
+	if (used >= Ring::Size)
+	{
+		ring->dropped.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+	Record& record = ring->records[head % Ring::Size];
+	record.seq = nextSeq.fetch_add(1, std::memory_order_relaxed);
+	record.timeMs = getTimeMs();
+	record.file = file;
+	record.line = line;
+	record.level = (uint8_t)level;
+	record.type = (uint8_t)type;
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+	bool encoded = encode(record, format, argsCopy);
+	va_end(argsCopy);
+	if (encoded)
+	{
+		record.format = format;
+	}
+	else
+	{
+		// Unsupported conversion or arguments too large
+		char text[MAX_MSGLEN];
+		va_copy(argsCopy, args);
+		int len = vsnprintf(text, sizeof(text), format, argsCopy);
+		va_end(argsCopy);
+		if (len < 0 || (size_t)len >= Record::DataSize)
+		{
+			// Too long for a record: write the queued messages first so that the caller can write this one
+			Flush();
+			return false;
+		}
+		memcpy(record.data, text, len + 1);
+		record.format = nullptr;
+	}
+	ring->head.store(head + 1, std::memory_order_release);
+
+	// Only the first message of a batch needs to wake up the worker.
+	// The mutex must be held to notify so that the wake-up isn't lost.
+	if (!wakeUp.exchange(true))
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		workerCond.notify_one();
+	}
+	return true;
+}
+
+void AsyncLogger::Flush()
+{
+	if (!IsRunning() || workerThread)
+		return;
+	std::unique_lock<std::mutex> lock(mutex);
+	wakeUp = true;
+	workerCond.notify_one();
+	flushedCond.wait_for(lock, std::chrono::milliseconds(FlushTimeoutMs), [this]() {
+		return (empty() && !writing) || !IsRunning();
+	});
+}
+
+bool AsyncLogger::FormatDeferred(char *out, size_t outSize, const char *format, ...)
+{
+	Record record;
+	va_list args;
+	va_start(args, format);
+	bool encoded = encode(record, format, args);
+	va_end(args);
+	if (!encoded)
+		return false;
+	record.format = format;
+	decode(record, out, outSize);
+	return true;
+}
+
+bool AsyncLogger::encode(Record& record, const char *format, va_list args)
+{
+	Writer writer(record.data, Record::DataSize);
+	for (const char *p = format; *p != '\0'; )
+	{
+		if (*p++ != '%')
+			continue;
+		ConvSpec spec;
+		p = parseSpec(p, spec);
+		int precision = spec.precision;
+		if (spec.starWidth && !writer.put(va_arg(args, int)))
+			return false;
+		if (spec.starPrecision)
+		{
+			precision = va_arg(args, int);
+			if (!writer.put(precision))
+				return false;
+		}
+		bool ok = true;
+		switch (spec.type)
+		{
+		case ArgType::None:
+			break;
+		case ArgType::Int:
+			{
+				int64_t v;
+				switch (spec.length)
+				{
+				case 'H': v = (signed char)va_arg(args, int); break;
+				case 'h': v = (short)va_arg(args, int); break;
+				case 'l': v = va_arg(args, long); break;
+				case 'L': v = va_arg(args, long long); break;
+				case 'j': v = va_arg(args, intmax_t); break;
+				case 'z': v = va_arg(args, std::make_signed_t<size_t>); break;
+				case 't': v = va_arg(args, ptrdiff_t); break;
+				default: v = va_arg(args, int); break;
+				}
+				ok = writer.put(v);
+			}
+			break;
+		case ArgType::UInt:
+			{
+				uint64_t v;
+				switch (spec.length)
+				{
+				case 'H': v = (unsigned char)va_arg(args, unsigned); break;
+				case 'h': v = (unsigned short)va_arg(args, unsigned); break;
+				case 'l': v = va_arg(args, unsigned long); break;
+				case 'L': v = va_arg(args, unsigned long long); break;
+				case 'j': v = va_arg(args, uintmax_t); break;
+				case 'z': v = va_arg(args, size_t); break;
+				case 't': v = (std::make_unsigned_t<ptrdiff_t>)va_arg(args, ptrdiff_t); break;
+				default: v = va_arg(args, unsigned); break;
+				}
+				ok = writer.put(v);
+			}
+			break;
+		case ArgType::Char:
+			ok = writer.put(va_arg(args, int));
+			break;
+		case ArgType::Double:
+			ok = writer.put(va_arg(args, double));
+			break;
+		case ArgType::String:
+			ok = writer.putString(va_arg(args, const char *), precision);
+			break;
+		case ArgType::Pointer:
+			ok = writer.put((uint64_t)(uintptr_t)va_arg(args, void *));
+			break;
+		case ArgType::Unsupported:
+			return false;
+		}
+		if (!ok)
+			return false;
+	}
+	record.size = (uint16_t)writer.position();
+	return true;
+}
+
+void AsyncLogger::decode(const Record& record, char *out, size_t outSize)
+{
+	Reader reader(record.data, record.size);
+	size_t pos = 0;
+	for (const char *p = record.format; *p != '\0' && pos < outSize - 1; )
+	{
+		if (*p != '%')
+		{
+			out[pos++] = *p++;
+			continue;
+		}
+		ConvSpec spec;
+		p = parseSpec(p + 1, spec);
+		if (spec.starWidth)
+			spec.width = reader.get<int>();
+		if (spec.starPrecision)
+			spec.precision = std::max(reader.get<int>(), -1);
+		char fmt[32];
+		int written = 0;
+		switch (spec.type)
+		{
+		case ArgType::None:
+			out[pos++] = '%';
+			break;
+		case ArgType::Int:
+			buildSpec(fmt, sizeof(fmt), spec, "ll");
+			written = snprintf(out + pos, outSize - pos, fmt, (long long)reader.get<int64_t>());
+			break;
+		case ArgType::UInt:
+			buildSpec(fmt, sizeof(fmt), spec, "ll");
+			written = snprintf(out + pos, outSize - pos, fmt, (unsigned long long)reader.get<uint64_t>());
+			break;
+		case ArgType::Char:
+			buildSpec(fmt, sizeof(fmt), spec, "");
+			written = snprintf(out + pos, outSize - pos, fmt, reader.get<int>());
+			break;
+		case ArgType::Double:
+			buildSpec(fmt, sizeof(fmt), spec, "");
+			written = snprintf(out + pos, outSize - pos, fmt, reader.get<double>());
+			break;
+		case ArgType::String:
+			{
+				int len;
+				const char *s = reader.getString(len);
+				spec.precision = len;
+				buildSpec(fmt, sizeof(fmt), spec, "");
+				written = snprintf(out + pos, outSize - pos, fmt, s);
+			}
+			break;
+		case ArgType::Pointer:
+			buildSpec(fmt, sizeof(fmt), spec, "");
+			written = snprintf(out + pos, outSize - pos, fmt, (void *)(uintptr_t)reader.get<uint64_t>());
+			break;
+		case ArgType::Unsupported:
+			// not encoded
+			p = "";
+			break;
+		}
+		if (written > 0)
+			pos = std::min(pos + written, outSize - 1);
+	}
+	out[pos] = '\0';
+}
+
+void AsyncLogger::run()
+{
+	ThreadName _("Flycast-log");
+	workerThread = true;
+	std::unique_lock<std::mutex> lock(mutex);
+	while (running)
+	{
+		workerCond.wait(lock, [this]() {
+			return !running || wakeUp;
+		});
+		// Cleared before draining so that messages pushed from now on wake up the worker again
+		wakeUp.exchange(false);
+		drain(lock);
+		flushedCond.notify_all();
+	}
+}
+
+// Write the queued messages in order. Called with the mutex held.
+// The records are dequeued with the mutex held, which is released while they're written to the listeners.
+void AsyncLogger::drain(std::unique_lock<std::mutex>& lock)
+{
+	for (;;)
+	{
+		pending.clear();
+		for (;;)
+		{
+			Ring *next = nullptr;
+			uint64_t minSeq = 0;
+			for (const auto& ring : rings)
+			{
+				const uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+				if (tail == ring->head.load(std::memory_order_acquire))
+					continue;
+				const uint64_t seq = ring->records[tail % Ring::Size].seq;
+				if (next == nullptr || seq < minSeq)
+				{
+					next = ring.get();
+					minSeq = seq;
+				}
+			}
+			if (next == nullptr)
+				break;
+			const uint32_t tail = next->tail.load(std::memory_order_relaxed);
+			pending.push_back(next->records[tail % Ring::Size]);
+			next->tail.store(tail + 1, std::memory_order_release);
+		}
+		uint32_t dropped = 0;
+		for (auto it = rings.begin(); it != rings.end(); )
+		{
+			Ring& ring = **it;
+			const uint32_t ringDropped = ring.dropped.load(std::memory_order_relaxed);
+			dropped += ringDropped - ring.reportedDrops;
+			ring.reportedDrops = ringDropped;
+			// the orphaned flag is set after the last push
+			if (ring.orphaned && ring.tail.load() == ring.head.load())
+				it = rings.erase(it);
+			else
+				++it;
+		}
+		if (pending.empty() && dropped == 0)
+			break;
+		droppedCount += dropped;
+
+		writing = true;
+		lock.unlock();
+		for (const Record& record : pending)
+			write(record);
+		if (dropped != 0)
+		{
+			char msg[64];
+			snprintf(msg, sizeof(msg), "%u log messages dropped", dropped);
+			logManager->WriteToListeners(LogTypes::LWARNING, LogTypes::COMMON, "log/AsyncLog.cpp", __LINE__, getTimeMs(), msg);
+		}
+		lock.lock();
+		writing = false;
+	}
+}
+
+bool AsyncLogger::empty() const
+{
+	for (const auto& ring : rings)
+		if (ring->tail.load(std::memory_order_relaxed) != ring->head.load(std::memory_order_acquire))
+			return false;
+	return true;
+}
+
+void AsyncLogger::write(const Record& record)
+{
+	if (record.format == nullptr)
+	{
+		logManager->WriteToListeners((LogTypes::LOG_LEVELS)record.level, (LogTypes::LOG_TYPE)record.type,
+				record.file, record.line, record.timeMs, (const char *)record.data);
+	}
+	else
+	{
+		char text[MAX_MSGLEN];
+		decode(record, text, sizeof(text));
+		logManager->WriteToListeners((LogTypes::LOG_LEVELS)record.level, (LogTypes::LOG_TYPE)record.type,
+				record.file, record.line, record.timeMs, text);
+	}
+}
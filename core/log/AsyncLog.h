@@ -0,0 +1,127 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "Log.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class LogManager;
+
+// Deferred logging: the calling thread only copies the format string pointer and the arguments
+// into a lock-free per-thread ring. Formatting and writing to the listeners is done by a background thread.
+// Messages are dropped when a ring is full.
+class AsyncLogger
+{
+public:
+	AsyncLogger(LogManager *logManager);
+	~AsyncLogger() {
+		Stop();
+	}
+
+	void Start();
+	void Stop();
+	bool IsRunning() const {
+		return running.load(std::memory_order_relaxed);
+	}
+	// Returns false if the message hasn't been handled and must be logged synchronously.
+	// The format string must be a literal since it's only used once the message is dequeued.
+	bool Push(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char *file, int line,
+			const char *format, va_list args);
+	// Wait until all the queued messages have been written
+	void Flush();
+	uint64_t GetDroppedCount() const {
+		return droppedCount.load(std::memory_order_relaxed);
+	}
+	// Encodes the arguments and formats the message as done for queued messages.
+	// Returns false if the message can't be encoded.
+	static bool FormatDeferred(char *out, size_t outSize, const char *format, ...);
+
+private:
+	struct Record
+	{
+		static constexpr size_t DataSize = 464;
+
+		uint64_t seq;
+		uint64_t timeMs;
+		const char *file;
+		const char *format;		// nullptr if data contains the formatted message
+		uint32_t line;
+		uint8_t level;
+		uint8_t type;
+		uint16_t size;
+		uint8_t data[DataSize];	// encoded arguments
+	};
+
+	// Single producer (the owning thread), single consumer (the worker thread)
+	struct Ring
+	{
+		static constexpr uint32_t Size = 256;
+
+		Record records[Size];
+		std::atomic<uint32_t> head { 0 };
+		std::atomic<uint32_t> tail { 0 };
+		std::atomic<uint32_t> dropped { 0 };
+		std::atomic<bool> orphaned { false };	// the owning thread has exited
+		uint32_t reportedDrops = 0;
+	};
+
+	struct ThreadRing
+	{
+		~ThreadRing() {
+			if (ring)
+				ring->orphaned = true;
+		}
+		std::shared_ptr<Ring> ring;
+		uint32_t ownerId = 0;
+	};
+
+	Ring *threadRing();
+	static bool encode(Record& record, const char *format, va_list args);
+	static void decode(const Record& record, char *out, size_t outSize);
+	void run();
+	void drain(std::unique_lock<std::mutex>& lock);
+	bool empty() const;
+	void write(const Record& record);
+
+	LogManager *logManager;
+	const uint32_t id;
+	std::atomic<bool> running { false };
+	std::atomic<bool> wakeUp { false };
+	std::atomic<uint64_t> nextSeq { 0 };
+	std::atomic<uint64_t> droppedCount { 0 };
+	std::thread worker;
+	std::mutex mutex;
+	std::condition_variable workerCond;
+	std::condition_variable flushedCond;
+	std::vector<std::shared_ptr<Ring>> rings;	// protected by mutex
+	std::vector<Record> pending;	// dequeued records, only used by drain()
+	bool writing = false;			// pending records are being written, protected by mutex
+
+	static thread_local ThreadRing localRing;
+	static thread_local bool workerThread;
+	static std::atomic<uint32_t> lastId;
+	static constexpr int FlushTimeoutMs = 100;
+};
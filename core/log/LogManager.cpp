@@ -13,6 +13,7 @@
 #include <string>
 #include <fstream>
 
+#include "AsyncLog.h"
 #include "ConsoleListener.h"
 #include "InMemoryListener.h"
 #include "NetworkListener.h"
@@ -22,8 +23,6 @@
 #include "oslib/oslib.h"
 #include "stdclass.h"
 
-constexpr size_t MAX_MSGLEN = 1024;
-
 template <typename T>
 void OpenFStream(T& fstream, const std::string& filename, std::ios_base::openmode openmode)
 {
@@ -138,10 +137,17 @@ LogManager::LogManager()
 		container.m_enable = cfgLoadBool("log", container.m_short_name, true);
 
 	m_path_cutoff_point = DeterminePathCutOffPoint();
+	m_async = std::make_unique<AsyncLogger>(this);
 
 	UpdateConfig();
 }
 
+LogManager::~LogManager()
+{
+	// Write the pending messages before the listeners are deleted
+	m_async.reset();
+}
+
 void LogManager::UpdateConfig()
 {
 	bool logToFile = cfgLoadBool("log", "LogToFile", false);
@@ -177,13 +183,16 @@ void LogManager::UpdateConfig()
 		RegisterListener(LogListener::NETWORK_LISTENER, new NetworkListener(logServer));
 		EnableListener(LogListener::NETWORK_LISTENER, !logServer.empty());
 	}
+	if (cfgLoadBool("log", "Async", false))
+		m_async->Start();
+	else
+		m_async->Stop();
 }
 
 // Return the current time formatted as Minutes:Seconds:Milliseconds
 // in the form 00:00:000.
-static std::string GetTimeFormatted()
+static std::string GetTimeFormatted(u64 now)
 {
-	u64 now = getTimeMs();
 	u32 ms = (u32)(now % 1000);
 	now /= 1000;
 	u32 seconds = (u32)(now % 60);
@@ -204,12 +213,24 @@ void LogManager::LogWithFullPath(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE
 	if (!IsEnabled(type, level) || !static_cast<bool>(m_listener_ids))
 		return;
 
+	if (m_async->Push(level, type, file, line, format, args))
+	{
+		// Make sure errors are written before a possible crash
+		if (level == LogTypes::LERROR)
+			m_async->Flush();
+		return;
+	}
 	char temp[MAX_MSGLEN];
 	CharArrayFromFormatV(temp, MAX_MSGLEN, format, args);
+	WriteToListeners(level, type, file, line, getTimeMs(), temp);
+}
 
+void LogManager::WriteToListeners(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type,
+		const char* file, int line, u64 timeMs, const char* text)
+{
 	std::string msg =
-			StringFromFormat("%s %s:%u %c[%s]: %s\n", GetTimeFormatted().c_str(), file,
-					line, LogTypes::LOG_LEVEL_TO_CHAR[(int)level], GetShortName(type), temp);
+			StringFromFormat("%s %s:%u %c[%s]: %s\n", GetTimeFormatted(timeMs).c_str(), file,
+					line, LogTypes::LOG_LEVEL_TO_CHAR[(int)level], GetShortName(type), text);
 
 	for (auto listener_id : m_listener_ids)
 		if (m_listeners[listener_id])
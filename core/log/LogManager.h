@@ -11,6 +11,10 @@
 #include "BitSet.h"
 #include "Log.h"
 
+class AsyncLogger;
+
+constexpr size_t MAX_MSGLEN = 1024;
+
 // pure virtual interface
 class LogListener
 {
@@ -57,6 +61,7 @@ public:
   void UpdateConfig();
 
 private:
+  friend class AsyncLogger;
   struct LogContainer
   {
 	  LogContainer() : m_short_name(NULL), m_full_name(NULL) {}
@@ -69,6 +74,10 @@ private:
   };
 
   LogManager();
+  ~LogManager();
+
+  void WriteToListeners(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char* file,
+                        int line, u64 timeMs, const char* text);
 
   LogManager(const LogManager&) = delete;
   LogManager& operator=(const LogManager&) = delete;
@@ -81,4 +90,5 @@ private:
   BitSet32 m_listener_ids;
   size_t m_path_cutoff_point = 0;
   std::string logServer;
+  std::unique_ptr<AsyncLogger> m_async;
 };
@@ -19,7 +19,7 @@
 #include "types.h"
 #include <asio.hpp>
 #include "netservice.h"
-#include "util/tsqueue.h"
+#include "util/spsc_ring.h"
 #include "oslib/oslib.h"
 #include "emulator.h"
 #include "hw/bba/bba.h"
@@ -40,7 +40,14 @@
 namespace net::modbba
 {
 
-static TsQueue<u8> toModem;
+static SpscRing toModem(64_KB);
+
+static void pushToModem(const u8 *data, size_t len)
+{
+	size_t pushed = toModem.tryPush(data, len);
+	if (pushed != len)
+		WARN_LOG(NETWORK, "Modem receive buffer overflow: %d bytes dropped", (int)(len - pushed));
+}
 
 class DCNetService : public Service
 {
@@ -60,7 +67,7 @@ class PPPSocket
 public:
 	PPPSocket(asio::io_context& io_context, const asio::ip::tcp::endpoint& endpoint,
 			const std::string& endpointName = "")
-		: socket(io_context)
+		: socket(io_context), retryTimer(io_context)
 	{
 		asio::error_code ec;
 		socket.connect(endpoint, ec);
@@ -99,10 +106,26 @@ protected:
 					return;
 				}
 				pppdump(recvBuffer.data(), len, false);
-				for (size_t i = 0; i < len; i++)
-					toModem.push(recvBuffer[i]);
-				receive();
+				pushToModem(recvBuffer.data(), len);
+				startReceive();
+			});
+	}
+
+	// Stop reading the socket until the emulated modem has made room for a full receive buffer.
+	// TCP flow control then slows down the server.
+	void startReceive()
+	{
+		// Power Smash may add a start flag to each frame
+		if (toModem.available() < recvBuffer.size() * 2)
+		{
+			retryTimer.expires_after(std::chrono::milliseconds(10));
+			retryTimer.async_wait([this](const std::error_code& ec) {
+				if (!ec)
+					startReceive();
 			});
+			return;
+		}
+		receive();
 	}
 
 	void doSend()
@@ -172,6 +195,7 @@ protected:
 	}
 
 	asio::ip::tcp::socket socket;
+	asio::steady_timer retryTimer;
 	std::array<u8, 1542> recvBuffer;
 	std::array<u8, 1542> sendBuffer;
 	u32 sendBufSize = 0;
@@ -217,14 +241,13 @@ private:
 					pppdump(recvBuffer.data(), frameSize, false);
 					// Power Smash requires both start and end Flag Sequences
 					if (recvBuffer[0] != '~')
-						toModem.push('~');
-					for (size_t i = 0; i < frameSize; i++)
-						toModem.push(recvBuffer[i]);
+						pushToModem((const u8 *)"~", 1);
+					pushToModem(recvBuffer.data(), frameSize);
 					recvBufSize -= frameSize;
 					if (recvBufSize != 0)
 						memmove(&recvBuffer[0], &recvBuffer[frameSize], recvBufSize);
 				}
-				receive();
+				startReceive();
 			});
 	}
 
@@ -612,6 +635,8 @@ public:
 		if (thread.joinable())
 			return;
 		io_context = std::make_unique<asio::io_context>();
+		// the network thread isn't running so it's safe to reset the ring
+		toModem.clear();
 		thread = std::thread(&DCNetThread::run, this);
 	}
 
@@ -684,10 +709,11 @@ void DCNetService::writeModem(u8 b) {
 
 int DCNetService::readModem()
 {
-	if (toModem.empty())
+	u8 b;
+	if (!toModem.tryPop(b))
 		return -1;
 	else
-		return toModem.pop();
+		return b;
 }
 
 int DCNetService::modemAvailable() {
@@ -772,7 +798,6 @@ void DCNetThread::connect(const asio::ip::address& address, const std::string& a
 
 void DCNetThread::run()
 {
-	toModem.clear();
 	try {
 		std::string hostname;
 #ifndef LIBRETRO
@@ -138,13 +138,115 @@ struct MemPages
 		memwatch::aramWatcher.getPages(aram);
 		memwatch::elanWatcher.getPages(elanram);
 	}
+	void clear()
+	{
+		frame = -1;
+		ram.clear();
+		vram.clear();
+		aram.clear();
+		elanram.clear();
+	}
+	int frame = -1;
 	memwatch::PageMap ram;
 	memwatch::PageMap vram;
 	memwatch::PageMap aram;
 	memwatch::PageMap elanram;
 };
-static std::unordered_map<int, MemPages> deltaStates;
+// Pages modified by each saved frame, indexed by frame number.
+// ggpo keeps at most MAX_PREDICTION_FRAMES + 2 saved states.
+static std::array<MemPages, 32> deltaStates;
 static int lastSavedFrame = -1;
+static u32 overwrittenDeltaStates;
+
+static MemPages& getDeltaState(int frame) {
+	return deltaStates[frame & (deltaStates.size() - 1)];
+}
+
+// Preallocated buffers for the states saved by ggpo
+class SnapshotPool
+{
+public:
+	u8 *alloc(size_t size)
+	{
+		if (size != bufferSize)
+		{
+			term();
+			bufferSize = size;
+		}
+		if (freeBuffers.empty())
+		{
+			buffers.emplace_back(new u8[bufferSize]);
+			freeBuffers.reserve(buffers.size());
+			return buffers.back().get();
+		}
+		u8 *buffer = freeBuffers.back();
+		freeBuffers.pop_back();
+		return buffer;
+	}
+
+	void release(u8 *buffer) {
+		freeBuffers.push_back(buffer);
+	}
+
+	void term()
+	{
+		freeBuffers.clear();
+		buffers.clear();
+		bufferSize = 0;
+	}
+
+	size_t allocated() const {
+		return buffers.size();
+	}
+	size_t available() const {
+		return freeBuffers.size();
+	}
+
+private:
+	size_t bufferSize = 0;
+	std::vector<std::unique_ptr<u8[]>> buffers;
+	std::vector<u8 *> freeBuffers;
+};
+static SnapshotPool snapshotPool;
+
+// Save and load latencies in microseconds
+class LatencyStats
+{
+public:
+	LatencyStats(const char *name) : name(name) {}
+
+	void add(time_point<steady_clock> start)
+	{
+		u32 us = (u32)duration_cast<microseconds>(steady_clock::now() - start).count();
+		if (samples.size() < MAX_SAMPLES)
+			samples.push_back(us);
+		else
+			samples[count % MAX_SAMPLES] = us;
+		count++;
+	}
+
+	void report()
+	{
+		if (samples.empty())
+			return;
+		std::sort(samples.begin(), samples.end());
+		auto percentile = [this](int p) {
+			return samples[(samples.size() - 1) * p / 100];
+		};
+		INFO_LOG(NETWORK, "GGPO %s: %d samples, p50 %d us, p90 %d us, p99 %d us, max %d us", name, (int)samples.size(),
+				percentile(50), percentile(90), percentile(99), samples.back());
+		samples.clear();
+		count = 0;
+	}
+
+private:
+	static constexpr size_t MAX_SAMPLES = 65536;
+	const char * const name;
+	std::vector<u32> samples;
+	size_t count = 0;
+};
+static LatencyStats saveLatency("save state");
+static LatencyStats loadLatency("load state");
 
 static int timesyncOccurred;
 
@@ -286,9 +388,10 @@ static bool advance_frame(int)
  * should make the current game state match the state contained in the
  * buffer.
  */
-static bool load_game_state(unsigned char *buffer, int len)
+bool load_game_state(unsigned char *buffer, int len)
 {
 	INFO_LOG(NETWORK, "load_game_state");
+	auto start = steady_clock::now();
 
 	rend_start_rollback();
 	// FIXME dynarecs
@@ -298,7 +401,9 @@ static bool load_game_state(unsigned char *buffer, int len)
 	memwatch::unprotect();
 	for (int f = lastSavedFrame - 1; f >= frame; f--)
 	{
-		const MemPages& pages = deltaStates[f];
+		const MemPages& pages = getDeltaState(f);
+		if (pages.frame != f)
+			continue;
 		for (const auto& pair : pages.ram)
 			memcpy(memwatch::ramWatcher.getMemPage(pair.first), &pair.second.data[0], PAGE_SIZE);
 		for (const auto& pair : pages.vram)
@@ -319,6 +424,7 @@ static bool load_game_state(unsigned char *buffer, int len)
 	rend_allow_rollback();	// ggpo might load another state right after this one
 	memwatch::reset();
 	memwatch::protect();
+	loadLatency.add(start);
 	return true;
 }
 
@@ -328,19 +434,14 @@ static bool load_game_state(unsigned char *buffer, int len)
  * length into the *len parameter.  Optionally, the client can compute
  * a checksum of the data and store it in the *checksum argument.
  */
-static bool save_game_state(unsigned char **buffer, int *len, int *checksum, int frame)
+bool save_game_state(unsigned char **buffer, int *len, int *checksum, int frame)
 {
 	verify(!emu.getSh4Executor()->IsCpuRunning());
+	auto start = steady_clock::now();
 	lastSavedFrame = frame;
 	// TODO this is way too much memory
 	size_t allocSize = settings.platform.isNaomi() ? 20_MB : 10_MB;
-	*buffer = (unsigned char *)malloc(allocSize);
-	if (*buffer == nullptr)
-	{
-		WARN_LOG(NETWORK, "Memory alloc failed");
-		*len = 0;
-		return false;
-	}
+	*buffer = snapshotPool.alloc(allocSize);
 	Serializer ser(*buffer, allocSize, true);
 	ser << frame;
 	dc_serialize(ser);
@@ -353,11 +454,11 @@ static bool save_game_state(unsigned char **buffer, int *len, int *checksum, int
 	if (frame > 0)
 	{
 #ifdef SYNC_TEST
-		if (deltaStates.count(frame - 1) != 0)
+		if (getDeltaState(frame - 1).frame == frame - 1)
 		{
 			MemPages memPages;
 			memPages.load();
-			const MemPages& savedPages = deltaStates[frame - 1];
+			const MemPages& savedPages = getDeltaState(frame - 1);
 			//verify(memPages.ram.size() == savedPages.ram.size());
 			if (memPages.ram.size() != savedPages.ram.size())
 			{
@@ -397,10 +498,19 @@ static bool save_game_state(unsigned char **buffer, int *len, int *checksum, int
 		}
 #endif
 		// Save the delta to frame-1
-		deltaStates[frame - 1].load();
-		DEBUG_LOG(NETWORK, "Saved frame %d pages: %d ram, %d vram, %d eram, %d aica ram", frame - 1, (u32)deltaStates[frame - 1].ram.size(),
-				(u32)deltaStates[frame - 1].vram.size(), (u32)deltaStates[frame - 1].elanram.size(), (u32)deltaStates[frame - 1].aram.size());
+		MemPages& pages = getDeltaState(frame - 1);
+		if (pages.frame != -1 && pages.frame != frame - 1)
+		{
+			WARN_LOG(NETWORK, "Delta state of frame %d overwritten by frame %d", pages.frame, frame - 1);
+			pages.clear();
+			overwrittenDeltaStates++;
+		}
+		pages.frame = frame - 1;
+		pages.load();
+		DEBUG_LOG(NETWORK, "Saved frame %d pages: %d ram, %d vram, %d eram, %d aica ram", frame - 1, (u32)pages.ram.size(),
+				(u32)pages.vram.size(), (u32)pages.elanram.size(), (u32)pages.aram.size());
 	}
+	saveLatency.add(start);
 
 	return true;
 }
@@ -436,15 +546,17 @@ static bool log_game_state(char *filename, unsigned char *buffer, int len)
  * free_buffer - Frees a game state allocated in save_game_state.  You
  * should deallocate the memory contained in the buffer.
  */
-static void free_buffer(void *buffer)
+void free_buffer(void *buffer)
 {
 	if (buffer != nullptr)
 	{
 		Deserializer deser(buffer, 1_MB, true);
 		int frame;
 		deser >> frame;
-		deltaStates.erase(frame);
-		free(buffer);
+		MemPages& pages = getDeltaState(frame);
+		if (pages.frame == frame)
+			pages.clear();
+		snapshotPool.release((u8 *)buffer);
 	}
 }
 
@@ -613,6 +725,12 @@ void stopSession()
 	emu.setNetworkState(false);
 	memwatch::unprotect();
 	memwatch::reset();
+	for (MemPages& pages : deltaStates)
+		pages.clear();
+	memwatch::pageArena.clear();
+	snapshotPool.term();
+	saveLatency.report();
+	loadLatency.report();
 }
 
 void getInput(MapleInputState inputState[4])
@@ -938,6 +1056,18 @@ void receiveChatMessages(void (*callback)(int playerNum, const std::string& msg)
 	chatCallback = callback;
 }
 
+StateStats getStateStats()
+{
+	StateStats stats{};
+	stats.snapshotBuffers = snapshotPool.allocated();
+	stats.freeSnapshotBuffers = snapshotPool.available();
+	for (const MemPages& pages : deltaStates)
+		if (pages.frame != -1)
+			stats.deltaStates++;
+	stats.overwrittenDeltaStates = overwrittenDeltaStates;
+	return stats;
+}
+
 }
 
 #else // LIBRETRO
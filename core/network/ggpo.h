@@ -17,6 +17,7 @@
     along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
 */
 #pragma once
+#include "build.h"
 #include <future>
 #include <string>
 
@@ -36,6 +37,22 @@ void endOfFrame();
 void sendChatMessage(int playerNum, const std::string& msg);
 void receiveChatMessages(void (*callback)(int playerNum, const std::string& msg));
 
+#ifdef USE_GGPO
+// ggpo session callbacks
+bool save_game_state(unsigned char **buffer, int *len, int *checksum, int frame);
+bool load_game_state(unsigned char *buffer, int len);
+void free_buffer(void *buffer);
+
+struct StateStats
+{
+	size_t snapshotBuffers;			// state buffers allocated
+	size_t freeSnapshotBuffers;		// allocated buffers not in use
+	size_t deltaStates;				// frames with saved memory pages
+	unsigned overwrittenDeltaStates;	// delta states lost because the ring was full
+};
+StateStats getStateStats();
+#endif
+
 static inline bool rollbacking() {
 	extern bool inRollback;
 
@@ -20,7 +20,7 @@
 #include "ice.h"
 #include "types.h"
 #include "hw/sh4/modules/modules.h"
-#include "util/tsqueue.h"
+#include "util/spsc_ring.h"
 #include "oslib/oslib.h"
 #include "oslib/http_client.h"
 #include "emulator.h"
@@ -504,8 +504,9 @@ private:
 	void onJuiceReceive(const char *data, size_t size)
 	{
 		stat.rxBytes += size;
-		while (size-- != 0)
-			recvQueue.push(*data++);
+		size_t pushed = recvQueue.tryPush((const u8 *)data, size);
+		if (pushed != size)
+			WARN_LOG(NETWORK, "ice: receive queue overflow: %d bytes dropped", (int)(size - pushed));
 	}
 	void onJuiceGatheringDone() {
 		sendCandidates();
@@ -572,10 +573,11 @@ private:
 	}
 	u8 read() override
 	{
-		if (recvQueue.empty())
+		u8 b;
+		if (!recvQueue.tryPop(b))
 			return 0;
 		else
-			return recvQueue.pop();
+			return b;
 	}
 
 	void flushTxBuffer()
@@ -597,7 +599,8 @@ private:
 	std::string opponent;
 	State state = Offline;
 	std::string statusText;
-	TsQueue<u8> recvQueue;
+	// more than 5 s of data at the maximum SCIF rate
+	SpscRing recvQueue { 1_MB };
 	std::vector<std::string> chat;
 	bool matchCode = false;
 	std::array<uint8_t, 256> txBuffer;
@@ -49,7 +49,7 @@ extern "C" {
 #include "cfg/option.h"
 #include "emulator.h"
 #include "oslib/oslib.h"
-#include "util/tsqueue.h"
+#include "util/spsc_ring.h"
 #include "util/shared_this.h"
 #include "hw/bba/bba.h"
 
@@ -64,8 +64,9 @@ extern "C" {
 constexpr int PICO_TICK_MS = 5;
 static pico_device *pico_dev;
 
-static TsQueue<u8> in_buffer;
-static TsQueue<u8> out_buffer;
+static SpscRing in_buffer(1_KB);
+// more than 8 s of data at the emulated modem rate
+static SpscRing out_buffer(64_KB);
 
 static pico_ip4 dcaddr;
 static pico_ip4 dnsaddr;
@@ -177,42 +178,52 @@ pico_ip4 parseDnsResponsePacket(const void *buf, size_t len);
 
 static int modem_read(pico_device *dev, void *data, int len)
 {
-	u8 *p = (u8 *)data;
-	int count = 0;
-	for (; !out_buffer.empty() && count < len; count++)
-		*p++ = out_buffer.pop();
-
-    return count;
+    return (int)out_buffer.tryPop((u8 *)data, len);
 }
 
 static int modem_write(pico_device *dev, const void *data, int len)
 {
-	u8 *p = (u8 *)data;
-
-	for (int i = 0; i < len; i++)
+	const u8 *p = (const u8 *)data;
+	int count = 0;
+	while (count < len)
 	{
-		while (in_buffer.size() > 1024)
+		size_t pushed = in_buffer.tryPush(p + count, len - count);
+		count += pushed;
+		if (pushed == 0)
 		{
+			// wait for the modem to read the incoming data
 			if (!pico_thread_running)
-				return 0;
+				return count;
 			PICO_IDLE();
 		}
-		in_buffer.push(*p++);
 	}
 
     return len;
 }
 
-static void write_pico(u8 b) {
-	out_buffer.push(b);
+static void write_pico(u8 b)
+{
+	static u32 dropped;
+	if (!out_buffer.tryPush(b))
+	{
+		// only log the first byte dropped of each overflow
+		if (dropped++ == 0)
+			WARN_LOG(NETWORK, "PPP output buffer overflow");
+	}
+	else if (dropped != 0)
+	{
+		WARN_LOG(NETWORK, "PPP output buffer overflow: %d bytes dropped", dropped);
+		dropped = 0;
+	}
 }
 
 static int read_pico()
 {
-	if (in_buffer.empty())
+	u8 b;
+	if (!in_buffer.tryPop(b))
 		return -1;
 	else
-		return in_buffer.pop();
+		return b;
 }
 
 static int pico_available() {
@@ -1200,6 +1211,9 @@ public:
 	{
 		verify(!thread.joinable());
 		io_context = std::make_unique<asio::io_context>();
+		// Empty queues. The pico thread isn't running so this is safe.
+		in_buffer.clear();
+		out_buffer.clear();
 		thread = std::thread(&PicoThread::run, this);
 	}
 
@@ -1269,10 +1283,6 @@ void PicoThread::run()
 			}));
 	}
 
-	// Empty queues
-	in_buffer.clear();
-	out_buffer.clear();
-
     // Find DNS ip address
 	{
 		std::string dnsName = config::DNS;
@@ -14,8 +14,10 @@
 #include "ui/mainui.h"
 #include "input/gamepad_device.h"
 #include "lua/lua.h"
+#include "profiler/benchmark.h"
 #include "stdclass.h"
 #include "serialize.h"
+#include <xxhash.h>
 #include <time.h>
 
 static std::string lastStateFile;
@@ -32,7 +34,11 @@ struct SavestateHeader
 	}
 
 	bool isValid() const {
-		return !memcmp(magic, MAGIC, sizeof(magic));
+		return !memcmp(magic, MAGIC, sizeof(magic)) || isDelta();
+	}
+
+	bool isDelta() const {
+		return !memcmp(magic, DELTA_MAGIC, sizeof(magic));
 	}
 
 	char magic[8];
@@ -42,6 +48,8 @@ struct SavestateHeader
 	// png data
 
 	static constexpr const char *MAGIC = "FLYSAVE1";
+	// incremental savestate
+	static constexpr const char *DELTA_MAGIC = "FLYDELT1";
 };
 
 int flycast_init(int argc, char* argv[])
@@ -78,8 +86,11 @@ int flycast_init(int argc, char* argv[])
 		config::Settings::instance().load(false);
 	}
 	gui_init();
-	os_CreateWindow();
-	os_SetupInput();
+	if (!benchmark::enabled())
+	{
+		os_CreateWindow();
+		os_SetupInput();
+	}
 
 	if(config::GDB)
 		debugger::init(config::GDBPort);
@@ -123,40 +134,19 @@ void flycast_term()
 	os_TermInput();
 }
 
-void dc_savestate(int index, const u8 *pngData, u32 pngSize)
+// Write a savestate file: header, png data and compressed state
+static bool writeStateFile(const std::string& filename, SavestateHeader& header, const u8 *pngData, u32 pngSize,
+		const void *data, u32 size)
 {
-	if (settings.network.online)
-		return;
-
-	lastStateFile.clear();
-
-	Serializer ser;
-	dc_serialize(ser);
-
-	void *data = malloc(ser.size());
-	if (data == nullptr)
-	{
-		WARN_LOG(SAVESTATE, "Failed to save state - could not malloc %d bytes", (int)ser.size());
-		os_notify("Save state failed - memory full", 5000);
-    	return;
-	}
-
-	ser = Serializer(data, ser.size());
-	dc_serialize(ser);
-
-	std::string filename = hostfs::getSavestatePath(index, true);
 	FILE *f = nowide::fopen(filename.c_str(), "wb");
 	if (f == nullptr)
 	{
 		WARN_LOG(SAVESTATE, "Failed to save state - could not open %s for writing", filename.c_str());
 		os_notify("Cannot open save file", 5000);
-		free(data);
-    	return;
+		return false;
 	}
 
 	RZipFile zipFile;
-	SavestateHeader header;
-	header.init();
 	header.pngSize = pngSize;
 	if (std::fwrite(&header, sizeof(header), 1, f) != 1)
 		goto fail;
@@ -165,20 +155,16 @@ void dc_savestate(int index, const u8 *pngData, u32 pngSize)
 
 #if 0
 	// Uncompressed savestate
-	std::fwrite(data, 1, ser.size(), f);
+	std::fwrite(data, 1, size, f);
 	std::fclose(f);
 #else
 	if (!zipFile.Open(f, true))
 		goto fail;
-	if (zipFile.Write(data, ser.size()) != ser.size())
+	if (zipFile.Write(data, size) != size)
 		goto fail;
 	zipFile.Close();
 #endif
-
-	free(data);
-	NOTICE_LOG(SAVESTATE, "Saved state to %s size %d", filename.c_str(), (int)ser.size());
-	os_notify("State saved", 2000);
-	return;
+	return true;
 
 fail:
 	WARN_LOG(SAVESTATE, "Failed to save state - error writing %s", filename.c_str());
@@ -187,25 +173,21 @@ fail:
 		zipFile.Close();
 	else
 		std::fclose(f);
-	free(data);
 	// delete failed savestate?
+	return false;
 }
 
-void dc_loadstate(int index)
+// Read the state data of a savestate file. Returns nullptr and notifies the user on failure.
+static void *readStateFile(const std::string& filename, SavestateHeader& header, u32& total_size, int index = 0)
 {
-	if (settings.raHardcoreMode)
-		return;
-	u32 total_size = 0;
-
-	std::string filename = hostfs::getSavestatePath(index, false);
+	total_size = 0;
 	FILE *f = hostfs::storage().openFile(filename, "rb");
 	if (f == nullptr)
 	{
 		WARN_LOG(SAVESTATE, "Failed to load state - could not open %s for reading", filename.c_str());
 		os_notify("Save state not found", 2000);
-		return;
+		return nullptr;
 	}
-	SavestateHeader header;
 	if (std::fread(&header, sizeof(header), 1, f) == 1)
 	{
 		if (!header.isValid())
@@ -247,7 +229,7 @@ void dc_loadstate(int index)
 			std::fclose(f);
 		else
 			zipFile.Close();
-		return;
+		return nullptr;
 	}
 
 	size_t read_size;
@@ -266,8 +248,282 @@ void dc_loadstate(int index)
 		WARN_LOG(SAVESTATE, "Failed to load state - I/O error");
 		os_notify("Failed to load state", 5000, "I/O error");
 		free(data);
+		return nullptr;
+	}
+	return data;
+}
+
+//
+// Incremental savestates
+// A full snapshot of the state is saved in <savestate>.base and the savestate file itself
+// only contains the chunks of the serialized state that differ from this base.
+// A new base is written when the state size changes or when too many chunks differ.
+// The whole state is still serialized and hashed on each save (about 10 ms for 27 MB) but
+// only the changed chunks are compressed, which was most of the cost of a full save.
+//
+namespace deltastate
+{
+
+constexpr u32 CHUNK_SIZE = 4096;
+
+struct DeltaHeader
+{
+	u32 stateSize;		// size of the full serialized state
+	u32 chunkCount;		// number of chunks that follow. Each chunk is its u32 index followed by its data.
+	u64 baseHash;		// hash of the base state
+};
+
+// Base of the last incremental savestate
+static std::string basePath;
+static u32 baseSize;
+static u64 baseHash;
+static std::vector<u64> chunkHashes;
+
+static std::string getBasePath(const std::string& filename) {
+	return filename + ".base";
+}
+
+static u32 chunkSize(u32 index, u32 stateSize) {
+	return std::min(CHUNK_SIZE, stateSize - index * CHUNK_SIZE);
+}
+
+static void hashChunks(const u8 *data, u32 size, std::vector<u64>& hashes)
+{
+	hashes.resize((size + CHUNK_SIZE - 1) / CHUNK_SIZE);
+	for (u32 i = 0; i < hashes.size(); i++)
+		hashes[i] = XXH3_64bits(data + i * CHUNK_SIZE, chunkSize(i, size));
+}
+
+// Build the delta of the given state against the current base.
+// Returns false if there's no valid base or if the delta is too large to be worth it.
+static bool makeDelta(const std::string& filename, const u8 *data, u32 size, std::vector<u8>& delta)
+{
+	if (basePath != getBasePath(filename) || baseSize != size)
+		return false;
+	std::vector<u64> hashes;
+	hashChunks(data, size, hashes);
+	u32 changed = 0;
+	for (u32 i = 0; i < hashes.size(); i++)
+		if (hashes[i] != chunkHashes[i])
+			changed++;
+	// rebase if more than a quarter of the state has changed
+	if (changed > hashes.size() / 4)
+		return false;
+
+	delta.resize(sizeof(DeltaHeader) + changed * (sizeof(u32) + CHUNK_SIZE));
+	DeltaHeader *header = (DeltaHeader *)delta.data();
+	header->stateSize = size;
+	header->chunkCount = changed;
+	header->baseHash = baseHash;
+	u8 *p = delta.data() + sizeof(DeltaHeader);
+	for (u32 i = 0; i < hashes.size(); i++)
+	{
+		if (hashes[i] == chunkHashes[i])
+			continue;
+		memcpy(p, &i, sizeof(u32));
+		p += sizeof(u32);
+		u32 len = chunkSize(i, size);
+		memcpy(p, data + i * CHUNK_SIZE, len);
+		p += len;
+	}
+	delta.resize(p - delta.data());
+
+	return true;
+}
+
+// Base being written. It replaces the current base once the delta file has been saved.
+static std::string pendingPath;
+static u32 pendingSize;
+static u64 pendingHash;
+
+static std::string getTempBasePath(const std::string& filename) {
+	return getBasePath(filename) + ".tmp";
+}
+
+// Save the state as the new base in a temporary file. The delta is then empty.
+// The current base is kept until commitBase() is called.
+static bool writeBase(const std::string& filename, const u8 *data, u32 size, std::vector<u8>& delta)
+{
+	pendingPath.clear();
+	SavestateHeader header;
+	header.init();
+	std::string tmpPath = getTempBasePath(filename);
+	if (!writeStateFile(tmpPath, header, nullptr, 0, data, size))
+	{
+		nowide::remove(tmpPath.c_str());
+		return false;
+	}
+	pendingPath = getBasePath(filename);
+	pendingSize = size;
+	pendingHash = XXH3_64bits(data, size);
+
+	delta.resize(sizeof(DeltaHeader));
+	DeltaHeader *deltaHeader = (DeltaHeader *)delta.data();
+	deltaHeader->stateSize = size;
+	deltaHeader->chunkCount = 0;
+	deltaHeader->baseHash = pendingHash;
+
+	return true;
+}
+
+// Replace the base with the one written by writeBase() if the delta file has been saved.
+// Otherwise the new base is discarded and the previous base and delta are left untouched.
+static void commitBase(const std::string& filename, const u8 *data, bool deltaSaved)
+{
+	if (pendingPath.empty())
+		return;
+	std::string tmpPath = getTempBasePath(filename);
+	pendingPath.clear();
+	if (!deltaSaved)
+	{
+		nowide::remove(tmpPath.c_str());
 		return;
 	}
+	basePath.clear();
+	std::string path = getBasePath(filename);
+	nowide::remove(path.c_str());
+	if (nowide::rename(tmpPath.c_str(), path.c_str()) != 0)
+	{
+		// applyDelta() will fall back to the temporary file
+		WARN_LOG(SAVESTATE, "Failed to rename %s: errno %d", tmpPath.c_str(), errno);
+		return;
+	}
+	basePath = path;
+	baseSize = pendingSize;
+	baseHash = pendingHash;
+	hashChunks(data, pendingSize, chunkHashes);
+	INFO_LOG(SAVESTATE, "Saved base state to %s", basePath.c_str());
+}
+
+static void *loadFailed(const char *reason, void *data = nullptr)
+{
+	WARN_LOG(SAVESTATE, "Failed to load state - %s", reason);
+	os_notify("Failed to load state", 5000, reason);
+	free(data);
+	return nullptr;
+}
+
+// Rebuild the full state from its base and the given delta. Returns nullptr and notifies the user on failure.
+static void *applyDelta(const std::string& filename, const u8 *delta, u32 deltaSize, u32& total_size)
+{
+	DeltaHeader header;
+	if (deltaSize < sizeof(header))
+		return loadFailed("Invalid incremental savestate");
+	memcpy(&header, delta, sizeof(header));
+
+	SavestateHeader baseHeader;
+	u8 *data = (u8 *)readStateFile(getBasePath(filename), baseHeader, total_size);
+	if (data == nullptr)
+		return nullptr;
+	if (total_size != header.stateSize || XXH3_64bits(data, total_size) != header.baseHash)
+	{
+		// The new base may not have been renamed if the emulator was interrupted right after saving the delta
+		free(data);
+		std::string tmpPath = getTempBasePath(filename);
+		if (!hostfs::storage().exists(tmpPath))
+			return loadFailed("Base savestate doesn't match");
+		data = (u8 *)readStateFile(tmpPath, baseHeader, total_size);
+		if (data == nullptr)
+			return nullptr;
+		if (total_size != header.stateSize || XXH3_64bits(data, total_size) != header.baseHash)
+			return loadFailed("Base savestate doesn't match", data);
+	}
+	const u8 *p = delta + sizeof(header);
+	const u8 * const end = delta + deltaSize;
+	for (u32 i = 0; i < header.chunkCount; i++)
+	{
+		u32 index;
+		if (p + sizeof(index) > end)
+			break;
+		memcpy(&index, p, sizeof(index));
+		p += sizeof(index);
+		if (index * CHUNK_SIZE >= total_size)
+			break;
+		u32 len = chunkSize(index, total_size);
+		if (p + len > end)
+			break;
+		memcpy(data + index * CHUNK_SIZE, p, len);
+		p += len;
+	}
+	if (p != end)
+		return loadFailed("Corrupted incremental savestate", data);
+
+	return data;
+}
+
+}	// namespace deltastate
+
+void dc_savestate(int index, const u8 *pngData, u32 pngSize)
+{
+	if (settings.network.online)
+		return;
+
+	lastStateFile.clear();
+
+	Serializer ser;
+	dc_serialize(ser);
+
+	void *data = malloc(ser.size());
+	if (data == nullptr)
+	{
+		WARN_LOG(SAVESTATE, "Failed to save state - could not malloc %d bytes", (int)ser.size());
+		os_notify("Save state failed - memory full", 5000);
+    	return;
+	}
+
+	ser = Serializer(data, ser.size());
+	dc_serialize(ser);
+
+	std::string filename = hostfs::getSavestatePath(index, true);
+	SavestateHeader header;
+	header.init();
+	bool success;
+	if (config::IncrementalSavestates && index >= 0)
+	{
+		std::vector<u8> delta;
+		if (!deltastate::makeDelta(filename, (const u8 *)data, ser.size(), delta)
+				&& !deltastate::writeBase(filename, (const u8 *)data, ser.size(), delta))
+		{
+			free(data);
+			return;
+		}
+		memcpy(header.magic, SavestateHeader::DELTA_MAGIC, sizeof(header.magic));
+		success = writeStateFile(filename, header, pngData, pngSize, delta.data(), delta.size());
+		deltastate::commitBase(filename, (const u8 *)data, success);
+		if (success)
+			NOTICE_LOG(SAVESTATE, "Saved incremental state to %s size %d", filename.c_str(), (int)delta.size());
+	}
+	else
+	{
+		success = writeStateFile(filename, header, pngData, pngSize, data, ser.size());
+		if (success)
+			NOTICE_LOG(SAVESTATE, "Saved state to %s size %d", filename.c_str(), (int)ser.size());
+	}
+	free(data);
+	if (success)
+		os_notify("State saved", 2000);
+}
+
+void dc_loadstate(int index)
+{
+	if (settings.raHardcoreMode)
+		return;
+	u32 total_size = 0;
+
+	std::string filename = hostfs::getSavestatePath(index, false);
+	SavestateHeader header;
+	void *data = readStateFile(filename, header, total_size, index);
+	if (data == nullptr)
+		return;
+
+	if (header.isDelta())
+	{
+		void *delta = data;
+		data = deltastate::applyDelta(filename, (const u8 *)delta, total_size, total_size);
+		free(delta);
+		if (data == nullptr)
+			return;
+	}
 
 	try {
 		Deserializer deser(data, total_size);
@@ -21,9 +21,7 @@ void os_notify(const char *msg, int durationMs = 2000, const char *details = nul
 class ThreadName
 {
 public:
-	ThreadName(const char *name) {
-		os_SetThreadName(name);
-	}
+	ThreadName(const char *name);
 	~ThreadName() {
 		// default name
 		os_SetThreadName("flycast");
@@ -0,0 +1,207 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "benchmark.h"
+#include "emulator.h"
+#include "cfg/option.h"
+#include "hw/maple/maple_cfg.h"
+#include "hw/pvr/Renderer_if.h"
+#include "audio/audiostream.h"
+#include "json.hpp"
+using namespace nlohmann;
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <vector>
+
+namespace benchmark
+{
+
+Options options;
+bool timing;
+std::atomic<u64> sectionTime[(int)Section::Count];
+thread_local Section Scope::current = Section::None;
+thread_local Scope::clock::time_point Scope::start;
+
+static std::atomic<u32> vblankCount;
+
+struct ReplayEntry
+{
+	u32 frame;
+	u32 port;
+	u32 kcode;
+};
+static std::vector<ReplayEntry> replay;
+static size_t replayIndex;
+static u32 replayKcode[4] { ~0u, ~0u, ~0u, ~0u };
+
+// Replay file format: one "<frame> <port> <kcode>" entry per line, kcode in hex.
+// The button state of a port is kept until the next entry for this port. Lines starting with # are ignored.
+static bool loadReplay()
+{
+	replay.clear();
+	replayIndex = 0;
+	if (options.replayPath.empty())
+		return true;
+	FILE *f = nowide::fopen(options.replayPath.c_str(), "rt");
+	if (f == nullptr)
+	{
+		ERROR_LOG(COMMON, "Can't open input replay file %s", options.replayPath.c_str());
+		return false;
+	}
+	char line[256];
+	while (fgets(line, sizeof(line), f) != nullptr)
+	{
+		if (line[0] == '#' || line[0] == '\n' || line[0] == '\r')
+			continue;
+		ReplayEntry entry;
+		if (sscanf(line, "%u %u %x", &entry.frame, &entry.port, &entry.kcode) != 3 || entry.port >= 4)
+		{
+			WARN_LOG(COMMON, "Invalid input replay line: %s", line);
+			continue;
+		}
+		replay.push_back(entry);
+	}
+	std::fclose(f);
+	std::stable_sort(replay.begin(), replay.end(), [](const ReplayEntry& a, const ReplayEntry& b) {
+		return a.frame < b.frame;
+	});
+	INFO_LOG(COMMON, "Loaded %d input replay entries", (int)replay.size());
+
+	return true;
+}
+
+void getInput(MapleInputState inputState[4])
+{
+	if (replay.empty())
+		return;
+	const u32 frame = vblankCount;
+	for (; replayIndex < replay.size() && replay[replayIndex].frame <= frame; replayIndex++)
+		replayKcode[replay[replayIndex].port] = replay[replayIndex].kcode;
+	for (int i = 0; i < 4; i++)
+	{
+		inputState[i] = {};
+		inputState[i].kcode = replayKcode[i];
+	}
+}
+
+// Headless, unthrottled and single-threaded for reproducible timings
+static void overrideConfig()
+{
+	config::AudioBackend.override("null");
+	// no resampling work that depends on the host clock
+	config::DynamicRateControl.override(false);
+	config::ThreadedRendering.override(false);
+	config::AutoSaveState.override(false);
+	config::AutoLoadState.override(false);
+	config::GGPOEnable.override(false);
+}
+
+static void writeReport(double hostSeconds, u32 frames)
+{
+	static const char * const names[] = { "other", "sh4", "aica", "taParse", "textureDecode", "scheduler" };
+	static_assert(std::size(names) == (size_t)Section::Count);
+
+	json sections;
+	double measured = 0;
+	for (int i = 1; i < (int)Section::Count; i++)
+	{
+		const double seconds = sectionTime[i] / 1e9;
+		sections[names[i]] = seconds;
+		measured += seconds;
+	}
+	sections[names[0]] = std::max(0.0, hostSeconds - measured);
+
+	json report = {
+		{ "content", settings.content.path },
+		{ "frames", frames },
+		{ "hostSeconds", hostSeconds },
+		{ "emulatedFps", hostSeconds > 0 ? frames / hostSeconds : 0.0 },
+		{ "dynarec", (bool)config::DynarecEnabled },
+		{ "sections", sections },
+	};
+	const std::string s = report.dump(4) + "\n";
+	if (options.reportPath.empty())
+	{
+		fputs(s.c_str(), stdout);
+		return;
+	}
+	FILE *f = nowide::fopen(options.reportPath.c_str(), "wt");
+	if (f == nullptr)
+	{
+		ERROR_LOG(COMMON, "Can't write benchmark report to %s", options.reportPath.c_str());
+		fputs(s.c_str(), stdout);
+		return;
+	}
+	fputs(s.c_str(), f);
+	std::fclose(f);
+}
+
+int run()
+{
+	if (settings.content.path.empty())
+	{
+		ERROR_LOG(COMMON, "Benchmark: no content to run");
+		return 1;
+	}
+	if (!loadReplay())
+		return 1;
+	overrideConfig();
+	try {
+		emu.loadGame(settings.content.path.c_str());
+	} catch (const FlycastException& e) {
+		ERROR_LOG(COMMON, "Benchmark: can't load %s: %s", settings.content.path.c_str(), e.what());
+		return 1;
+	}
+	// Game-specific settings have been loaded
+	overrideConfig();
+	rend_init_renderer();
+
+	EventManager::listen(Event::VBlank, [](Event, void *) {
+		vblankCount++;
+	});
+	vblankCount = 0;
+	for (auto& time : sectionTime)
+		time = 0;
+	NOTICE_LOG(COMMON, "Benchmark: running %s for %d frames", settings.content.path.c_str(), options.frames);
+
+	int rc = 0;
+	SetAudioThrottling(false);
+	const auto start = std::chrono::steady_clock::now();
+	timing = true;
+	try {
+		emu.start();
+		while (vblankCount < options.frames && emu.running())
+			emu.render();
+	} catch (const FlycastException& e) {
+		ERROR_LOG(COMMON, "Benchmark: %s", e.what());
+		rc = 1;
+	}
+	timing = false;
+	const double hostSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	writeReport(hostSeconds, vblankCount);
+	emu.unloadGame();
+	SetAudioThrottling(true);
+	rend_term_renderer();
+
+	return rc;
+}
+
+}
@@ -0,0 +1,130 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+// Headless benchmark mode: runs the content passed on the command line for a fixed
+// number of emulated frames without renderer nor frame limiting, and writes a timing report.
+#pragma once
+#include "types.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+struct MapleInputState;
+
+// Only the linux-dist frontend can run headless
+#if !defined(LIBRETRO) && defined(__unix__) && !defined(__ANDROID__) && !defined(__SWITCH__)
+#define BENCHMARK_FRONTEND
+#endif
+
+namespace benchmark
+{
+
+enum class Section
+{
+	None,
+	Sh4,
+	Aica,
+	TaParse,
+	TextureDecode,
+	Scheduler,
+	Count
+};
+
+struct Options
+{
+	u32 frames = 0;
+	std::string reportPath;	// stdout if empty
+	std::string replayPath;
+};
+
+#ifndef LIBRETRO
+
+extern Options options;
+
+inline bool enabled() {
+	return options.frames != 0;
+}
+
+extern bool timing;
+extern std::atomic<u64> sectionTime[(int)Section::Count];	// nanoseconds
+
+// Accumulates the host time spent in a section, excluding nested sections
+class Scope
+{
+public:
+	Scope(Section section)
+	{
+		if (timing)
+			enter(section);
+	}
+	~Scope()
+	{
+		if (entered)
+			leave();
+	}
+
+private:
+	using clock = std::chrono::steady_clock;
+
+	void enter(Section section)
+	{
+		const clock::time_point now = clock::now();
+		accumulate(now);
+		previous = current;
+		current = section;
+		entered = true;
+	}
+	void leave()
+	{
+		accumulate(clock::now());
+		current = previous;
+	}
+	static void accumulate(clock::time_point now)
+	{
+		if (current != Section::None)
+			sectionTime[(int)current] += std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count();
+		start = now;
+	}
+
+	Section previous = Section::None;
+	bool entered = false;
+
+	static thread_local Section current;
+	static thread_local clock::time_point start;
+};
+
+int run();
+// Override the controller state with the replay file content, if any
+void getInput(MapleInputState inputState[4]);
+
+#else
+
+inline bool enabled() {
+	return false;
+}
+
+class Scope
+{
+public:
+	Scope(Section) {}
+};
+
+#endif
+
+}
@@ -3,7 +3,13 @@
 #include "cfg/option.h"
 #include "imgui.h"
 #include "implot.h"
+#include "json.hpp"
+#include <algorithm>
 #include <cassert>
+#include <cstdio>
+#include <memory>
+
+using namespace nlohmann;
 
 namespace fc_profiler
 {
@@ -11,8 +17,172 @@ namespace fc_profiler
 	std::vector<ProfileThread*> ProfileThread::s_allThreads;
 	std::recursive_mutex ProfileThread::s_allThreadsLock;
 
+	namespace trace
+	{
+		std::atomic<bool> s_enabled;
+		// protected by ProfileThread::s_allThreadsLock
+		static std::vector<std::unique_ptr<Ring>> s_rings;
+		static std::vector<Ring *> s_freeRings;	// rings of exited threads, whose events can still be saved
+		static u32 s_nextTid = 1;
+
+		static thread_local Ring *s_ring;
+		static thread_local std::string s_threadName;
+		static clock::time_point s_origin = clock::now();
+
+		void setEnabled(bool enabled)
+		{
+			if (enabled != s_enabled)
+			{
+				INFO_LOG(PROFILER, "Trace capture %s", enabled ? "started" : "stopped");
+				s_enabled = enabled;
+			}
+		}
+
+		// Gives the ring back when its thread exits
+		struct RingOwner
+		{
+			~RingOwner()
+			{
+				if (s_ring == nullptr)
+					return;
+				std::unique_lock<std::recursive_mutex> lock(ProfileThread::s_allThreadsLock);
+				s_freeRings.push_back(s_ring);
+				s_ring = nullptr;
+			}
+		};
+		static thread_local RingOwner s_ringOwner;
+
+		Ring *threadRing()
+		{
+			if (s_ring == nullptr)
+			{
+				std::unique_lock<std::recursive_mutex> lock(ProfileThread::s_allThreadsLock);
+				if (!s_freeRings.empty())
+				{
+					// The events of the previous thread are discarded
+					s_ring = s_freeRings.back();
+					s_freeRings.pop_back();
+					for (Ring::Slot& slot : s_ring->slots)
+						slot.seq.store(0, std::memory_order_relaxed);
+					s_ring->head.store(0, std::memory_order_relaxed);
+				}
+				else
+				{
+					s_rings.push_back(std::make_unique<Ring>());
+					s_ring = s_rings.back().get();
+				}
+				s_ring->tid = s_nextTid++;
+				s_ring->threadName = !s_threadName.empty() ? s_threadName : "Thread " + std::to_string(s_ring->tid);
+				// Instantiate the owner so that its destructor runs at thread exit
+				(void)&s_ringOwner;
+			}
+			return s_ring;
+		}
+
+		void instant(const char *name)
+		{
+			Event event;
+			event.name = name;
+			event.time = clock::now();
+			event.duration = 0;
+			event.type = EventType::Instant;
+			threadRing()->push(event);
+		}
+
+		void counter(const char *name, double value)
+		{
+			Event event;
+			event.name = name;
+			event.time = clock::now();
+			event.value = value;
+			event.type = EventType::Counter;
+			threadRing()->push(event);
+		}
+
+		void setThreadName(const char *name)
+		{
+			s_threadName = name;
+			if (s_ring != nullptr)
+			{
+				std::unique_lock<std::recursive_mutex> lock(ProfileThread::s_allThreadsLock);
+				s_ring->threadName = name;
+			}
+		}
+
+		// Copy the events that haven't been overwritten. The ring may be written to concurrently.
+		static std::vector<Event> snapshot(const Ring& ring)
+		{
+			const u64 head = ring.head.load(std::memory_order_acquire);
+			u64 first = head > FC_PROFILE_TRACE_RING_SIZE ? head - FC_PROFILE_TRACE_RING_SIZE : 0;
+			std::vector<Event> events;
+			events.reserve(head - first);
+			for (u64 i = first; i < head; i++)
+			{
+				const Ring::Slot& slot = ring.slots[i & (FC_PROFILE_TRACE_RING_SIZE - 1)];
+				const u64 expected = i * 2 + 2;
+				if (slot.seq.load(std::memory_order_acquire) != expected)
+					continue;
+				Event event = slot.event;
+				std::atomic_thread_fence(std::memory_order_acquire);
+				// discard the event if the slot has been reused while being copied
+				if (slot.seq.load(std::memory_order_relaxed) == expected)
+					events.push_back(event);
+			}
+			return events;
+		}
+
+		static double toMicros(clock::duration d) {
+			return std::chrono::duration<double, std::micro>(d).count();
+		}
+
+		bool save(const std::string& path)
+		{
+			FILE *f = nowide::fopen(path.c_str(), "wt");
+			if (f == nullptr)
+			{
+				WARN_LOG(PROFILER, "Can't create trace file %s", path.c_str());
+				return false;
+			}
+			std::unique_lock<std::recursive_mutex> lock(ProfileThread::s_allThreadsLock);
+			size_t count = 0;
+			std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+			for (const auto& ring : s_rings)
+			{
+				std::fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":%s}}",
+						count++ == 0 ? "" : ",\n", ring->tid, json(ring->threadName).dump().c_str());
+				for (const Event& event : snapshot(*ring))
+				{
+					const std::string name = json(event.name).dump();
+					const double ts = toMicros(event.time - s_origin);
+					switch (event.type)
+					{
+					case EventType::Complete:
+						std::fprintf(f, ",\n{\"name\":%s,\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+								name.c_str(), ring->tid, ts, toMicros(clock::duration(event.duration)));
+						break;
+					case EventType::Instant:
+						std::fprintf(f, ",\n{\"name\":%s,\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}",
+								name.c_str(), ring->tid, ts);
+						break;
+					case EventType::Counter:
+						std::fprintf(f, ",\n{\"name\":%s,\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%.3f}}",
+								name.c_str(), ring->tid, ts, event.value);
+						break;
+					}
+					count++;
+				}
+			}
+			std::fputs("\n]}\n", f);
+			std::fclose(f);
+			INFO_LOG(PROFILER, "Saved %d trace events to %s", (int)count, path.c_str());
+
+			return true;
+		}
+	}
+
 	void startThread(const std::string& threadName)
 	{
+		trace::setEnabled(config::ProfilerEnabled && config::ProfilerTrace);
 		if (config::ProfilerEnabled)
 		{
 			if (!ProfileScope::s_thread)
@@ -8,6 +8,8 @@
 #include <chrono>
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <cstring>
 
 #ifndef __PRETTY_FUNCTION__
 #ifdef _MSC_VER
@@ -19,9 +21,88 @@
 
 #define FC_PROFILE_SCOPE_RESERVE_SIZE 128
 #define FC_PROFILE_HISTORY_MAX_SIZE 512
+#define FC_PROFILE_TRACE_RING_SIZE 65536	// events per thread, must be a power of 2
 
 namespace fc_profiler
 {
+	// Trace capture: each thread writes its events into its own fixed-size ring without locking.
+	// The most recent events of all threads can be saved at any time in Chrome trace json format,
+	// which can be loaded by chrome://tracing or https://ui.perfetto.dev
+	namespace trace
+	{
+		using clock = std::chrono::high_resolution_clock;
+
+		enum class EventType : u8
+		{
+			Complete,
+			Instant,
+			Counter,
+		};
+
+		struct Event
+		{
+			const char *name;
+			clock::time_point time;
+			union {
+				clock::duration::rep duration;	// Complete
+				double value;					// Counter
+			};
+			EventType type;
+		};
+
+		// Single producer: only the owning thread pushes events.
+		// Each slot has a sequence number, odd while the event is being written, so that readers
+		// can discard events that were overwritten while being copied.
+		struct Ring
+		{
+			struct Slot
+			{
+				std::atomic<u64> seq { 0 };	// 2 * (event index + 1) once written
+				Event event;
+			};
+
+			void push(const Event& event)
+			{
+				const u64 idx = head.load(std::memory_order_relaxed);
+				Slot& slot = slots[idx & (FC_PROFILE_TRACE_RING_SIZE - 1)];
+				slot.seq.store(idx * 2 + 1, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_release);
+				slot.event = event;
+				slot.seq.store(idx * 2 + 2, std::memory_order_release);
+				head.store(idx + 1, std::memory_order_release);
+			}
+
+			Slot slots[FC_PROFILE_TRACE_RING_SIZE];
+			std::atomic<u64> head { 0 };
+			u32 tid = 0;
+			std::string threadName;	// protected by ProfileThread::s_allThreadsLock
+		};
+
+		extern std::atomic<bool> s_enabled;
+
+		inline bool enabled() {
+			return s_enabled.load(std::memory_order_relaxed);
+		}
+		void setEnabled(bool enabled);
+		Ring *threadRing();
+
+		inline void complete(const char *name, clock::time_point start, clock::time_point end)
+		{
+			Event event;
+			event.name = name;
+			event.time = start;
+			event.duration = (end - start).count();
+			event.type = EventType::Complete;
+			threadRing()->push(event);
+		}
+		// name must be a string literal
+		void instant(const char *name);
+		void counter(const char *name, double value);
+		// Set the name of the calling thread in the trace
+		void setThreadName(const char *name);
+		bool save(const std::string& path);
+	}
+
 	struct ProfileSection
 	{
 		ProfileSection()
@@ -87,12 +168,14 @@ namespace fc_profiler
 	struct ProfileScope
 	{
 		ProfileScope(const char* function, const char* file, int line)
-			: sectionIdx(0)
+			: sectionIdx(0), function(function), tracing(trace::enabled())
 		{
+			if (s_thread || tracing)
+				start = std::chrono::high_resolution_clock::now();
 			if (s_thread)
 			{
 				ProfileSection section(function, file, line, s_thread->level++);
-				section.start = std::chrono::high_resolution_clock::now();
+				section.start = start;
 				sectionIdx = s_thread->scopes.size();
 				s_thread->scopes.push_back(section);
 			}
@@ -100,14 +183,23 @@ namespace fc_profiler
 
 		~ProfileScope()
 		{
-			if (s_thread)
+			if (s_thread || tracing)
 			{
-				s_thread->scopes[sectionIdx].end = std::chrono::high_resolution_clock::now();
-				s_thread->level--;
+				const std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+				if (s_thread)
+				{
+					s_thread->scopes[sectionIdx].end = end;
+					s_thread->level--;
+				}
+				if (tracing)
+					trace::complete(function, start, end);
 			}
 		}
 
 		size_t sectionIdx;
+		const char *function;
+		bool tracing;
+		std::chrono::high_resolution_clock::time_point start;
 		static thread_local ProfileThread* s_thread;
 	};
 
@@ -124,15 +216,27 @@ namespace fc_profiler
 #define FC_PROFILE_SCOPE_NAMED(name) \
 	fc_profiler::ProfileScope __profile__scope(name, __FILE__, __LINE__);
 
+#define FC_PROFILE_INSTANT(name) \
+	do { if (fc_profiler::trace::enabled()) fc_profiler::trace::instant(name); } while (false)
+
+#define FC_PROFILE_COUNTER(name, value) \
+	do { if (fc_profiler::trace::enabled()) fc_profiler::trace::counter(name, value); } while (false)
+
 #else
 
 namespace fc_profiler
 {
 	inline static void startThread(const std::string& threadName) {}
 	inline static void endThread(float warningTime = 0.0) {}
+	namespace trace
+	{
+		inline static void setThreadName(const char *name) {}
+	}
 }
 
 #define FC_PROFILE_SCOPE
 #define FC_PROFILE_SCOPE_NAMED(name)
+#define FC_PROFILE_INSTANT(name)
+#define FC_PROFILE_COUNTER(name, value)
 
 #endif
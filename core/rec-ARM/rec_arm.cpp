@@ -2407,7 +2407,7 @@ void Arm32Assembler::genMainLoop()
 	Cmp(r0, 0);
 	B(eq, &cleanup);
 	Mov(r4, lr);
-	call((void *)UpdateSystem_INTC);
+	call((void *)rdv_UpdateSystem);
 	Cmp(r0, 0);
 	B(ne, &do_iter);
 	Mov(lr, r4);
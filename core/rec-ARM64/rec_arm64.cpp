@@ -1480,7 +1480,7 @@ public:
 		Ldr(w0, sh4_context_mem_operand(&sh4ctx.CpuRunning));
 		Cbz(w0, &end_mainloop);
 		Mov(x29, lr);				// Save link register in case we return
-		GenCallRuntime(UpdateSystem_INTC);
+		GenCallRuntime(rdv_UpdateSystem);
 		Cbnz(w0, &do_interrupts);
 		Mov(lr, x29);
 		Ldr(w0, sh4_context_mem_operand(&sh4ctx.cycle_counter));
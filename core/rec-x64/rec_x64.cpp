@@ -458,6 +458,14 @@ public:
 					}
 				}
 				break;
+
+			case shop_fipr:
+				genFipr(op);
+				break;
+
+			case shop_ftrv:
+				genFtrv(op);
+				break;
 #endif
 
 			default:
@@ -709,7 +717,7 @@ public:
 
 		add(ecx, SH4_TIMESLICE);
 		mov(dword[rax], ecx);
-		call(UpdateSystem_INTC);
+		call(rdv_UpdateSystem);
 		jmp(run_loop);
 
 	//end_run_loop:
@@ -810,6 +818,84 @@ public:
 	}
 
 private:
+	// The canonical implementations compute in double precision then round to single.
+	// The products of two singles are exact in double precision, and the sums are done in the same order,
+	// so that the results are identical.
+	void genFipr(const shil_opcode& op)
+	{
+		mov(rax, (uintptr_t)op.rs1.reg_ptr(sh4ctx));
+		mov(rcx, (uintptr_t)op.rs2.reg_ptr(sh4ctx));
+		cvtps2pd(xmm0, qword[rax]);
+		cvtps2pd(xmm1, qword[rax + 8]);
+		cvtps2pd(xmm2, qword[rcx]);
+		cvtps2pd(xmm3, qword[rcx + 8]);
+		mulpd(xmm0, xmm2);				// fn0*fm0, fn1*fm1
+		mulpd(xmm1, xmm3);				// fn2*fm2, fn3*fm3
+		movapd(xmm2, xmm0);
+		unpckhpd(xmm2, xmm2);
+		addsd(xmm0, xmm2);
+		addsd(xmm0, xmm1);
+		unpckhpd(xmm1, xmm1);
+		addsd(xmm0, xmm1);
+		cvtsd2ss(regalloc.MapXRegister(op.rd), xmm0);
+	}
+
+	// fd[i] = fn0 * fm[i] + fn1 * fm[i + 4] + fn2 * fm[i + 8] + fn3 * fm[i + 12]
+	void genFtrv(const shil_opcode& op)
+	{
+		mov(rax, (uintptr_t)op.rs1.reg_ptr(sh4ctx));
+		mov(rcx, (uintptr_t)op.rs2.reg_ptr(sh4ctx));
+		mov(rdx, (uintptr_t)op.rd.reg_ptr(sh4ctx));
+		if (cpu.has(Cpu::tAVX))
+		{
+			for (int j = 0; j < 4; j++)
+			{
+				vbroadcastss(xmm1, dword[rax + j * 4]);
+				vcvtps2pd(ymm1, xmm1);
+				vcvtps2pd(ymm2, xword[rcx + j * 16]);
+				if (j == 0)
+					vmulpd(ymm0, ymm1, ymm2);
+				else if (cpu.has(Cpu::tFMA))
+					// exact product so a single rounding is the same
+					vfmadd231pd(ymm0, ymm1, ymm2);
+				else
+				{
+					vmulpd(ymm2, ymm1, ymm2);
+					vaddpd(ymm0, ymm0, ymm2);
+				}
+			}
+			vcvtpd2ps(xmm0, ymm0);
+			vmovups(xword[rdx], xmm0);
+			vzeroupper();
+		}
+		else
+		{
+			cvtps2pd(xmm4, qword[rax]);			// fn0, fn1
+			cvtps2pd(xmm5, qword[rax + 8]);		// fn2, fn3
+			for (int i = 0; i < 4; i += 2)
+			{
+				for (int j = 0; j < 4; j++)
+				{
+					movapd(xmm1, j < 2 ? xmm4 : xmm5);
+					if (j & 1)
+						unpckhpd(xmm1, xmm1);
+					else
+						unpcklpd(xmm1, xmm1);
+					cvtps2pd(j == 0 ? xmm0 : xmm2, qword[rcx + j * 16 + i * 4]);
+					if (j == 0)
+						mulpd(xmm0, xmm1);
+					else
+					{
+						mulpd(xmm2, xmm1);
+						addpd(xmm0, xmm2);
+					}
+				}
+				cvtpd2ps(xmm0, xmm0);
+				movq(qword[rdx + i * 4], xmm0);
+			}
+		}
+	}
+
 	void genMmuLookup(const RuntimeBlockInfo* block, const shil_opcode& op, u32 write)
 	{
 		if (mmu_enabled())
@@ -513,7 +513,7 @@ void X86Compiler::genMainloop()
 	L(intc_schedLabel);
 	add(dword[&sh4ctx.cycle_counter], SH4_TIMESLICE);
 	mov(dword[&sh4ctx.pc], ecx);
-	call((void *)UpdateSystem_INTC);
+	call((void *)rdv_UpdateSystem);
 	cmp(eax, 0);
 	jnz(do_iter);
 	ret();
@@ -18,6 +18,7 @@
 #include "deps/xbrz/xbrz.h"
 #include "hw/pvr/pvr_mem.h"
 #include "hw/mem/addrspace.h"
+#include "profiler/benchmark.h"
 
 #include <mutex>
 #include <xxhash.h>
@@ -27,6 +28,7 @@
 #endif
 
 extern bool pal_needs_update;
+TextureCacheStats textureCacheStats;
 
 // Rough approximation of LoD bias from D adjust param, only used to increase LoD
 const std::array<f32, 16> D_Adjust_LoD_Bias = {
@@ -312,6 +314,10 @@ BaseTextureCacheData::BaseTextureCacheData(TSP tsp, TCW tcw)
 	custom_image_data = nullptr;
 	custom_load_in_progress = 0;
 	gpuPalette = false;
+	lastUsed = FrameCount;
+	gpuSize = 0;
+	cachedHostSize = 0;
+	cachedGpuSize = 0;
 
 	//decode info from tsp/tcw into the texture struct
 	tex = &pvrTexInfo[tcw.PixelFmt == PixelReserved ? Pixel1555 : tcw.PixelFmt];	//texture format table entry
@@ -435,6 +441,7 @@ void BaseTextureCacheData::ComputeHash()
 
 bool BaseTextureCacheData::Update()
 {
+	benchmark::Scope _(benchmark::Section::TextureDecode);
 	//texture state tracking stuff
 	Updates++;
 	dirty = 0;
@@ -671,6 +678,7 @@ bool BaseTextureCacheData::Update()
 	//lock the texture to detect changes in it
 	protectVRam();
 
+	gpuSize = textureDataSize(upscaled_w, upscaled_h, IsMipmapped());
 	UploadToGPU(upscaled_w, upscaled_h, (const u8 *)temp_tex_buffer, IsMipmapped(), mipmapped);
 	if (config::DumpTextures)
 	{
@@ -691,12 +699,41 @@ void BaseTextureCacheData::CheckCustomTexture()
 	{
 		tex_type = TextureType::_8888;
 		gpuPalette = false;
+		gpuSize = textureDataSize(custom_width, custom_height, IsMipmapped());
 		UploadToGPU(custom_width, custom_height, custom_image_data, IsMipmapped(), false);
 		free(custom_image_data);
 		custom_image_data = nullptr;
 	}
 }
 
+u32 BaseTextureCacheData::textureDataSize(u32 width, u32 height, bool mipmapped) const
+{
+	u32 bpp;
+	switch (tex_type)
+	{
+	case TextureType::_8888:
+		bpp = 4;
+		break;
+	case TextureType::_8:
+		bpp = 1;
+		break;
+	default:
+		bpp = 2;
+		break;
+	}
+	u32 size = width * height * bpp;
+	if (mipmapped)
+	{
+		while (width > 1 || height > 1)
+		{
+			width = std::max(width / 2, 1u);
+			height = std::max(height / 2, 1u);
+			size += width * height * bpp;
+		}
+	}
+	return size;
+}
+
 void BaseTextureCacheData::SetDirectXColorOrder(bool enabled) {
 	pvrTexInfo = enabled ? directx::pvrTexInfo : opengl::pvrTexInfo;
 	pal_needs_update = true;
@@ -24,6 +24,7 @@
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <list>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -76,6 +77,11 @@ public:
 		custom_height = other.custom_height;
 		custom_load_in_progress = 0;
 		gpuPalette = other.gpuPalette;
+		lastUsed = other.lastUsed;
+		gpuSize = other.gpuSize;
+		lruPos = other.lruPos;
+		cachedHostSize = other.cachedHostSize;
+		cachedGpuSize = other.cachedGpuSize;
 	}
 
 	TSP tsp;        	//dreamcast texture parameters
@@ -109,6 +115,12 @@ public:
 	u32 custom_height;
 	std::atomic_int custom_load_in_progress;
 	bool gpuPalette;
+	u32 lastUsed;		// frame number at which the texture was last used
+	u32 gpuSize;		// size in bytes of the texture uploaded to the GPU, including mipmaps
+	// Owned by the texture cache
+	std::list<u64>::iterator lruPos;	// position in the LRU list
+	u64 cachedHostSize;	// host and gpu sizes included in the cache totals
+	u32 cachedGpuSize;
 
 	void PrintTextureName();
 	virtual std::string GetId() = 0;
@@ -147,6 +159,8 @@ public:
 	bool Update();
 	virtual void UploadToGPU(int width, int height, const u8 *temp_tex_buffer, bool mipmapped, bool mipmapsIncluded = false) = 0;
 	virtual bool Force32BitTexture(TextureType type) const { return false; }
+	// Host memory used by the backend for this texture, such as staging buffers
+	virtual u32 hostBufferSize() const { return 0; }
 	void CheckCustomTexture();
 	//true if : dirty or paletted texture and hashes don't match
 	bool NeedsUpdate();
@@ -155,6 +169,8 @@ public:
 	void protectVRam();
 	void unprotectVRam();
 	void invalidate();
+	// Size in bytes of a texture of the current type, including its mipmaps
+	u32 textureDataSize(u32 width, u32 height, bool mipmapped) const;
 
 	static bool IsGpuHandledPaletted(TSP tsp, TCW tcw)
 	{
@@ -171,6 +187,18 @@ public:
 	static void SetDirectXColorOrder(bool enabled);
 };
 
+struct TextureCacheStats
+{
+	u32 count = 0;
+	u64 hostBytes = 0;
+	u64 gpuBytes = 0;
+	u64 hits = 0;
+	u64 misses = 0;
+	u64 evictions = 0;
+};
+// Statistics of the active texture cache, updated every frame
+extern TextureCacheStats textureCacheStats;
+
 template<typename Texture>
 class BaseTextureCache
 {
@@ -201,11 +229,17 @@ public:
 			texture = &it->second;
 			// Needed if the texture is updated
 			texture->tcw.StrideSel = tcw.StrideSel;
+			stats.hits++;
+			if (texture->lruPos != lru.begin())
+				lru.splice(lru.begin(), lru, texture->lruPos);
 		}
 		else //create if not existing
 		{
 			texture = &cache.emplace(std::make_pair(key, Texture(tsp, tcw))).first->second;
+			stats.misses++;
+			texture->lruPos = lru.insert(lru.begin(), key);
 		}
+		texture->lastUsed = FrameCount;
 
 		return texture;
 	}
@@ -234,7 +268,14 @@ public:
 		return getTextureCacheData(tsp, tcw);
 	}
 
-	void CollectCleanup()
+	void CollectCleanup() {
+		CollectCleanup([](Texture *texture) { return texture->Delete(); });
+	}
+
+	// Deletes a few textures that have been overwritten for a while, then evicts the least recently used
+	// textures if the cache is over budget. deleteTexture returns false if the texture can't be deleted yet.
+	template<typename Deleter>
+	void CollectCleanup(Deleter deleteTexture)
 	{
 		std::vector<u64> list;
 
@@ -251,9 +292,53 @@ public:
 
 		for (u64 id : list)
 		{
-			if (cache.find(id)->second.Delete())
-				cache.erase(id);
+			auto it = cache.find(id);
+			if (deleteTexture(&it->second))
+				erase(it);
+		}
+
+		// Only the textures used since the last cleanup can have changed size.
+		// They are at the front of the LRU list.
+		for (u64 id : lru)
+		{
+			Texture& texture = cache.find(id)->second;
+			if ((s32)(texture.lastUsed - lastCleanup) < 0)
+				break;
+			const u64 size = hostSize(texture);
+			hostBytes += size - texture.cachedHostSize;
+			gpuBytes += (s64)texture.gpuSize - texture.cachedGpuSize;
+			texture.cachedHostSize = size;
+			texture.cachedGpuSize = texture.gpuSize;
+		}
+		lastCleanup = FrameCount;
+
+		const u64 budget = (u64)config::TextureCacheSize * 1_MB;
+		if (budget != 0 && hostBytes + gpuBytes > budget)
+		{
+			// Evict down to 7/8 of the budget so that it doesn't happen every frame
+			const u64 target = budget - budget / 8;
+			for (auto lruIt = lru.end(); lruIt != lru.begin() && hostBytes + gpuBytes > target; )
+			{
+				--lruIt;
+				auto it = cache.find(*lruIt);
+				Texture& texture = it->second;
+				// Keep the textures used by the last frames, which may still be in flight
+				if (FrameCount - texture.lastUsed <= 2)
+					break;
+				// A custom texture being loaded can't be deleted
+				if (texture.custom_load_in_progress > 0)
+					continue;
+				if (deleteTexture(&texture))
+				{
+					lruIt = erase(it);
+					stats.evictions++;
+				}
+			}
 		}
+		stats.count = cache.size();
+		stats.hostBytes = hostBytes;
+		stats.gpuBytes = gpuBytes;
+		textureCacheStats = stats;
 	}
 
 	void Clear()
@@ -263,11 +348,45 @@ public:
 			texture.Delete();
 
 		cache.clear();
+		lru.clear();
+		hostBytes = 0;
+		gpuBytes = 0;
+		stats = {};
+		textureCacheStats = stats;
 		INFO_LOG(RENDERER, "Texture cache cleared");
 	}
 
+	const TextureCacheStats& getStats() const {
+		return stats;
+	}
+
 protected:
+	static u64 hostSize(const Texture& texture)
+	{
+		u64 size = sizeof(Texture) + texture.hostBufferSize();
+		if (texture.custom_load_in_progress == 0 && texture.custom_image_data != nullptr)
+			size += texture.custom_width * texture.custom_height * 4;
+		return size;
+	}
+
+	// Returns the LRU list position following the erased texture
+	std::list<u64>::iterator erase(typename std::unordered_map<u64, Texture>::iterator it)
+	{
+		Texture& texture = it->second;
+		hostBytes -= texture.cachedHostSize;
+		gpuBytes -= texture.cachedGpuSize;
+		auto next = lru.erase(texture.lruPos);
+		cache.erase(it);
+		return next;
+	}
+
 	std::unordered_map<u64, Texture> cache;
+	// Texture keys, most recently used first
+	std::list<u64> lru;
+	u32 lastCleanup = 0;
+	u64 hostBytes = 0;
+	u64 gpuBytes = 0;
+	TextureCacheStats stats;
 	// Only use TexU and TexV from TSP in the cache key
 	//     TexV : 7, TexU : 7
 	const TSP TSPTextureCacheMask = { { 7, 7 } };
@@ -324,7 +324,7 @@ void DX11Renderer::Process(TA_context* ctx)
 	}
 	texCache.Cleanup();
 
-	ta_parse(ctx, true);
+	ta_parse(ctx, primRestart());
 }
 
 void DX11Renderer::resetContextState()
@@ -322,7 +322,7 @@ void D3DRenderer::Process(TA_context* ctx)
 	}
 	texCache.Cleanup();
 
-	ta_parse(ctx, false);
+	ta_parse(ctx, primRestart());
 }
 
 inline void D3DRenderer::setTexMode(D3DSAMPLERSTATETYPE state, u32 clamp, u32 mirror)
@@ -113,6 +113,7 @@ struct D3DRenderer : public Renderer
 		return true;
 	}
 	BaseTextureCacheData *GetTexture(TSP tsp, TCW tcw) override;
+	bool primRestart() const override { return false; }
 	void preReset();
 	void postReset();
 	void RenderFramebuffer(const FramebufferInfo& info) override;
@@ -1070,7 +1070,7 @@ void OpenGLRenderer::Process(TA_context* ctx)
 		updatePaletteTexture(getPaletteTextureSlot());
 		updatePalette = false;
 	}
-	ta_parse(ctx, gl.prim_restart_fixed_supported || gl.prim_restart_supported);
+	ta_parse(ctx, primRestart());
 }
 
 static void upload_vertex_indices()
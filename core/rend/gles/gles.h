@@ -514,6 +514,9 @@ struct OpenGLRenderer : Renderer
 	bool GetLastFrame(std::vector<u8>& data, int& width, int& height) override;
 
 	BaseTextureCacheData *GetTexture(TSP tsp, TCW tcw) override;
+	bool primRestart() const override {
+		return gl.prim_restart_fixed_supported || gl.prim_restart_supported;
+	}
 
 	bool Present() override
 	{
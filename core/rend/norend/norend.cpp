@@ -10,7 +10,7 @@ struct norend : Renderer
 	void Term() override { }
 
 	void Process(TA_context* ctx) override {
-		ta_parse(ctx, true);
+		ta_parse(ctx, primRestart());
 	}
 
 	bool Render() override {
@@ -20,12 +20,21 @@
 #include <algorithm>
 #include <xxhash.h>
 
+#if HOST_CPU == CPU_X64
+#include <emmintrin.h>
+#define TEXCONV_SIMD
+#elif HOST_CPU == CPU_ARM64
+#include <arm_neon.h>
+#define TEXCONV_SIMD
+#endif
+
 const u8 *vq_codebook;
 u32 palette_index;
 u32 palette16_ram[1024];
 u32 palette32_ram[1024];
 u32 pal_hash_256[4];
 u32 pal_hash_16[64];
+bool texconv_fastpath = true;
 extern bool pal_needs_update;
 
 u32 detwiddle[2][11][1024];
@@ -339,6 +348,298 @@ struct ConvertTwiddlePal8
 	}
 };
 
+#ifdef TEXCONV_SIMD
+// Minimal set of 8 x u16 vector operations used to decode 16-bit texels
+namespace simd
+{
+#if HOST_CPU == CPU_X64
+using u16x8 = __m128i;
+
+// Load two 8-byte blocks
+static inline u16x8 load(const u8 *block0, const u8 *block1) {
+	return _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)block0), _mm_loadl_epi64((const __m128i *)block1));
+}
+static inline u16x8 dup(u16 v) {
+	return _mm_set1_epi16(v);
+}
+static inline u16x8 vand(u16x8 a, u16x8 b) {
+	return _mm_and_si128(a, b);
+}
+static inline u16x8 vor(u16x8 a, u16x8 b) {
+	return _mm_or_si128(a, b);
+}
+template<int n>
+static inline u16x8 shl(u16x8 v) {
+	return _mm_slli_epi16(v, n);
+}
+template<int n>
+static inline u16x8 shr(u16x8 v) {
+	return _mm_srli_epi16(v, n);
+}
+template<int n>
+static inline u16x8 sar(u16x8 v) {
+	return _mm_srai_epi16(v, n);
+}
+// A0 A1 A2 A3 B0 B1 B2 B3 -> A0 A2 B0 B2 A1 A3 B1 B3
+static inline u16x8 toRows(u16x8 v)
+{
+	v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 1, 2, 0));
+	v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(3, 1, 2, 0));
+	return _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 1, 2, 0));
+}
+// Store the low and high 4 texels
+static inline void store(u16x8 v, u16 *row0, u16 *row1)
+{
+	_mm_storel_epi64((__m128i *)row0, v);
+	_mm_storel_epi64((__m128i *)row1, _mm_unpackhi_epi64(v, v));
+}
+// Interleave the low and high 16 bits of each 32-bit texel and store the low and high 4 texels
+static inline void store(u16x8 lo, u16x8 hi, u32 *row0, u32 *row1)
+{
+	_mm_storeu_si128((__m128i *)row0, _mm_unpacklo_epi16(lo, hi));
+	_mm_storeu_si128((__m128i *)row1, _mm_unpackhi_epi16(lo, hi));
+}
+
+#else // CPU_ARM64
+using u16x8 = uint16x8_t;
+
+static inline u16x8 load(const u8 *block0, const u8 *block1) {
+	return vreinterpretq_u16_u8(vcombine_u8(vld1_u8(block0), vld1_u8(block1)));
+}
+static inline u16x8 dup(u16 v) {
+	return vdupq_n_u16(v);
+}
+static inline u16x8 vand(u16x8 a, u16x8 b) {
+	return vandq_u16(a, b);
+}
+static inline u16x8 vor(u16x8 a, u16x8 b) {
+	return vorrq_u16(a, b);
+}
+template<int n>
+static inline u16x8 shl(u16x8 v) {
+	return vshlq_n_u16(v, n);
+}
+template<int n>
+static inline u16x8 shr(u16x8 v)
+{
+	if constexpr (n == 0)
+		return v;
+	else
+		return vshrq_n_u16(v, n);
+}
+template<int n>
+static inline u16x8 sar(u16x8 v) {
+	return vreinterpretq_u16_s16(vshrq_n_s16(vreinterpretq_s16_u16(v), n));
+}
+static inline u16x8 toRows(u16x8 v) {
+	return vcombine_u16(vget_low_u16(vuzp1q_u16(v, v)), vget_low_u16(vuzp2q_u16(v, v)));
+}
+static inline void store(u16x8 v, u16 *row0, u16 *row1)
+{
+	vst1_u16(row0, vget_low_u16(v));
+	vst1_u16(row1, vget_high_u16(v));
+}
+static inline void store(u16x8 lo, u16x8 hi, u32 *row0, u32 *row1)
+{
+	vst1q_u16((u16 *)row0, vzip1q_u16(lo, hi));
+	vst1q_u16((u16 *)row1, vzip2q_u16(lo, hi));
+}
+#endif
+
+// Extract a 4, 5 or 6 bit channel and expand it to 8 bits like the scalar unpackers do
+template<int shift, int bits>
+static inline u16x8 channel8(u16x8 w)
+{
+	u16x8 c = vand(shr<shift>(w), dup((1 << bits) - 1));
+	return vor(shl<8 - bits>(c), shr<2 * bits - 8>(c));
+}
+}
+
+template<typename Packer>
+struct VecPacker;
+
+template<>
+struct VecPacker<RGBAPacker> {
+	static void store(simd::u16x8 r, simd::u16x8 g, simd::u16x8 b, simd::u16x8 a, u32 *row0, u32 *row1) {
+		simd::store(simd::vor(r, simd::shl<8>(g)), simd::vor(b, simd::shl<8>(a)), row0, row1);
+	}
+};
+
+template<>
+struct VecPacker<BGRAPacker> {
+	static void store(simd::u16x8 r, simd::u16x8 g, simd::u16x8 b, simd::u16x8 a, u32 *row0, u32 *row1) {
+		simd::store(simd::vor(b, simd::shl<8>(g)), simd::vor(r, simd::shl<8>(a)), row0, row1);
+	}
+};
+
+// Vector equivalents of the 16-bit unpackers. The input texels are in row order.
+template<typename Unpacker>
+struct VecUnpacker {
+	static constexpr bool supported = false;
+};
+
+template<>
+struct VecUnpacker<UnpackerNop<u16>> {
+	static constexpr bool supported = true;
+	static void store(simd::u16x8 w, u16 *row0, u16 *row1) {
+		simd::store(w, row0, row1);
+	}
+};
+
+template<>
+struct VecUnpacker<Unpacker1555> {
+	static constexpr bool supported = true;
+	// rotate left by 1
+	static void store(simd::u16x8 w, u16 *row0, u16 *row1) {
+		simd::store(simd::vor(simd::shl<1>(w), simd::shr<15>(w)), row0, row1);
+	}
+};
+
+template<>
+struct VecUnpacker<Unpacker4444> {
+	static constexpr bool supported = true;
+	// rotate left by 4
+	static void store(simd::u16x8 w, u16 *row0, u16 *row1) {
+		simd::store(simd::vor(simd::shl<4>(w), simd::shr<12>(w)), row0, row1);
+	}
+};
+
+template<typename Packer>
+struct VecUnpacker<Unpacker565_32<Packer>> {
+	static constexpr bool supported = true;
+	static void store(simd::u16x8 w, u32 *row0, u32 *row1) {
+		VecPacker<Packer>::store(simd::channel8<11, 5>(w), simd::channel8<5, 6>(w), simd::channel8<0, 5>(w),
+				simd::dup(0xff), row0, row1);
+	}
+};
+
+template<typename Packer>
+struct VecUnpacker<Unpacker1555_32<Packer>> {
+	static constexpr bool supported = true;
+	static void store(simd::u16x8 w, u32 *row0, u32 *row1) {
+		VecPacker<Packer>::store(simd::channel8<10, 5>(w), simd::channel8<5, 5>(w), simd::channel8<0, 5>(w),
+				simd::vand(simd::sar<15>(w), simd::dup(0xff)), row0, row1);
+	}
+};
+
+template<typename Packer>
+struct VecUnpacker<Unpacker4444_32<Packer>> {
+	static constexpr bool supported = true;
+	static void store(simd::u16x8 w, u32 *row0, u32 *row1) {
+		VecPacker<Packer>::store(simd::channel8<8, 4>(w), simd::channel8<4, 4>(w), simd::channel8<0, 4>(w),
+				simd::channel8<12, 4>(w), row0, row1);
+	}
+};
+#endif // TEXCONV_SIMD
+
+//
+// Row convertors are used by texture_TW and texture_VQ instead of the corresponding PixelConvertor
+// when available. They decode two horizontally adjacent blocks at once and write the texels directly
+// to the destination rows.
+//
+template<typename PixelConvertor>
+struct RowConvertor {
+	static constexpr bool supported = false;
+};
+
+#ifdef TEXCONV_SIMD
+template<typename Unpacker>
+struct RowConvertor<ConvertTwiddle<Unpacker>>
+{
+	using unpacked_type = typename Unpacker::unpacked_type;
+	static constexpr bool supported = VecUnpacker<Unpacker>::supported;
+
+	void Convert(unpacked_type *dst, u32 stride, const u8 *block0, const u8 *block1) const {
+		VecUnpacker<Unpacker>::store(simd::toRows(simd::load(block0, block1)), dst, dst + stride);
+	}
+};
+#endif
+
+// Palette lookups can't be vectorized efficiently but the palette address only needs to be computed once
+template<typename Unpacker>
+struct PaletteLookup;
+
+template<typename Pixel>
+struct PaletteLookup<UnpackerPalToRgb<Pixel>>
+{
+	const u32 *palette = sizeof(Pixel) == 2 ? &palette16_ram[palette_index] : &palette32_ram[palette_index];
+
+	Pixel operator()(u8 index) const {
+		return palette[index];
+	}
+};
+
+template<>
+struct PaletteLookup<UnpackerNop<u8>>
+{
+	u8 operator()(u8 index) const {
+		return index;
+	}
+};
+
+template<typename Unpacker>
+struct RowConvertor<ConvertTwiddlePal4<Unpacker>>
+{
+	using unpacked_type = typename Unpacker::unpacked_type;
+	static constexpr bool supported = true;
+	PaletteLookup<Unpacker> lookup;
+
+	void Convert(unpacked_type *dst, u32 stride, const u8 *block0, const u8 *block1) const
+	{
+		convertBlock(dst, stride, block0);
+		convertBlock(dst + 4, stride, block1);
+	}
+
+	void convertBlock(unpacked_type *row0, u32 stride, const u8 *p) const
+	{
+		unpacked_type *row1 = row0 + stride;
+		unpacked_type *row2 = row1 + stride;
+		unpacked_type *row3 = row2 + stride;
+		for (int x = 0; x < 4; x += 2)
+		{
+			// Each 2x4 column is stored in 4 consecutive bytes
+			row0[x] = lookup(p[0] & 0xF);
+			row1[x] = lookup(p[0] >> 4);
+			row0[x + 1] = lookup(p[1] & 0xF);
+			row1[x + 1] = lookup(p[1] >> 4);
+			row2[x] = lookup(p[2] & 0xF);
+			row3[x] = lookup(p[2] >> 4);
+			row2[x + 1] = lookup(p[3] & 0xF);
+			row3[x + 1] = lookup(p[3] >> 4);
+			p += 4;
+		}
+	}
+};
+
+template<typename Unpacker>
+struct RowConvertor<ConvertTwiddlePal8<Unpacker>>
+{
+	using unpacked_type = typename Unpacker::unpacked_type;
+	static constexpr bool supported = true;
+	PaletteLookup<Unpacker> lookup;
+
+	void Convert(unpacked_type *dst, u32 stride, const u8 *block0, const u8 *block1) const
+	{
+		convertBlock(dst, stride, block0);
+		convertBlock(dst + 2, stride, block1);
+	}
+
+	void convertBlock(unpacked_type *row0, u32 stride, const u8 *p) const
+	{
+		unpacked_type *row1 = row0 + stride;
+		unpacked_type *row2 = row1 + stride;
+		unpacked_type *row3 = row2 + stride;
+		row0[0] = lookup(p[0]);
+		row1[0] = lookup(p[1]);
+		row0[1] = lookup(p[2]);
+		row1[1] = lookup(p[3]);
+		row2[0] = lookup(p[4]);
+		row3[0] = lookup(p[5]);
+		row2[1] = lookup(p[6]);
+		row3[1] = lookup(p[7]);
+	}
+};
+
 //handler functions
 template<typename PixelConvertor>
 void texture_PL(PixelBuffer<typename PixelConvertor::unpacked_type>* pb, const u8* p_in, u32 width, u32 height)
@@ -382,9 +683,50 @@ void texture_PLVQ(PixelBuffer<typename PixelConvertor::unpacked_type>* pb, const
 	}
 }
 
+template<typename PixelConvertor, bool VQ>
+void texture_TW_rows(PixelBuffer<typename PixelConvertor::unpacked_type>* pb, const u8* p_in, u32 width, u32 height)
+{
+	constexpr u32 xpp = PixelConvertor::xpp;
+	constexpr u32 ypp = PixelConvertor::ypp;
+	constexpr u32 divider = xpp * ypp;
+	const u32 bcx = bitscanrev(width);
+	const u32 bcy = bitscanrev(height);
+	const u32 *twx = detwiddle[0][bcy];
+	const u32 stride = pb->data(0, 1) - pb->data(0, 0);
+	RowConvertor<PixelConvertor> convertor;
+
+	for (u32 y = 0; y < height; y += ypp)
+	{
+		const u32 twy = detwiddle[1][bcx][y];
+		typename PixelConvertor::unpacked_type *dst = pb->data(0, y);
+		for (u32 x = 0; x < width; x += xpp * 2)
+		{
+			const u32 block0 = (twx[x] + twy) / divider;
+			const u32 block1 = (twx[x + xpp] + twy) / divider;
+			if constexpr (VQ)
+				convertor.Convert(dst + x, stride, &vq_codebook[p_in[block0] * 8], &vq_codebook[p_in[block1] * 8]);
+			else
+				convertor.Convert(dst + x, stride, &p_in[block0 << 3], &p_in[block1 << 3]);
+		}
+	}
+}
+
+template<typename PixelConvertor>
+static bool useRowConvertor(u32 width, u32 height)
+{
+	return texconv_fastpath && width >= PixelConvertor::xpp * 2 && height >= PixelConvertor::ypp;
+}
+
 template<typename PixelConvertor>
 void texture_TW(PixelBuffer<typename PixelConvertor::unpacked_type>* pb, const u8* p_in, u32 width, u32 height)
 {
+	if constexpr (RowConvertor<PixelConvertor>::supported)
+	{
+		if (useRowConvertor<PixelConvertor>(width, height)) {
+			texture_TW_rows<PixelConvertor, false>(pb, p_in, width, height);
+			return;
+		}
+	}
 	pb->amove(0, 0);
 
 	const u32 divider = PixelConvertor::xpp * PixelConvertor::ypp;
@@ -408,6 +750,13 @@ void texture_TW(PixelBuffer<typename PixelConvertor::unpacked_type>* pb, const u
 template<typename PixelConvertor>
 void texture_VQ(PixelBuffer<typename PixelConvertor::unpacked_type>* pb, const u8* p_in, u32 width, u32 height)
 {
+	if constexpr (RowConvertor<PixelConvertor>::supported)
+	{
+		if (useRowConvertor<PixelConvertor>(width, height)) {
+			texture_TW_rows<PixelConvertor, true>(pb, p_in, width, height);
+			return;
+		}
+	}
 	pb->amove(0, 0);
 
 	const u32 divider = PixelConvertor::xpp * PixelConvertor::ypp;
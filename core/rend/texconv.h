@@ -24,6 +24,9 @@ extern u32 palette16_ram[1024];
 extern u32 palette32_ram[1024];
 extern u32 pal_hash_256[4];
 extern u32 pal_hash_16[64];
+// Decode twiddled and VQ textures by rows, with SSE2 or NEON when available.
+// Disabling it selects the reference implementation.
+extern bool texconv_fastpath;
 
 void palette_update();
 
@@ -19,8 +19,10 @@
     along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
 */
 #include "texture.h"
+#include "profiler/fc_profiler.h"
 
 #include <algorithm>
+#include <chrono>
 #include <memory>
 
 void setImageLayout(vk::CommandBuffer const& commandBuffer, vk::Image image, vk::Format format, u32 mipmapLevels, vk::ImageLayout oldImageLayout, vk::ImageLayout newImageLayout)
@@ -218,7 +220,10 @@ void Texture::Init(u32 width, u32 height, vk::Format format, u32 dataSize, bool
 	vk::ImageUsageFlags usageFlags = vk::ImageUsageFlagBits::eSampled;
 	if (needsStaging)
 	{
-		stagingBufferData = std::make_unique<BufferData>(dataSize, vk::BufferUsageFlagBits::eTransferSrc);
+		if (stagingRing == nullptr)
+			stagingBufferData = std::make_unique<BufferData>(dataSize, vk::BufferUsageFlagBits::eTransferSrc);
+		else
+			stagingBufferData.reset();
 		usageFlags |= vk::ImageUsageFlagBits::eTransferDst;
 		initialLayout = vk::ImageLayout::eUndefined;
 	}
@@ -265,17 +270,30 @@ void Texture::SetImage(u32 srcSize, const void *srcData, bool isNew, bool genMip
 
 	static const float scopeColor[4] = { 1.0f, 1.0f, 0.0f, 1.0f };
 	CommandBufferDebugScope _(commandBuffer, "SetImage", scopeColor);
+	const auto startTime = std::chrono::steady_clock::now();
 
 	if (!isNew && !needsStaging)
 		setImageLayout(commandBuffer, image.get(), format, mipmapLevels, vk::ImageLayout::eShaderReadOnlyOptimal, vk::ImageLayout::eGeneral);
 
 	void* data;
-	if (needsStaging)
+	vk::Buffer stagingBuffer;
+	vk::DeviceSize stagingOffset = 0;
+	if (needsStaging && stagingRing != nullptr)
+	{
+		// Staging memory is only needed until the copy is done
+		stagingBufferData.reset();
+		StagingRing::Span span = stagingRing->Allocate(srcSize);
+		data = span.data;
+		stagingBuffer = span.buffer;
+		stagingOffset = span.offset;
+	}
+	else if (needsStaging)
 	{
 		if (!stagingBufferData)
 			// This can happen if a texture is first created for RTT, then later updated
 			stagingBufferData = std::make_unique<BufferData>(srcSize, vk::BufferUsageFlagBits::eTransferSrc);
 		data = stagingBufferData->MapMemory();
+		stagingBuffer = stagingBufferData->buffer.get();
 	}
 	else
 		data = allocation.MapMemory();
@@ -319,33 +337,41 @@ void Texture::SetImage(u32 srcSize, const void *srcData, bool isNew, bool genMip
 
 	if (needsStaging)
 	{
-		stagingBufferData->UnmapMemory();
-		// Since we're going to blit to the texture image, set its layout to eTransferDstOptimal
-		setImageLayout(commandBuffer, image.get(), format, mipmapLevels, isNew ? vk::ImageLayout::eUndefined : vk::ImageLayout::eShaderReadOnlyOptimal,
-				vk::ImageLayout::eTransferDstOptimal);
-
+		std::vector<vk::BufferImageCopy> copyRegions;
 		if (mipmapLevels > 1 && !genMipmaps)
 		{
-			vk::DeviceSize bufferOffset = 0;
+			vk::DeviceSize bufferOffset = stagingOffset;
 			for (u32 i = 0; i < mipmapLevels; i++)
 			{
-				vk::BufferImageCopy copyRegion(bufferOffset, 1 << i, 1 << i, vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, mipmapLevels - i - 1, 0, 1),
+				copyRegions.emplace_back(bufferOffset, 1 << i, 1 << i, vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, mipmapLevels - i - 1, 0, 1),
 						vk::Offset3D(0, 0, 0), vk::Extent3D(1 << i, 1 << i, 1));
-				commandBuffer.copyBufferToImage(stagingBufferData->buffer.get(), image.get(), vk::ImageLayout::eTransferDstOptimal, copyRegion);
 				const u32 size = (1 << (2 * i)) * (tex_type == TextureType::_8888 ? 4 : 2);
 				bufferOffset += ((size + 3) >> 2) << 2;
 			}
 		}
 		else
 		{
-			vk::BufferImageCopy copyRegion(0, extent.width, extent.height, vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1),
+			copyRegions.emplace_back(stagingOffset, extent.width, extent.height, vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1),
 					vk::Offset3D(0, 0, 0), vk::Extent3D(extent, 1));
-			commandBuffer.copyBufferToImage(stagingBufferData->buffer.get(), image.get(), vk::ImageLayout::eTransferDstOptimal, copyRegion);
-			if (mipmapLevels > 1)
-				GenerateMipmaps();
 		}
-		// Set the layout for the texture image from eTransferDstOptimal to SHADER_READ_ONLY
-		setImageLayout(commandBuffer, image.get(), format, mipmapLevels, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
+		const vk::ImageLayout oldLayout = isNew ? vk::ImageLayout::eUndefined : vk::ImageLayout::eShaderReadOnlyOptimal;
+		genMipmaps = genMipmaps && mipmapLevels > 1;
+		if (stagingRing != nullptr)
+		{
+			stagingRing->AddUpload(this, stagingBuffer, oldLayout, copyRegions, genMipmaps);
+			stagingRing->stats.uploadTime += std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - startTime).count();
+			return;
+		}
+		stagingBufferData->UnmapMemory();
+		// Since we're going to blit to the texture image, set its layout to eTransferDstOptimal
+		setImageLayout(commandBuffer, image.get(), format, mipmapLevels, oldLayout, vk::ImageLayout::eTransferDstOptimal);
+		commandBuffer.copyBufferToImage(stagingBuffer, image.get(), vk::ImageLayout::eTransferDstOptimal, copyRegions);
+		if (genMipmaps)
+			GenerateMipmaps();
+		else
+			// Set the layout for the texture image from eTransferDstOptimal to SHADER_READ_ONLY
+			setImageLayout(commandBuffer, image.get(), format, mipmapLevels, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
 	}
 	else
 	{
@@ -359,6 +385,12 @@ void Texture::SetImage(u32 srcSize, const void *srcData, bool isNew, bool genMip
 }
 
 void Texture::GenerateMipmaps()
+{
+	GenerateMipmaps(commandBuffer, *image, extent, mipmapLevels, !needsStaging);
+}
+
+void Texture::GenerateMipmaps(vk::CommandBuffer commandBuffer, vk::Image image, vk::Extent2D extent, u32 mipmapLevels,
+		bool preinitialized)
 {
 	static const float scopeColor[4] = { 0.75f, 0.75f, 0.0f, 1.0f };
 	CommandBufferDebugScope _(commandBuffer, "GenerateMipmaps", scopeColor);
@@ -367,13 +399,13 @@ void Texture::GenerateMipmaps()
 	u32 mipHeight = extent.height;
 	vk::ImageMemoryBarrier barrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eTransferRead,
 			vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eTransferSrcOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
-			*image, vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1));
+			image, vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1));
 
 	for (u32 i = 1; i < mipmapLevels; i++)
 	{
 		// Transition previous mipmap level from dst optimal/preinit to src optimal
 		barrier.subresourceRange.baseMipLevel = i - 1;
-		if (i == 1 && !needsStaging)
+		if (i == 1 && preinitialized)
 		{
 			barrier.oldLayout = vk::ImageLayout::ePreinitialized;
 			barrier.srcAccessMask = vk::AccessFlagBits::eHostWrite;
@@ -392,7 +424,7 @@ void Texture::GenerateMipmaps()
 				 { { vk::Offset3D(0, 0, 0), vk::Offset3D(mipWidth, mipHeight, 1) } },
 				 vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, i, 0, 1),
 				 { { vk::Offset3D(0, 0, 0), vk::Offset3D(std::max(mipWidth / 2, 1u), std::max(mipHeight / 2, 1u), 1) } });
-		commandBuffer.blitImage(*image, vk::ImageLayout::eTransferSrcOptimal, *image, vk::ImageLayout::eTransferDstOptimal, blit, vk::Filter::eLinear);
+		commandBuffer.blitImage(image, vk::ImageLayout::eTransferSrcOptimal, image, vk::ImageLayout::eTransferDstOptimal, blit, vk::Filter::eLinear);
 
 		// Transition previous mipmap level from src optimal to shader read-only optimal
 		barrier.oldLayout = vk::ImageLayout::eTransferSrcOptimal;
@@ -420,6 +452,8 @@ void Texture::deferDeleteResource(FlightManager *manager)
 	public:
 		ResourceDeleter(Texture *texture)
 		{
+			if (texture->uploadRing != nullptr)
+				texture->uploadRing->Cancel(texture);
 			std::swap(image, texture->image);
 			std::swap(imageView, texture->imageView);
 			std::swap(bufferData, texture->stagingBufferData);
@@ -435,6 +469,182 @@ void Texture::deferDeleteResource(FlightManager *manager)
 	manager->addToFlight(new ResourceDeleter(this));
 }
 
+void StagingRing::Init(size_t chainSize)
+{
+	if (frames.size() != chainSize)
+		frames.resize(chainSize);
+	alignment = std::max<vk::DeviceSize>(16,
+			VulkanContext::Instance()->GetPhysicalDevice().getProperties().limits.optimalBufferCopyOffsetAlignment);
+}
+
+void StagingRing::Term()
+{
+	for (const PendingUpload& upload : pending)
+		upload.texture->uploadRing = nullptr;
+	pending.clear();
+	frames.clear();
+	if (frame != nullptr)
+		AccumulateStats();
+	frame = nullptr;
+	if (frameCount != 0)
+		INFO_LOG(RENDERER, "StagingRing: %d frames, %.1f uploads/frame, %.1f KB/frame, %d staging buffers created, %.1f us/frame upload time",
+				frameCount, (float)totalStats.uploads / frameCount, totalStats.bytes / 1024.f / frameCount,
+				totalStats.allocations, totalStats.uploadTime / 1000.f / frameCount);
+	totalStats = {};
+	frameCount = 0;
+}
+
+void StagingRing::BeginFrame(int index)
+{
+	if (frame != nullptr)
+		AccumulateStats();
+	frame = &frames[index];
+	// Release the staging buffers that weren't needed the last time this frame was used
+	if (frame->chunks.size() > frame->used)
+		frame->chunks.resize(std::max<size_t>(frame->used, 1));
+	frame->used = 0;
+	chunkIndex = 0;
+	offset = 0;
+}
+
+void StagingRing::AccumulateStats()
+{
+	// Per-frame upload benchmark in the profiler trace
+	FC_PROFILE_COUNTER("Texture uploads", stats.uploads);
+	FC_PROFILE_COUNTER("Staging buffers created", stats.allocations);
+	FC_PROFILE_COUNTER("Texture upload time (us)", stats.uploadTime / 1000.0);
+	totalStats.uploads += stats.uploads;
+	totalStats.allocations += stats.allocations;
+	totalStats.bytes += stats.bytes;
+	totalStats.uploadTime += stats.uploadTime;
+	stats = {};
+	frameCount++;
+}
+
+StagingRing::Span StagingRing::Allocate(vk::DeviceSize size)
+{
+	verify(frame != nullptr);
+	std::vector<Chunk>& chunks = frame->chunks;
+	while (chunkIndex < chunks.size() && offset + size > chunks[chunkIndex].buffer->bufferSize)
+	{
+		chunkIndex++;
+		offset = 0;
+	}
+	if (chunkIndex == chunks.size())
+	{
+		chunks.emplace_back();
+		chunks.back().buffer = std::make_unique<BufferData>(std::max(ChunkSize, size), vk::BufferUsageFlagBits::eTransferSrc);
+		stats.allocations++;
+	}
+	Chunk& chunk = chunks[chunkIndex];
+	if (chunk.data == nullptr)
+		chunk.data = (u8 *)chunk.buffer->MapMemory();
+	frame->used = std::max(frame->used, chunkIndex + 1);
+
+	Span span { chunk.buffer->buffer.get(), offset, chunk.data + offset };
+	offset += size;
+	offset += align(offset, (u32)alignment);
+	stats.bytes += size;
+
+	return span;
+}
+
+void StagingRing::AddUpload(Texture *texture, vk::Buffer buffer, vk::ImageLayout oldLayout,
+		const std::vector<vk::BufferImageCopy>& regions, bool genMipmaps)
+{
+	// Replace any previous upload of this texture in the same frame
+	auto it = std::find_if(pending.begin(), pending.end(), [texture](const PendingUpload& upload) {
+		return upload.texture == texture;
+	});
+	if (it != pending.end())
+	{
+		// The previous copy hasn't been done so the image is still in its original layout
+		if (it->image == texture->image.get())
+			oldLayout = it->oldLayout;
+		pending.erase(it);
+	}
+	pending.push_back({ texture, texture->image.get(), buffer, oldLayout, texture->extent, texture->mipmapLevels, regions, genMipmaps });
+	texture->uploadRing = this;
+	stats.uploads++;
+}
+
+void StagingRing::Cancel(const Texture *texture)
+{
+	auto it = std::find_if(pending.begin(), pending.end(), [texture](const PendingUpload& upload) {
+		return upload.texture == texture;
+	});
+	if (it != pending.end())
+	{
+		it->texture->uploadRing = nullptr;
+		pending.erase(it);
+	}
+}
+
+void StagingRing::Retarget(const Texture *from, Texture *to)
+{
+	for (PendingUpload& upload : pending)
+		if (upload.texture == from)
+			upload.texture = to;
+}
+
+void StagingRing::Unmap()
+{
+	if (frame == nullptr)
+		return;
+	for (Chunk& chunk : frame->chunks)
+		if (chunk.data != nullptr)
+		{
+			chunk.buffer->UnmapMemory();
+			chunk.data = nullptr;
+		}
+}
+
+void StagingRing::Flush(vk::CommandBuffer commandBuffer)
+{
+	Unmap();
+	if (pending.empty())
+		return;
+	static const float scopeColor[4] = { 1.0f, 1.0f, 0.0f, 1.0f };
+	CommandBufferDebugScope _(commandBuffer, "StagingRing::Flush", scopeColor);
+	const auto startTime = std::chrono::steady_clock::now();
+
+	// Transition all the images to eTransferDstOptimal at once
+	std::vector<vk::ImageMemoryBarrier> barriers;
+	barriers.reserve(pending.size());
+	for (const PendingUpload& upload : pending)
+		barriers.emplace_back(upload.oldLayout == vk::ImageLayout::eUndefined ? vk::AccessFlags() : vk::AccessFlagBits::eShaderRead,
+				vk::AccessFlagBits::eTransferWrite, upload.oldLayout, vk::ImageLayout::eTransferDstOptimal,
+				VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, upload.image,
+				vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, upload.mipmapLevels, 0, 1));
+	commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe | vk::PipelineStageFlagBits::eFragmentShader,
+			vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr, barriers);
+
+	for (const PendingUpload& upload : pending)
+		commandBuffer.copyBufferToImage(upload.buffer, upload.image, vk::ImageLayout::eTransferDstOptimal, upload.regions);
+
+	barriers.clear();
+	for (const PendingUpload& upload : pending)
+	{
+		upload.texture->uploadRing = nullptr;
+		if (upload.genMipmaps)
+			Texture::GenerateMipmaps(commandBuffer, upload.image, upload.extent, upload.mipmapLevels, false);
+		else
+		{
+			barriers.emplace_back(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead,
+					vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal,
+					VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, upload.image,
+					vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, upload.mipmapLevels, 0, 1));
+		}
+	}
+	if (!barriers.empty())
+		commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader,
+				{}, nullptr, nullptr, barriers);
+	stats.uploadTime += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+	DEBUG_LOG(RENDERER, "StagingRing: %d uploads, %d KB, %d new buffers, %d us", stats.uploads, (int)(stats.bytes / 1024),
+			stats.allocations, (int)(stats.uploadTime / 1000));
+	pending.clear();
+}
+
 void FramebufferAttachment::Init(u32 width, u32 height, vk::Format format, const vk::ImageUsageFlags& usage, const std::string& name)
 {
 	this->format = format;
@@ -486,22 +696,7 @@ void FramebufferAttachment::Init(u32 width, u32 height, vk::Format format, const
 
 void TextureCache::Cleanup()
 {
-	std::vector<u64> list;
-
-	u32 TargetFrame = std::max((u32)120, FrameCount) - 120;
-
-	for (const auto& [id, texture] : cache)
-	{
-		if (texture.dirty && texture.dirty < TargetFrame)
-			list.push_back(id);
-
-		if (list.size() > 5)
-			break;
-	}
-
-	for (u64 id : list)
-	{
-		if (clearTexture(&cache[id]))
-			cache.erase(id);
-	}
+	CollectCleanup([this](Texture *texture) {
+		return clearTexture(texture);
+	});
 }
@@ -33,6 +33,83 @@
 
 void setImageLayout(vk::CommandBuffer const& commandBuffer, vk::Image image, vk::Format format, u32 mipmapLevels, vk::ImageLayout oldImageLayout, vk::ImageLayout newImageLayout);
 
+class Texture;
+
+// Linear staging memory shared by all the texture uploads of a frame.
+// Buffer to image copies and layout transitions are batched and recorded by Flush().
+class StagingRing
+{
+public:
+	void Init(size_t chainSize = 2);
+	void Term();
+	// The fence of this frame index must have been waited for (see CommandPool::BeginFrame)
+	void BeginFrame(int index);
+	void Flush(vk::CommandBuffer commandBuffer);
+	// Drop the pending uploads of a texture being deleted
+	void Cancel(const Texture *texture);
+	// Update the pending uploads of a texture being moved
+	void Retarget(const Texture *from, Texture *to);
+
+	struct Stats
+	{
+		u32 uploads;
+		u32 allocations;	// staging buffers created
+		u64 bytes;
+		u64 uploadTime;		// host time spent copying to staging memory and recording the copies, in ns
+	};
+	// Stats of the current frame
+	const Stats& getStats() const { return stats; }
+
+private:
+	struct Span
+	{
+		vk::Buffer buffer;
+		vk::DeviceSize offset;
+		u8 *data;
+	};
+	Span Allocate(vk::DeviceSize size);
+	void AddUpload(Texture *texture, vk::Buffer buffer, vk::ImageLayout oldLayout,
+			const std::vector<vk::BufferImageCopy>& regions, bool genMipmaps);
+	void Unmap();
+	void AccumulateStats();
+
+	struct Chunk
+	{
+		std::unique_ptr<BufferData> buffer;
+		u8 *data = nullptr;
+	};
+	struct Frame
+	{
+		std::vector<Chunk> chunks;
+		size_t used = 0;
+	};
+	struct PendingUpload
+	{
+		Texture *texture;
+		vk::Image image;
+		vk::Buffer buffer;
+		vk::ImageLayout oldLayout;
+		vk::Extent2D extent;
+		u32 mipmapLevels;
+		std::vector<vk::BufferImageCopy> regions;
+		bool genMipmaps;
+	};
+
+	static constexpr vk::DeviceSize ChunkSize = 4_MB;
+
+	std::vector<Frame> frames;
+	std::vector<PendingUpload> pending;
+	Frame *frame = nullptr;
+	size_t chunkIndex = 0;
+	vk::DeviceSize offset = 0;
+	vk::DeviceSize alignment = 16;
+	Stats stats {};
+	Stats totalStats {};
+	u32 frameCount = 0;
+
+	friend class Texture;
+};
+
 class Texture final : public BaseTextureCacheData
 {
 public:
@@ -40,6 +117,10 @@ public:
 		this->physicalDevice = VulkanContext::Instance()->GetPhysicalDevice();
 		this->device = VulkanContext::Instance()->GetDevice();
 	}
+	~Texture() {
+		if (uploadRing != nullptr)
+			uploadRing->Cancel(this);
+	}
 	Texture(Texture&& other) : BaseTextureCacheData(std::move(other)) {
 		std::swap(format, other.format);
 		std::swap(extent, other.extent);
@@ -47,6 +128,10 @@ public:
 		std::swap(needsStaging, other.needsStaging);
 		std::swap(stagingBufferData, other.stagingBufferData);
 		std::swap(commandBuffer, other.commandBuffer);
+		std::swap(stagingRing, other.stagingRing);
+		std::swap(uploadRing, other.uploadRing);
+		if (uploadRing != nullptr)
+			uploadRing->Retarget(&other, this);
 		std::swap(allocation, other.allocation);
 		std::swap(image, other.image);
 		std::swap(imageView, other.imageView);
@@ -61,8 +146,13 @@ public:
 	vk::ImageView GetImageView() const { return *imageView; }
 	vk::Image GetImage() const { return *image; }
 	vk::ImageView GetReadOnlyImageView() const { return readOnlyImageView ? readOnlyImageView : *imageView; }
-	void SetCommandBuffer(vk::CommandBuffer commandBuffer) { this->commandBuffer = commandBuffer; }
+	// Uploads are recorded in stagingRing and only written to commandBuffer when the ring is flushed, if not null
+	void SetCommandBuffer(vk::CommandBuffer commandBuffer, StagingRing *stagingRing = nullptr) {
+		this->commandBuffer = commandBuffer;
+		this->stagingRing = stagingRing;
+	}
 	bool Force32BitTexture(TextureType type) const override { return !VulkanContext::Instance()->IsFormatSupported(type); }
+	u32 hostBufferSize() const override { return stagingBufferData ? (u32)stagingBufferData->bufferSize : 0; }
 	vk::Extent2D getSize() const { return extent; }
 	void deferDeleteResource(FlightManager *manager);
 
@@ -72,6 +162,8 @@ private:
 	void CreateImage(vk::ImageTiling tiling, vk::ImageUsageFlags usage, vk::ImageLayout initialLayout,
 			vk::ImageAspectFlags aspectMask);
 	void GenerateMipmaps();
+	static void GenerateMipmaps(vk::CommandBuffer commandBuffer, vk::Image image, vk::Extent2D extent, u32 mipmapLevels,
+			bool preinitialized);
 
 	vk::Format format = vk::Format::eUndefined;
 	vk::Extent2D extent;
@@ -80,6 +172,8 @@ private:
 	bool needsStaging = false;
 	std::unique_ptr<BufferData> stagingBufferData;
 	vk::CommandBuffer commandBuffer;
+	StagingRing *stagingRing = nullptr;
+	StagingRing *uploadRing = nullptr;	// ring holding a pending upload of this texture
 
 	Allocation allocation;
 	vk::UniqueImage image;
@@ -92,6 +186,7 @@ private:
 	friend class TextureDrawer;
 	friend class OITTextureDrawer;
 	friend class TextureCache;
+	friend class StagingRing;
 };
 
 class SamplerManager
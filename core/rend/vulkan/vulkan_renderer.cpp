@@ -28,6 +28,7 @@ bool BaseVulkanRenderer::BaseInit(vk::RenderPass renderPass, int subpass)
 {
 	texCommandPool.Init();
 	fbCommandPool.Init();
+	stagingRing.Init();
 	quadPipeline = std::make_unique<QuadPipeline>(false, false);
 	quadPipeline->Init(&shaderManager, renderPass, subpass);
 	framebufferDrawer = std::make_unique<QuadDrawer>();
@@ -50,6 +51,7 @@ void BaseVulkanRenderer::Term()
 	paletteTexture = nullptr;
 	texCommandPool.Term();
 	fbCommandPool.Term();
+	stagingRing.Term();
 	framebufferTextures.clear();
 	framebufferTexIndex = 0;
 	shaderManager.term();
@@ -65,7 +67,7 @@ BaseTextureCacheData *BaseVulkanRenderer::GetTexture(TSP tsp, TCW tcw)
 		// This kills performance when a frame is skipped and lots of texture updated each frame
 		//if (textureCache.IsInFlight(tf, true))
 		//	textureCache.DestroyLater(tf);
-		tf->SetCommandBuffer(texCommandBuffer);
+		tf->SetCommandBuffer(texCommandBuffer, &stagingRing);
 		if (!tf->Update())
 		{
 			tf->SetCommandBuffer(nullptr);
@@ -75,7 +77,7 @@ BaseTextureCacheData *BaseVulkanRenderer::GetTexture(TSP tsp, TCW tcw)
 	else if (tf->IsCustomTextureAvailable())
 	{
 		tf->deferDeleteResource(&texCommandPool);
-		tf->SetCommandBuffer(texCommandBuffer);
+		tf->SetCommandBuffer(texCommandBuffer, &stagingRing);
 		tf->CheckCustomTexture();
 	}
 	tf->SetCommandBuffer(nullptr);
@@ -99,15 +101,17 @@ void BaseVulkanRenderer::Process(TA_context* ctx)
 	texCommandPool.BeginFrame();
 	textureCache.SetCurrentIndex(texCommandPool.GetIndex());
 	textureCache.Cleanup();
+	stagingRing.BeginFrame(texCommandPool.GetIndex());
 
 	texCommandBuffer = texCommandPool.Allocate();
 	texCommandBuffer.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
 
-	ta_parse(ctx, true);
+	ta_parse(ctx, primRestart());
 
 	// TODO can't update fog or palette twice in multi render
 	CheckFogTexture();
 	CheckPaletteTexture();
+	stagingRing.Flush(texCommandBuffer);
 	texCommandBuffer.end();
 }
 
@@ -199,7 +203,7 @@ void BaseVulkanRenderer::CheckFogTexture()
 	u8 texData[256];
 	MakeFogTexture(texData);
 
-	fogTexture->SetCommandBuffer(texCommandBuffer);
+	fogTexture->SetCommandBuffer(texCommandBuffer, &stagingRing);
 	fogTexture->UploadToGPU(128, 2, texData, false);
 	fogTexture->SetCommandBuffer(nullptr);
 }
@@ -215,7 +219,7 @@ void BaseVulkanRenderer::CheckPaletteTexture()
 	}
 	updatePalette = false;
 
-	paletteTexture->SetCommandBuffer(texCommandBuffer);
+	paletteTexture->SetCommandBuffer(texCommandBuffer, &stagingRing);
 	paletteTexture->UploadToGPU(1024, 1, (u8 *)palette32_ram, false);
 	paletteTexture->SetCommandBuffer(nullptr);
 }
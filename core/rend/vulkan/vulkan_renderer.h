@@ -67,6 +67,7 @@ protected:
 	std::unique_ptr<Texture> fogTexture;
 	std::unique_ptr<Texture> paletteTexture;
 	CommandPool texCommandPool;
+	StagingRing stagingRing;
 	std::vector<std::unique_ptr<Texture>> framebufferTextures;
 	int framebufferTexIndex = 0;
 	TextureCache textureCache;
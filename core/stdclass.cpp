@@ -4,6 +4,7 @@
 #include "oslib/oslib.h"
 #include "serialize.h"
 #include "oslib/storage.h"
+#include "profiler/fc_profiler.h"
 
 #include <chrono>
 #include <cstring>
@@ -146,6 +147,12 @@ bool make_directory(const std::string& path)
 	return flycast::mkdir(path.c_str(), 0755) == 0;
 }
 
+ThreadName::ThreadName(const char *name)
+{
+	os_SetThreadName(name);
+	fc_profiler::trace::setThreadName(name);
+}
+
 void cThread::Start()
 {
 	verify(!thread.joinable());
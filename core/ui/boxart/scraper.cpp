@@ -17,7 +17,9 @@
     along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
  */
 #include "scraper.h"
+#include "../game_scanner.h"
 #include "oslib/http_client.h"
+#include "oslib/oslib.h"
 #include "oslib/storage.h"
 #include "stdclass.h"
 #include "emulator.h"
@@ -26,7 +28,11 @@
 #include "reios/reios.h"
 #include "pvrparser.h"
 #include <stb_image_write.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <random>
+#include <thread>
 
 json GameBoxart::to_json(const std::string& baseArtPath) const
 {
@@ -111,7 +117,9 @@ std::string Scraper::makeUniqueFilename(const std::string& url)
 	static std::random_device randomDev;
 	static std::mt19937 mt(randomDev());
 	static std::uniform_int_distribution<int> dist(1, 1000000000);
+	static std::mutex mutex;
 
+	std::lock_guard<std::mutex> _(mutex);
 	std::string extension = get_file_extension(url);
 	std::string path;
 	do {
@@ -210,29 +218,21 @@ void OfflineScraper::scrape(GameBoxart& item)
 		}
 		delete disc;
 
-		item.uniqueId = trim_trailing_ws(std::string(diskId.product_number, sizeof(diskId.product_number)));
-		std::replace_if(item.uniqueId.begin(), item.uniqueId.end(), [](u8 c) {
-			return !std::isprint(c);
-		}, ' ');
-
-		item.searchName = trim_trailing_ws(std::string(diskId.software_name, sizeof(diskId.software_name)));
+		DiscInfo discInfo;
+		discInfo.set(diskId);
+		item.uniqueId = discInfo.productNumber;
+		item.searchName = discInfo.softwareName;
 		if (item.searchName.empty())
 			item.searchName = item.name;
-		else
-		{
-			std::replace_if(item.searchName.begin(), item.searchName.end(), [](u8 c) {
-				return !std::isprint(c);
-			}, ' ');
-		}
 
-		if (diskId.area_symbols[0] != '\0')
+		if (!discInfo.areaSymbols.empty())
 		{
 			item.region = 0;
-			if (diskId.area_symbols[0] == 'J')
+			if (discInfo.areaSymbols[0] == 'J')
 				item.region |= GameBoxart::JAPAN;
-			if (diskId.area_symbols[1] == 'U')
+			if (discInfo.areaSymbols[1] == 'U')
 				item.region |= GameBoxart::USA;
-			if (diskId.area_symbols[2] == 'E')
+			if (discInfo.areaSymbols[2] == 'E')
 				item.region |= GameBoxart::EUROPE;
 		}
 		else
@@ -272,3 +272,27 @@ void OfflineScraper::scrape(GameBoxart& item)
 		}
 	}
 }
+
+void OfflineScraper::scrape(std::vector<GameBoxart>& items)
+{
+	const unsigned threadCount = std::min<unsigned>(std::max(std::thread::hardware_concurrency(), 2u), items.size());
+	if (threadCount <= 1)
+	{
+		Scraper::scrape(items);
+		return;
+	}
+	std::atomic<size_t> next { 0 };
+	const auto& worker = [&]() {
+		for (size_t i = next++; i < items.size(); i = next++)
+			scrape(items[i]);
+	};
+	std::vector<std::thread> threads;
+	for (unsigned i = 1; i < threadCount; i++)
+		threads.emplace_back([&worker]() {
+			ThreadName _("BoxArt-parser");
+			worker();
+		});
+	worker();
+	for (auto& thread : threads)
+		thread.join();
+}
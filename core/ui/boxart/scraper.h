@@ -99,4 +99,6 @@ class OfflineScraper : public Scraper
 {
 public:
 	void scrape(GameBoxart& item) override;
+	// Disc images are parsed concurrently
+	void scrape(std::vector<GameBoxart>& items) override;
 };
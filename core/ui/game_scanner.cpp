@@ -21,6 +21,15 @@
 #include "oslib/oslib.h"
 #include "oslib/storage.h"
 #include "cfg/option.h"
+#include "imgread/common.h"
+#include "reios/reios.h"
+#include "json.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+
+using namespace nlohmann;
 
 static bool operator<(const GameMedia &left, const GameMedia &right)
 {
@@ -34,74 +43,342 @@ void GameScanner::insert_game(const GameMedia& game)
 	game_list.insert(std::upper_bound(game_list.begin(), game_list.end(), game), game);
 }
 
-void GameScanner::add_game_directory(const std::string& path)
+// Non-printable characters are replaced by spaces and trailing spaces are removed
+static std::string ipMetaString(const char *s, size_t size)
+{
+	std::string str(s, size);
+	std::replace_if(str.begin(), str.end(), [](u8 c) {
+		return !std::isprint(c);
+	}, ' ');
+	return trim_trailing_ws(str);
+}
+
+void DiscInfo::set(const ip_meta_t& meta)
 {
-	hostfs::DirectoryTree tree(path);
-	std::string emptyParentPath;
-	for (const hostfs::FileInfo& item : tree)
+	parsed = true;
+	if (memcmp(meta.hardware_id, "SEGA SEGAKATANA ", sizeof(meta.hardware_id))
+			|| memcmp(meta.maker_id, "SEGA ENTERPRISES", sizeof(meta.maker_id)))
 	{
-		if (!running)
-			break;
+		productNumber.clear();
+		softwareName.clear();
+		areaSymbols.clear();
+		return;
+	}
+	productNumber = ipMetaString(meta.product_number, sizeof(meta.product_number));
+	softwareName = ipMetaString(meta.software_name, sizeof(meta.software_name));
+	if (meta.area_symbols[0] == '\0')
+	{
+		areaSymbols.clear();
+	}
+	else
+	{
+		areaSymbols = std::string(meta.area_symbols, sizeof(meta.area_symbols));
+		std::replace_if(areaSymbols.begin(), areaSymbols.end(), [](u8 c) {
+			return !std::isprint(c);
+		}, ' ');
+	}
+}
 
-		if (game_list.empty())
+static DiscInfo readDiscInfo(const std::string& path)
+{
+	DiscInfo info;
+	info.parsed = true;
+	try {
+		std::unique_ptr<Disc> disc(OpenDisc(path));
+		if (disc != nullptr)
 		{
-			// This won't work for android content uris
-			size_t slash = get_last_slash_pos(item.path);
-			std::string parentPath;
-			if (slash != 0 && slash != std::string::npos)
-				parentPath = item.path.substr(0, slash);
-			else
-				parentPath = item.path;
-			if (parentPath != emptyParentPath)
+			u8 sector[2048];
+			disc->ReadSectors(disc->GetBaseFAD(), 1, sector, sizeof(sector));
+			ip_meta_t meta;
+			memcpy(&meta, sector, sizeof(meta));
+			info.set(meta);
+		}
+	} catch (const std::runtime_error& e) {
+		DEBUG_LOG(COMMON, "Can't open disk %s: %s", path.c_str(), e.what());
+	} catch (const std::exception& e) {
+		DEBUG_LOG(COMMON, "Can't open disk %s: %s", path.c_str(), e.what());
+	}
+	return info;
+}
+
+void GameScanner::add_game_file(IndexedFile& file)
+{
+	const hostfs::FileInfo& item = file.info;
+	if (item.name.substr(0, 2) == "._")
+		// Ignore Mac OS turds
+		return;
+	std::string fileName(item.name);
+	std::string gameName(get_file_basename(item.name));
+	std::string extension = get_file_extension(item.name);
+	if (extension == "zip" || extension == "7z")
+	{
+		string_tolower(gameName);
+		auto it = arcade_games.find(gameName);
+		if (it == arcade_games.end())
+			return;
+		gameName = it->second->description;
+		fileName = fileName + " (" + gameName + ")";
+		insert_game(GameMedia{ fileName, item.path, item.name, gameName, true });
+		return;
+	}
+	else if (extension == "bin" || extension == "lst" || extension == "dat")
+	{
+		if (!config::HideLegacyNaomiRoms)
+			insert_game(GameMedia{ fileName, item.path, item.name, gameName, true });
+		return;
+	}
+	else if (extension == "chd" || extension == "gdi")
+	{
+		// Hide arcade gdroms
+		std::string basename = gameName;
+		string_tolower(basename);
+		if (arcade_gdroms.count(basename) != 0)
+			return;
+	}
+	else if (extension != "cdi" && extension != "cue")
+		return;
+	// Only read when the image is new or has been modified
+	if (!file.disc.parsed)
+		file.disc = readDiscInfo(item.path);
+	GameMedia game{ fileName, item.path, item.name, gameName };
+	game.disc = file.disc;
+	insert_game(game);
+}
+
+// Gets the directory content from the index if the directory hasn't been modified since it was indexed.
+// Changes to a file that don't update the directory modification time, such as a file replaced in place,
+// aren't detected until a manual rescan.
+// Returns false if the directory content can't be indexed.
+bool GameScanner::list_directory(const std::string& path, IndexedDirectory& dir)
+{
+	u64 updateTime = 0;
+	try {
+		updateTime = hostfs::storage().getFileInfo(path).updateTime;
+	} catch (const hostfs::StorageException& e) {
+	}
+	IndexedDirectory previous;
+	{
+		LockGuard _(indexMutex);
+		auto it = index.find(path);
+		if (it != index.end())
+		{
+			if (updateTime != 0 && it->second.updateTime == updateTime)
 			{
-				++empty_folders_scanned;
-				emptyParentPath = parentPath;
-				if (empty_folders_scanned > 1000)
-					content_path_looks_incorrect = true;
+				dir = it->second;
+				return true;
 			}
+			previous = it->second;
+		}
+	}
+	dir.updateTime = updateTime;
+	dir.entries.clear();
+	bool indexable = updateTime != 0;
+	std::unordered_map<std::string, const IndexedFile *> previousFiles;
+	for (const IndexedFile& file : previous.entries)
+		previousFiles[file.info.path] = &file;
+	for (hostfs::FileInfo& entry : hostfs::storage().listContent(path))
+	{
+		IndexedFile& file = dir.entries.emplace_back();
+		file.info = std::move(entry);
+		if (file.info.isDirectory || !indexable)
+			continue;
+		try {
+			hostfs::FileInfo info = hostfs::storage().getFileInfo(file.info.path);
+			file.info.size = info.size;
+			file.info.updateTime = info.updateTime;
+		} catch (const hostfs::StorageException& e) {
+			// the directory will be listed again next time
+			indexable = false;
+			continue;
+		}
+		// keep the disc metadata of unmodified files
+		auto it = previousFiles.find(file.info.path);
+		if (it != previousFiles.end() && it->second->info.size == file.info.size
+				&& it->second->info.updateTime == file.info.updateTime)
+			file.disc = it->second->disc;
+	}
+	return indexable;
+}
+
+void GameScanner::add_game_directory(const std::string& path, std::vector<std::string>& subdirs)
+{
+	bool hasFiles = false;
+	IndexedDirectory dir;
+	bool indexable = list_directory(path, dir);
+	for (IndexedFile& item : dir.entries)
+	{
+		if (!running)
+		{
+			indexable = false;
+			break;
+		}
+		if (item.info.isDirectory)
+		{
+			subdirs.push_back(item.info.path);
+		}
+		else
+		{
+			hasFiles = true;
+			add_game_file(item);
+		}
+	}
+	if (indexable)
+	{
+		LockGuard _(indexMutex);
+		newIndex[path] = std::move(dir);
+	}
+	if (hasFiles)
+	{
+		LockGuard _(mutex);
+		if (game_list.empty())
+		{
+			if (++empty_folders_scanned > 1000)
+				content_path_looks_incorrect = true;
 		}
 		else
 		{
 			content_path_looks_incorrect = false;
 		}
+	}
+}
 
-		if (item.name.substr(0, 2) == "._")
-			// Ignore Mac OS turds
-			continue;
-		std::string fileName(item.name);
-		std::string gameName(get_file_basename(item.name));
-		std::string extension = get_file_extension(item.name);
-		if (extension == "zip" || extension == "7z")
+// Walk the directory hierarchies using a pool of threads. Listing directories on network storage
+// is mostly latency-bound so several directories are listed concurrently.
+void GameScanner::scan_directories(const std::vector<std::string>& roots)
+{
+	std::deque<std::string> queue(roots.begin(), roots.end());
+	std::mutex queueMutex;
+	std::condition_variable cond;
+	int busy = 0;
+
+	const auto& worker = [&]() {
+		std::unique_lock<std::mutex> lock(queueMutex);
+		while (true)
 		{
-			string_tolower(gameName);
-			auto it = arcade_games.find(gameName);
-			if (it == arcade_games.end())
-				continue;
-			gameName = it->second->description;
-			fileName = fileName + " (" + gameName + ")";
-			insert_game(GameMedia{ fileName, item.path, item.name, gameName, true });
-			continue;
+			cond.wait(lock, [&]() {
+				return !queue.empty() || busy == 0;
+			});
+			if (queue.empty() || !running)
+				break;
+			std::string path = std::move(queue.front());
+			queue.pop_front();
+			busy++;
+			lock.unlock();
+
+			std::vector<std::string> subdirs;
+			try {
+				add_game_directory(path, subdirs);
+			} catch (const hostfs::StorageException& e) {
+				// ignore
+			}
+
+			lock.lock();
+			busy--;
+			if (running)
+				queue.insert(queue.end(), subdirs.begin(), subdirs.end());
+			cond.notify_all();
 		}
-		else if (extension == "bin" || extension == "lst" || extension == "dat")
+		// wake up the other workers
+		cond.notify_all();
+	};
+	const unsigned threadCount = std::clamp(std::thread::hardware_concurrency(), 2u, MAX_SCAN_THREADS);
+	std::vector<std::thread> threads;
+	for (unsigned i = 1; i < threadCount; i++)
+		threads.emplace_back([&worker]() {
+			ThreadName _("GameScanner");
+			worker();
+		});
+	worker();
+	for (auto& thread : threads)
+		thread.join();
+}
+
+void GameScanner::load_index()
+{
+	if (indexLoaded)
+		return;
+	indexLoaded = true;
+	std::string path = get_writable_data_path(INDEX_NAME);
+	FILE *f = nowide::fopen(path.c_str(), "rb");
+	if (f == nullptr)
+		return;
+	std::string data;
+	char buf[4096];
+	while (true)
+	{
+		size_t s = fread(buf, 1, sizeof(buf), f);
+		if (s == 0)
+			break;
+		data.append(buf, s);
+	}
+	fclose(f);
+	try {
+		json v = json::parse(data);
+		if (v.value("version", 0) != INDEX_VERSION)
 		{
-			if (!config::HideLegacyNaomiRoms)
-				insert_game(GameMedia{ fileName, item.path, item.name, gameName, true });
-			continue;
+			INFO_LOG(COMMON, "Game list index is out of date");
+			return;
 		}
-		else if (extension == "chd" || extension == "gdi")
+		LockGuard _(indexMutex);
+		for (const auto& dir : v.at("directories"))
 		{
-			// Hide arcade gdroms
-			std::string basename = gameName;
-			string_tolower(basename);
-			if (arcade_gdroms.count(basename) != 0)
-				continue;
+			IndexedDirectory& entry = index[dir.at("path").get<std::string>()];
+			entry.updateTime = dir.at("time").get<u64>();
+			for (const auto& file : dir.at("entries"))
+			{
+				IndexedFile& indexed = entry.entries.emplace_back();
+				indexed.info = hostfs::FileInfo(file.at("name").get<std::string>(), file.at("path").get<std::string>(),
+						file.at("dir").get<bool>(), file.at("size").get<size_t>(), false, file.at("time").get<u64>());
+				auto disc = file.find("disc");
+				if (disc != file.end())
+				{
+					indexed.disc.parsed = true;
+					indexed.disc.productNumber = disc->at("id").get<std::string>();
+					indexed.disc.softwareName = disc->at("name").get<std::string>();
+					indexed.disc.areaSymbols = disc->at("area").get<std::string>();
+				}
+			}
 		}
-		else if (extension != "cdi" && extension != "cue")
-			continue;
-		insert_game(GameMedia{ fileName, item.path, item.name, gameName });
+		DEBUG_LOG(COMMON, "Loaded game list index: %d directories", (int)index.size());
+	} catch (const json::exception& e) {
+		WARN_LOG(COMMON, "Corrupted game list index: %s", e.what());
+		index.clear();
 	}
 }
 
+void GameScanner::save_index()
+{
+	json dirs = json::array();
+	{
+		LockGuard _(indexMutex);
+		for (const auto& [path, dir] : index)
+		{
+			json entries = json::array();
+			for (const IndexedFile& file : dir.entries)
+			{
+				json entry = { { "name", file.info.name }, { "path", file.info.path }, { "dir", file.info.isDirectory },
+					{ "size", file.info.size }, { "time", file.info.updateTime } };
+				if (file.disc.parsed)
+					entry["disc"] = { { "id", file.disc.productNumber }, { "name", file.disc.softwareName },
+						{ "area", file.disc.areaSymbols } };
+				entries.push_back(entry);
+			}
+			dirs.push_back({ { "path", path }, { "time", dir.updateTime }, { "entries", entries } });
+		}
+	}
+	std::string path = get_writable_data_path(INDEX_NAME);
+	FILE *f = nowide::fopen(path.c_str(), "wb");
+	if (f == nullptr)
+	{
+		WARN_LOG(COMMON, "Can't save game list index to %s: error %d", path.c_str(), errno);
+		return;
+	}
+	json v = { { "version", INDEX_VERSION }, { "directories", dirs } };
+	std::string serialized = v.dump();
+	fwrite(serialized.c_str(), 1, serialized.size(), f);
+	fclose(f);
+}
+
 void GameScanner::stop()
 {
 	LockGuard _(threadMutex);
@@ -112,6 +389,19 @@ void GameScanner::stop()
 		scan_thread->join();
 }
 
+void GameScanner::rescan()
+{
+	stop();
+	{
+		LockGuard _(indexMutex);
+		index.clear();
+		// don't reload the saved index
+		indexLoaded = true;
+	}
+	nowide::remove(get_writable_data_path(INDEX_NAME).c_str());
+	scan_done = false;
+}
+
 void GameScanner::fetch_game_list()
 {
 	LockGuard _(threadMutex);
@@ -135,15 +425,29 @@ void GameScanner::fetch_game_list()
 				LockGuard _(mutex);
 				game_list.clear();
 			}
-			for (const auto& path : config::ContentPath.get())
+			load_index();
 			{
-				try {
-					add_game_directory(path);
-				} catch (const hostfs::StorageException& e) {
-					// ignore
+				LockGuard _(indexMutex);
+				newIndex.clear();
+			}
+			scan_directories(config::ContentPath.get());
+			if (running)
+			{
+				// Forget the directories that have been removed
+				{
+					LockGuard _(indexMutex);
+					index.swap(newIndex);
+					newIndex.clear();
 				}
-				if (!running)
-					break;
+				save_index();
+			}
+			else
+			{
+				// Keep what has been indexed so far
+				LockGuard _(indexMutex);
+				for (auto& [path, dir] : newIndex)
+					index[path] = std::move(dir);
+				newIndex.clear();
 			}
 			std::string dcbios = hostfs::findFlash("dc_", "%bios.bin;%boot.bin");
 			{
@@ -19,6 +19,7 @@
 #pragma once
 #include "types.h"
 #include "hw/naomi/naomi_roms.h"
+#include "oslib/storage.h"
 #include <vector>
 #include <mutex>
 #include <memory>
@@ -26,6 +27,19 @@
 #include <unordered_map>
 #include <unordered_set>
 
+struct ip_meta_t;
+
+// Disc image metadata read from IP.BIN
+struct DiscInfo
+{
+	bool parsed = false;		// IP.BIN has been read. The other fields are empty if it's invalid
+	std::string productNumber;
+	std::string softwareName;
+	std::string areaSymbols;	// 8 characters: J, U and E for Japan, USA and Europe. Empty if unspecified
+
+	void set(const ip_meta_t& meta);
+};
+
 struct GameMedia
 {
 	std::string name;		// Display name
@@ -34,6 +48,7 @@ struct GameMedia
 	std::string gameName;	// for arcade games only, description from the rom list
 	bool arcade = false;	// Arcade game (naomi, atomiswave, system sp, ...)
 	bool device = false;	// Corresponds to a physical cdrom device
+	DiscInfo disc;			// Dreamcast disc images only
 };
 
 class GameScanner
@@ -48,9 +63,36 @@ class GameScanner
 	std::unordered_set<std::string> arcade_gdroms;
 	using LockGuard = std::lock_guard<std::mutex>;
 
+	// Persistent index of the directory contents, keyed by path and modification time.
+	// Each file entry has its size and modification time, and the IP.BIN metadata of disc images,
+	// which is kept when the directory is listed again if the file hasn't changed.
+	struct IndexedFile
+	{
+		hostfs::FileInfo info;
+		DiscInfo disc;
+	};
+	struct IndexedDirectory
+	{
+		u64 updateTime = 0;
+		std::vector<IndexedFile> entries;
+	};
+	std::unordered_map<std::string, IndexedDirectory> index;
+	std::unordered_map<std::string, IndexedDirectory> newIndex;	// directories seen during the current scan
+	std::mutex indexMutex;
+	bool indexLoaded = false;
+
 	void insert_game(const GameMedia& game);
 	void insert_arcade_game(GameMedia game);
-	void add_game_directory(const std::string& path);
+	void add_game_file(IndexedFile& file);
+	void add_game_directory(const std::string& path, std::vector<std::string>& subdirs);
+	void scan_directories(const std::vector<std::string>& roots);
+	bool list_directory(const std::string& path, IndexedDirectory& dir);
+	void load_index();
+	void save_index();
+
+	static constexpr char const *INDEX_NAME = "flycast-gamelist.json";
+	static constexpr int INDEX_VERSION = 3;
+	static constexpr unsigned MAX_SCAN_THREADS = 8;
 
 public:
 	~GameScanner()
@@ -62,6 +104,8 @@ public:
 		stop();
 		scan_done = false;
 	}
+	// Discard the index and list all the content directories again
+	void rescan();
 
 	void stop();
 	void fetch_game_list();
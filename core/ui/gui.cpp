@@ -36,7 +36,9 @@
 #endif
 #include "boxart/boxart.h"
 #include "profiler/fc_profiler.h"
+#include "rend/TexCache.h"
 #include "hw/naomi/card_reader.h"
+#include "hw/naomi/gdcartridge.h"
 #include "oslib/resources.h"
 #include "achievements/achievements.h"
 #include "gui_achievements.h"
@@ -45,6 +47,7 @@
 #include "hw/pvr/Renderer_if.h"
 #include "hw/mem/addrspace.h"
 #include "hw/maple/maple_if.h"
+#include "hw/sh4/modules/mmu.h"
 #if defined(USE_SDL)
 #include "sdl/sdl.h"
 #include "sdl/dreamlink.h"
@@ -1523,6 +1526,27 @@ void gui_display_profiler()
 			fc_profiler::drawGUI(profileThread->cachedResultTree);
 			ImGui::Unindent();
 		}
+		const TextureCacheStats& texStats = textureCacheStats;
+		ImGui::Text("Textures: %u, host %.1f MB, GPU %.1f MB, hits %llu, misses %llu, evictions %llu",
+				texStats.count, texStats.hostBytes / 1024.f / 1024.f, texStats.gpuBytes / 1024.f / 1024.f,
+				(unsigned long long)texStats.hits, (unsigned long long)texStats.misses, (unsigned long long)texStats.evictions);
+#ifdef FAST_MMU
+		if (mmu_enabled())
+		{
+			const MmuCacheStats mmuStats = mmu_getCacheStats();
+			const u64 lookups = mmuStats.lastEntryHits + mmuStats.hits + mmuStats.misses;
+			ImGui::Text("MMU: last entry hits %llu, translation cache hits %llu, misses %llu (hit rate %.1f%%)",
+					(unsigned long long)mmuStats.lastEntryHits, (unsigned long long)mmuStats.hits, (unsigned long long)mmuStats.misses,
+					lookups == 0 ? 0.f : 100.f * (lookups - mmuStats.misses) / lookups);
+		}
+#endif
+		if (const GDCartridge *gdcart = dynamic_cast<GDCartridge *>(CurrentCartridge))
+		{
+			const GDSegmentStats segStats = gdcart->getSegmentStats();
+			ImGui::Text("GD-ROM segments: hits %llu, misses %llu, waits %llu, prefetched %llu, stall %.1f ms (max %.1f ms)",
+					(unsigned long long)segStats.hits, (unsigned long long)segStats.misses, (unsigned long long)segStats.waits,
+					(unsigned long long)segStats.prefetched, segStats.stallTimeUs / 1000.f, segStats.maxStallTimeUs / 1000.f);
+		}
 	}
 
 	for (const fc_profiler::ProfileThread* profileThread : fc_profiler::ProfileThread::s_allThreads)
@@ -32,6 +32,12 @@
 #include "sdl/dreamlink.h"
 #endif
 
+#if FC_PROFILER
+#include "profiler/fc_profiler.h"
+#include "oslib/oslib.h"
+#include "stdclass.h"
+#endif
+
 static void gui_settings_advanced()
 {
 #if FEAT_SHREC != DYNAREC_NONE
@@ -48,6 +54,12 @@ static void gui_settings_advanced()
 		OptionSlider("SH4 Clock", config::Sh4Clock, 100, 300,
 				"Over/Underclock the main SH4 CPU. Default is 200 MHz. Other values may crash, freeze or trigger unexpected nuclear reactions.",
 				"%d MHz");
+		OptionCheckbox("Persistent Block Cache", config::DynarecBlockCache,
+				"Save decoded SH4 blocks to disk and reuse them the next time the game is started to reduce stuttering");
+		OptionCheckbox("Background Decoding", config::DynarecAsyncDecode,
+				"Decode the next SH4 blocks on a separate thread before they are executed");
+		OptionCheckbox("Superblocks", config::DynarecSuperblocks,
+				"Recompile the most executed SH4 blocks across unconditional branches so that they can be optimized as a whole");
     }
 #ifdef GDB_SERVER
 	ImGui::Spacing();
@@ -115,6 +127,11 @@ static void gui_settings_advanced()
 			cfgSaveBool("log", "LogToFile", logToFile);
         ImGui::SameLine();
         ShowHelpMarker("Log debug information to flycast.log");
+        bool logAsync = cfgLoadBool("log", "Async", false);
+		if (ImGui::Checkbox("Asynchronous Logging", &logAsync))
+			cfgSaveBool("log", "Async", logAsync);
+        ImGui::SameLine();
+        ShowHelpMarker("Format and write log messages on a background thread. Messages may be dropped under heavy logging");
 #ifdef SENTRY_UPLOAD
         OptionCheckbox("Automatically Report Crashes", config::UploadCrashLogs,
         		"Automatically upload crash reports to sentry.io to help in troubleshooting. No personal information is included.");
@@ -181,6 +198,19 @@ static void gui_debug_tab()
 		}
 		OptionCheckbox("Display", config::ProfilerDrawToGUI, "Draw the profiler output in an overlay.");
 		OptionCheckbox("Output to terminal", config::ProfilerOutputTTY, "Write the profiler output to the terminal");
+		OptionCheckbox("Trace capture", config::ProfilerTrace,
+				"Record the last profiled events of each thread. The trace can be opened with chrome://tracing or ui.perfetto.dev");
+		{
+			DisabledScope scope(!config::ProfilerTrace);
+			if (ImGui::Button("Save Trace"))
+			{
+				const std::string path = get_writable_data_path("flycast-trace.json");
+				if (fc_profiler::trace::save(path))
+					os_notify("Trace saved", 2000, path.c_str());
+				else
+					gui_error("Can't save the trace to " + path);
+			}
+		}
 		// TODO frame warning time
 		if (!config::ProfilerEnabled)
 		{
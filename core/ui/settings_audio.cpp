@@ -25,6 +25,9 @@ void gui_settings_audio()
 	OptionCheckbox("Enable DSP", config::DSPEnabled,
 			"Enable the Dreamcast Digital Sound Processor. Only recommended on fast platforms");
     OptionCheckbox("Enable VMU Sounds", config::VmuSound, "Play VMU beeps when enabled.");
+	OptionCheckbox("Dynamic Rate Control", config::DynamicRateControl,
+			"Slightly resample the audio to keep the audio buffer half full instead of pacing the emulation on audio. "
+			"Use with VSync. Not supported by all audio drivers");
 
 	if (OptionSlider("Volume Level", config::AudioVolume, 0, 100, "Adjust the emulator's audio level", "%d%%"))
 	{
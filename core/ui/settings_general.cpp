@@ -134,7 +134,7 @@ void gui_settings_general()
         ImGui::SameLine();
 
         if (ImGui::Button("Rescan Content"))
-			scanner.refresh();
+			scanner.rescan();
         scrollWhenDraggingOnVoid();
 
 		ImGui::EndListBox();
@@ -199,7 +199,7 @@ void gui_settings_general()
     {
     	ImguiStyleVar _(ImGuiStyleVar_FramePadding, ScaledVec2(24, 3));
 		if (ImGui::Button("Rescan Content"))
-			scanner.refresh();
+			scanner.rescan();
     }
 #endif
 
@@ -230,6 +230,8 @@ void gui_settings_general()
 	if (OptionCheckbox("Hide Legacy Naomi Roms", config::HideLegacyNaomiRoms,
 			"Hide .bin, .dat and .lst files from the content browser"))
 		scanner.refresh();
+	OptionCheckbox("Cache Naomi ROMs", config::NaomiRomCache,
+			"Keep an uncompressed copy of Naomi and Atomiswave ROMs to speed up loading. Uses more disk space");
 #ifdef __ANDROID__
 	OptionCheckbox("Use SAF File Picker", config::UseSafFilePicker,
 			"Use Android Storage Access Framework file picker to select folders and files. Ignored on Android 10 and later.");
@@ -241,6 +243,8 @@ void gui_settings_general()
 	ImGui::SameLine();
 	OptionCheckbox("Save", config::AutoSaveState,
 			"Save the state of the game when stopping");
+	OptionCheckbox("Incremental Savestates", config::IncrementalSavestates,
+			"Only save what changed since the last full state. Makes frequent saves faster and smaller");
 	OptionCheckbox("Naomi Free Play", config::ForceFreePlay, "Configure Naomi games in Free Play mode.");
 #if USE_DISCORD
 	OptionCheckbox("Discord Presence", config::DiscordPresence, "Show which game you are playing on Discord");
@@ -0,0 +1,94 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "types.h"
+#include <cstring>
+#include <utility>
+
+namespace radix
+{
+
+struct Item
+{
+	u32 key;
+	u32 index;
+};
+
+//
+// Convert a float to an unsigned key that sorts in the same order.
+// -0 and +0 get the same key so that they compare equal like floats do.
+//
+static inline u32 floatKey(float f)
+{
+	u32 u;
+	memcpy(&u, &f, sizeof(u));
+	if (u == 0x80000000)
+		u = 0;
+	return (u & 0x80000000) ? ~u : (u | 0x80000000);
+}
+
+//
+// Stable LSD radix sort of items by key, using 3 passes of 11 bits.
+// temp must be able to hold count items. Returns the buffer holding the sorted items,
+// which is either items or temp.
+//
+static inline Item *sort(Item *items, Item *temp, size_t count)
+{
+	constexpr int Bits = 11;
+	constexpr int Passes = 3;
+	constexpr u32 Buckets = 1 << Bits;
+	constexpr u32 Mask = Buckets - 1;
+
+	if (count == 0)
+		return items;
+	u32 histograms[Passes][Buckets] {};
+	for (size_t i = 0; i < count; i++)
+	{
+		const u32 key = items[i].key;
+		histograms[0][key & Mask]++;
+		histograms[1][(key >> Bits) & Mask]++;
+		histograms[2][key >> (Bits * 2)]++;
+	}
+	Item *src = items;
+	Item *dst = temp;
+	for (int pass = 0; pass < Passes; pass++)
+	{
+		u32 *histogram = histograms[pass];
+		const int shift = pass * Bits;
+		// Nothing to do if all the items have the same digit
+		if (histogram[(src[0].key >> shift) & Mask] == count)
+			continue;
+		u32 offset = 0;
+		for (u32 b = 0; b < Buckets; b++)
+		{
+			u32 n = histogram[b];
+			histogram[b] = offset;
+			offset += n;
+		}
+		for (size_t i = 0; i < count; i++)
+		{
+			const u32 digit = (src[i].key >> shift) & Mask;
+			dst[histogram[digit]++] = src[i];
+		}
+		std::swap(src, dst);
+	}
+	return src;
+}
+
+}
@@ -0,0 +1,143 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "types.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+//
+// Lock-free single-producer single-consumer byte ring.
+// One thread may push while another thread pops. clear() must be called by the consumer,
+// or when the producer is idle.
+//
+class SpscRing
+{
+public:
+	// The capacity is rounded up to a power of 2
+	explicit SpscRing(size_t capacity)
+	{
+		size_t size = 1;
+		while (size < capacity)
+			size <<= 1;
+		mask = size - 1;
+		buffer = std::make_unique<u8[]>(size);
+	}
+
+	size_t capacity() const {
+		return mask + 1;
+	}
+
+	// Free space. Must be called by the producer.
+	size_t available() const {
+		return capacity() - (writeIndex.load(std::memory_order_relaxed) - readIndex.load(std::memory_order_acquire));
+	}
+
+	// Push as many bytes as possible without blocking. Returns the number of bytes pushed.
+	size_t tryPush(const u8 *data, size_t len)
+	{
+		const size_t tail = writeIndex.load(std::memory_order_relaxed);
+		len = std::min(len, capacity() - (tail - readIndex.load(std::memory_order_acquire)));
+		copyIn(tail, data, len);
+		writeIndex.store(tail + len, std::memory_order_release);
+		return len;
+	}
+
+	bool tryPush(u8 b) {
+		return tryPush(&b, 1) == 1;
+	}
+
+	// Push all the bytes, waiting for the consumer if the ring is full
+	void push(const u8 *data, size_t len)
+	{
+		while (true)
+		{
+			size_t count = tryPush(data, len);
+			data += count;
+			len -= count;
+			if (len == 0)
+				break;
+			std::this_thread::yield();
+		}
+	}
+
+	// Pop up to len bytes without blocking. Returns the number of bytes popped.
+	size_t tryPop(u8 *data, size_t len)
+	{
+		const size_t head = readIndex.load(std::memory_order_relaxed);
+		len = std::min(len, writeIndex.load(std::memory_order_acquire) - head);
+		copyOut(head, data, len);
+		readIndex.store(head + len, std::memory_order_release);
+		return len;
+	}
+
+	bool tryPop(u8& b) {
+		return tryPop(&b, 1) == 1;
+	}
+
+	// Pop len bytes, waiting for the producer if the ring is empty
+	void pop(u8 *data, size_t len)
+	{
+		while (true)
+		{
+			size_t count = tryPop(data, len);
+			data += count;
+			len -= count;
+			if (len == 0)
+				break;
+			std::this_thread::yield();
+		}
+	}
+
+	size_t size() const {
+		return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire);
+	}
+	bool empty() const {
+		return size() == 0;
+	}
+
+	void clear() {
+		readIndex.store(writeIndex.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+private:
+	void copyIn(size_t index, const u8 *data, size_t len)
+	{
+		index &= mask;
+		size_t first = std::min(len, capacity() - index);
+		memcpy(&buffer[index], data, first);
+		memcpy(&buffer[0], data + first, len - first);
+	}
+
+	void copyOut(size_t index, u8 *data, size_t len) const
+	{
+		index &= mask;
+		size_t first = std::min(len, capacity() - index);
+		memcpy(data, &buffer[index], first);
+		memcpy(data + first, &buffer[0], len - first);
+	}
+
+	std::unique_ptr<u8[]> buffer;
+	size_t mask;
+	// Free-running indexes, on separate cache lines to avoid false sharing
+	alignas(64) std::atomic<size_t> writeIndex { 0 };
+	alignas(64) std::atomic<size_t> readIndex { 0 };
+};
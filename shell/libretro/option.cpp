@@ -24,6 +24,8 @@ namespace config {
 // Dynarec
 
 Option<bool> DynarecEnabled("", true);
+Option<bool> DynarecBlockCache("");
+Option<bool> DynarecAsyncDecode("");
 IntOption Sh4Clock(CORE_OPTION_NAME "_sh4clock", 200);
 
 // General
@@ -34,6 +36,7 @@ Option<int> Broadcast(CORE_OPTION_NAME "_broadcast", 0);	// NTSC
 Option<int> Language(CORE_OPTION_NAME "_language", 1);		// English
 Option<bool> AutoLoadState("");
 Option<bool> AutoSaveState("");
+Option<bool> IncrementalSavestates("");
 Option<int, false> SavestateSlot("");
 Option<bool> ForceFreePlay(CORE_OPTION_NAME "_force_freeplay", true);
 
@@ -46,6 +49,7 @@ Option<int> AudioBufferSize("", 5644);	// 128 ms
 Option<int> AudioBufferSize("", 2822);	// 64 ms
 #endif
 Option<bool> AutoLatency("");
+Option<int> AudioBatchSamples("", 1);
 
 OptionString AudioBackend("", "auto");
 Option<bool> VmuSound(CORE_OPTION_NAME "_vmu_sound", false);
@@ -86,10 +90,12 @@ Option<bool> IntegerScale("");
 Option<bool> LinearInterpolation("", true);
 Option<bool> VSync("", true);
 Option<bool> ThreadedRendering(CORE_OPTION_NAME "_threaded_rendering", true);
+Option<bool> ParseAhead("", true);
 Option<int> AnisotropicFiltering(CORE_OPTION_NAME "_anisotropic_filtering");
 Option<int> TextureFiltering(CORE_OPTION_NAME "_texture_filtering");
 Option<bool> PowerVR2Filter(CORE_OPTION_NAME "_pvr2_filtering");
 Option<int64_t> PixelBufferSize("", 512_MB);
+Option<int> TextureCacheSize("", 512);
 IntOption PerPixelLayers(CORE_OPTION_NAME "_oit_layers");
 Option<bool> NativeDepthInterpolation(CORE_OPTION_NAME "_native_depth_interpolation");
 Option<bool> EmulateFramebuffer(CORE_OPTION_NAME "_emulate_framebuffer", false);
@@ -103,10 +109,13 @@ Option<bool> UseReios(CORE_OPTION_NAME "_hle_bios");
 
 Option<bool> OpenGlChecks("", false);
 Option<bool> FastGDRomLoad(CORE_OPTION_NAME "_gdrom_fast_loading", false);
+Option<int> ChdCacheSize("", 16);
+Option<int> ChdReadAhead("", 4);
 Option<bool> RamMod32MB(CORE_OPTION_NAME "_dc_32mb_mod", false);
 
 //Option<std::vector<std::string>, false> ContentPath("");
 //Option<bool, false> HideLegacyNaomiRoms("", true);
+Option<bool, false> NaomiRomCache("", false);
 
 // Network
 
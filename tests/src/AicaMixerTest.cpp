@@ -0,0 +1,316 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "types.h"
+#include "emulator.h"
+#include "audio/audiostream.h"
+#include "cfg/option.h"
+#include "hw/mem/addrspace.h"
+#include "hw/aica/aica_if.h"
+#include "hw/aica/aica_mem.h"
+#include "hw/aica/sgc_if.h"
+#include <xxhash.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace aica;
+
+class CaptureAudioBackend : public AudioBackend
+{
+public:
+	CaptureAudioBackend() : AudioBackend("capture", "Capture") {}
+
+	bool init() override { return true; }
+
+	u32 push(const void *data, u32 frames, bool wait) override
+	{
+		const s16 *p = (const s16 *)data;
+		samples.insert(samples.end(), p, p + frames * 2);
+		return frames;
+	}
+
+	std::vector<s16> samples;
+};
+static CaptureAudioBackend captureBackend;
+
+// Output of the original implementation (FPMul and ChannelEx::Step, one sample at a time),
+// hashed with XXH3_64bits by segments of 2048 stereo frames.
+constexpr size_t GoldenSegmentSize = 2048 * 2;
+// Indexed by DSP enabled and seed
+static const u64 StreamGolden[2][4][4] {
+	{
+		{ 0x942a31bda5d95aa8ull, 0x00209c53d7c212deull, 0xead8fdbde512216full, 0x856716953c3df152ull },
+		{ 0x4869442af08e10a7ull, 0x9dc688fea5d43766ull, 0xb1e5dc7d91868dbeull, 0xa11c08ecd07c852full },
+		{ 0x76bdb4c05ce1d702ull, 0xc56cf1c851790c58ull, 0xba183871027af2f3ull, 0x6b6a5ee4dbe94ee8ull },
+		{ 0x4b0e4f68da6d21b4ull, 0xbf467546f7903e5dull, 0xa1e3d7072b792cc9ull, 0xc29e79c50fcebf3cull },
+	},
+	{
+		{ 0xb92dd88ab74ec49bull, 0xc54b6fd0c7e21fe0ull, 0x212ddb2c207df25bull, 0x5ec5408219c1bee5ull },
+		{ 0x5970c98da80d79cbull, 0x388acafeecbf0368ull, 0xb1e5dc7d91868dbeull, 0xa11c08ecd07c852full },
+		{ 0x76bdb4c05ce1d702ull, 0xc56cf1c851790c58ull, 0xba183871027af2f3ull, 0x6b6a5ee4dbe94ee8ull },
+		{ 0x4b0e4f68da6d21b4ull, 0xbf467546f7903e5dull, 0xa1e3d7072b792cc9ull, 0xc29e79c50fcebf3cull },
+	},
+};
+// Same with the DSP enabled or disabled: no channel has its direct output muted
+static const u64 SongGolden[12] {
+	0xcd36f9b5f1fb6995ull, 0x1cd3c5a088127c61ull, 0xd2463857e48fd437ull, 0xfb11f7bfdcd274cfull,
+	0x56889afd3ddcd13bull, 0xc15dadf167bb34c4ull, 0xd13577b4feb0755dull, 0x370b3582181e7e0cull,
+	0x83fa14ff6d534151ull, 0xf8002cb86f4a1566ull, 0xde1b1911ac15f46dull, 0x11f8d1217c15cfd9ull,
+};
+
+class AicaMixerTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		emu.init();
+		config::AudioBackend.override("capture");
+		InitAudio();
+	}
+
+	void TearDown() override
+	{
+		TermAudio();
+		config::AudioBackend.reset();
+		config::DSPEnabled.reset();
+		sgc::mixFastPath = true;
+	}
+
+	void reset()
+	{
+		emu.dc_reset(true);
+		// empty the audio buffer
+		EventManager::event(Event::LoadState);
+	}
+
+	template<size_t Size>
+	void checkGolden(const std::vector<s16>& output, const u64 (&golden)[Size])
+	{
+		ASSERT_EQ(Size * GoldenSegmentSize, output.size());
+		for (size_t i = 0; i < Size; i++)
+			ASSERT_EQ(golden[i], XXH3_64bits(&output[i * GoldenSegmentSize], GoldenSegmentSize * sizeof(s16)))
+				<< "segment " << i;
+	}
+
+	// Play a pseudo-random stream of channel register writes with key on/off events
+	// and return the audio output.
+	std::vector<s16> play(u32 seed, u32 batchSize)
+	{
+		reset();
+		std::mt19937 rng(seed);
+		for (u32 i = 0; i < 1_MB; i++)
+			aica_ram[i] = (u8)rng();
+		writeRegInternal<u16>(0x2800, 0xf);	// MVOL
+
+		captureBackend.samples.clear();
+		constexpr u32 Steps = 128;
+		constexpr u32 SamplesPerStep = 64;
+		for (u32 step = 0; step < Steps; step++)
+		{
+			const u32 channelCount = 1 + rng() % 4;
+			for (u32 i = 0; i < channelCount; i++)
+			{
+				const u32 base = (rng() % 64) * 0x80;
+				if (rng() % 4 == 0)
+				{
+					// key off
+					writeRegInternal<u16>(base, 0x8000);
+					continue;
+				}
+				for (u32 reg = 0x04; reg <= 0x40; reg += 4)
+					writeRegInternal<u16>(base + reg, (u16)rng());
+				writeRegInternal<u16>(base + 0x0c, 0x100 + rng() % 0x4000);	// LEA
+				writeRegInternal<u16>(base + 0x10, 0x1f | ((rng() % 32) << 6) | ((rng() % 32) << 11));	// AR D1R D2R
+				writeRegInternal<u16>(base + 0x24, 0xf00 | (rng() % 32));	// DISDL DIPAN
+				writeRegInternal<u16>(base + 0x28, ((rng() % 64) << 8) | (rng() % 128));	// TL LPOFF Q
+				// SA, PCMS, LPCTL, key on
+				writeRegInternal<u16>(base, 0xc000 | (rng() & 0x0380) | (rng() % 16));
+			}
+			for (u32 i = 0; i < SamplesPerStep; i += batchSize)
+				sgc::AICA_Sample(batchSize);
+		}
+		return captureBackend.samples;
+	}
+
+	// Play notes on 16 voices like a sequencer would: looped waveforms with pitch, envelopes,
+	// panning, LFOs and DSP sends, and voices are keyed off and on again while others play.
+	std::vector<s16> playSong(u32 batchSize)
+	{
+		reset();
+		// 16-bit sine and 8-bit sawtooth waves, 256 samples each
+		constexpr u32 Sine = 0x10000;
+		constexpr u32 Saw = 0x10400;
+		for (u32 i = 0; i < 256; i++)
+		{
+			*(s16 *)&aica_ram[Sine + i * 2] = (s16)(std::sin(i * 2 * M_PI / 256) * 24000);
+			aica_ram[Saw + i] = (u8)(i - 128);
+		}
+		writeRegInternal<u16>(0x2800, 0xf);	// MVOL
+
+		captureBackend.samples.clear();
+		constexpr u32 Voices = 16;
+		constexpr u32 Ticks = 192;
+		constexpr u32 SamplesPerTick = 128;
+		constexpr u16 Scale[] { 0x000, 0x0f6, 0x1fa, 0x26e, 0x36c, 0x487, 0x5b2 };
+		for (u32 tick = 0; tick < Ticks; tick++)
+		{
+			for (u32 voice = 0; voice < Voices; voice++)
+			{
+				const u32 base = voice * 0x80 * 3;	// every third channel
+				const u32 period = 4 + voice % 5;
+				if ((tick + voice) % period == period - 1)
+				{
+					// key off: the release phase plays on
+					writeRegInternal<u16>(base, 0x8000);
+					continue;
+				}
+				if ((tick + voice) % period != 0)
+					continue;
+				const u32 note = (tick / period + voice) % 7;
+				const bool sine = voice % 2 == 0;
+				const u32 sa = sine ? Sine : Saw;
+				writeRegInternal<u16>(base + 0x04, sa & 0xffff);
+				writeRegInternal<u16>(base + 0x08, 0);	// LSA
+				writeRegInternal<u16>(base + 0x0c, 256);	// LEA
+				writeRegInternal<u16>(base + 0x10, 0x1f | (10 << 6) | (4 << 11));	// AR D1R D2R
+				writeRegInternal<u16>(base + 0x14, 14 | (8 << 5));	// RR DL
+				writeRegInternal<u16>(base + 0x18, ((((voice % 3) - 1) & 0xf) << 11) | Scale[note]);	// OCT FNS
+				// vibrato and tremolo on some voices
+				writeRegInternal<u16>(base + 0x1c, voice % 4 == 1 ? (12 << 10) | (2 << 8) | (3 << 5) | (1 << 3) | 2 : 0);
+				writeRegInternal<u16>(base + 0x20, (voice % 4) | ((voice % 3 == 0 ? 0 : 0xb) << 4));	// ISEL IMXL
+				writeRegInternal<u16>(base + 0x24, ((voice % 5 == 4 ? 0 : 0xd) << 8) | ((voice * 5) % 32));	// DISDL DIPAN
+				writeRegInternal<u16>(base + 0x28, (voice * 4) << 8 | (voice % 2 ? 0x20 : 4));	// TL LPOFF Q
+				// SA, PCMS, LPCTL, key on
+				writeRegInternal<u16>(base, 0xc000 | (1 << 9) | ((sine ? 0 : 1) << 7) | (sa >> 16));
+			}
+			for (u32 i = 0; i < SamplesPerTick; i += batchSize)
+				sgc::AICA_Sample(batchSize);
+		}
+		return captureBackend.samples;
+	}
+};
+
+TEST_F(AicaMixerTest, MixChannel)
+{
+	std::mt19937 rng(3);
+	constexpr u32 Count = sgc::MaxBatchSamples;
+	sgc::SampleType samples[Count];
+	s32 left[Count], right[Count], dsp[Count];
+	for (int round = 0; round < 200; round++)
+	{
+		const u32 count = rng() % (Count + 1);
+		for (u32 i = 0; i < Count; i++)
+		{
+			samples[i] = (s16)rng();
+			// muted channels are common
+			left[i] = rng() % 4 == 0 ? 0 : rng() % 0x8000;
+			right[i] = rng() % 4 == 0 ? 0 : rng() % 0x8000;
+			dsp[i] = rng() % 0x8000;
+		}
+		for (bool dspEnabled : { false, true })
+		{
+			sgc::SampleType refl[Count] {}, refr[Count] {}, refs[Count] {};
+			sgc::mixFastPath = false;
+			sgc::mixChannel(samples, left, right, dsp, count, refl, refr, refs, dspEnabled);
+			sgc::SampleType mixl[Count] {}, mixr[Count] {}, mixs[Count] {};
+			sgc::mixFastPath = true;
+			sgc::mixChannel(samples, left, right, dsp, count, mixl, mixr, mixs, dspEnabled);
+			for (u32 i = 0; i < Count; i++)
+			{
+				ASSERT_EQ(refl[i], mixl[i]) << i;
+				ASSERT_EQ(refr[i], mixr[i]) << i;
+				ASSERT_EQ(refs[i], mixs[i]) << i;
+			}
+		}
+	}
+}
+
+// Random register streams, one sample at a time and batched, with the scalar and SIMD mixers
+TEST_F(AicaMixerTest, RegisterStream)
+{
+	for (bool dspEnabled : { false, true })
+	{
+		config::DSPEnabled = dspEnabled;
+		for (u32 seed = 1; seed <= 4; seed++)
+			for (bool fastPath : { false, true })
+				for (u32 batchSize : { 1u, (u32)sgc::MaxBatchSamples })
+				{
+					SCOPED_TRACE("seed " + std::to_string(seed) + " dsp " + std::to_string(dspEnabled)
+							+ " fast " + std::to_string(fastPath) + " batch " + std::to_string(batchSize));
+					sgc::mixFastPath = fastPath;
+					checkGolden(play(seed, batchSize), StreamGolden[dspEnabled][seed - 1]);
+				}
+	}
+}
+
+// Structured note sequences
+TEST_F(AicaMixerTest, Song)
+{
+	for (bool dspEnabled : { false, true })
+	{
+		config::DSPEnabled = dspEnabled;
+		for (bool fastPath : { false, true })
+			for (u32 batchSize : { 1u, 8u, (u32)sgc::MaxBatchSamples })
+			{
+				SCOPED_TRACE("dsp " + std::to_string(dspEnabled) + " fast " + std::to_string(fastPath)
+						+ " batch " + std::to_string(batchSize));
+				sgc::mixFastPath = fastPath;
+				std::vector<s16> output = playSong(batchSize);
+				ASSERT_TRUE(std::any_of(output.begin(), output.end(), [](s16 s) { return s != 0; }));
+				checkGolden(output, SongGolden);
+			}
+	}
+}
+
+TEST_F(AicaMixerTest, MixChannels)
+{
+	std::mt19937 rng(5);
+	constexpr u32 Count = 64;
+	sgc::SampleType samples[Count];
+	s32 left[Count], right[Count], dsp[Count];
+	u32 isel[Count];
+	for (int round = 0; round < 200; round++)
+	{
+		const u32 count = rng() % (Count + 1);
+		for (u32 i = 0; i < Count; i++)
+		{
+			samples[i] = (s16)rng();
+			left[i] = rng() % 4 == 0 ? 0 : rng() % 0x8000;
+			right[i] = rng() % 4 == 0 ? 0 : rng() % 0x8000;
+			dsp[i] = rng() % 0x8000;
+			isel[i] = rng() % 16;
+		}
+		for (bool dspEnabled : { false, true })
+		{
+			// same as mixing each channel separately
+			sgc::SampleType refl {}, refr {}, refs[16] {};
+			for (u32 i = 0; i < count; i++)
+				sgc::mixChannel(&samples[i], &left[i], &right[i], &dsp[i], 1, &refl, &refr, &refs[isel[i]], dspEnabled);
+			sgc::SampleType mixl {}, mixr {}, mixs[16] {};
+			sgc::mixChannels(samples, left, right, dsp, isel, count, mixl, mixr, mixs, dspEnabled);
+			ASSERT_EQ(refl, mixl);
+			ASSERT_EQ(refr, mixr);
+			for (int i = 0; i < 16; i++)
+				ASSERT_EQ(refs[i], mixs[i]) << i;
+		}
+	}
+}
@@ -0,0 +1,119 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "log/AsyncLog.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Compares the deferred formatting with snprintf
+#define ASSERT_FORMAT(...) { \
+	char expected[1024]; \
+	char actual[1024]; \
+	snprintf(expected, sizeof(expected), __VA_ARGS__); \
+	ASSERT_TRUE(AsyncLogger::FormatDeferred(actual, sizeof(actual), __VA_ARGS__)); \
+	ASSERT_STREQ(expected, actual); \
+}
+
+TEST(AsyncLogTest, Integers)
+{
+	ASSERT_FORMAT("no conversion");
+	ASSERT_FORMAT("%d %i %u", -42, 17, 3000000000u);
+	ASSERT_FORMAT("%5d|%-5d|%05d|%+d|% d", 42, -42, 42, 42, 42);
+	ASSERT_FORMAT("%x %X %#x %o %#o %08X", 0xbeefu, 0xbeefu, 0xbeefu, 8u, 8u, 0xcafeu);
+	ASSERT_FORMAT("%.4d|%8.3d|%.0d", 7, -7, 0);
+}
+
+TEST(AsyncLogTest, LengthModifiers)
+{
+	ASSERT_FORMAT("%hhd %hd %ld %lld", (signed char)-100, (short)-30000, -2000000000L, -9000000000000000000LL);
+	ASSERT_FORMAT("%hhu %hu %lu %llu", (unsigned char)200, (unsigned short)60000, 4000000000UL, 18000000000000000000ULL);
+	ASSERT_FORMAT("%hhx %hx", 0x1ff, 0x1ffff);
+	ASSERT_FORMAT("%jd %ju", (intmax_t)-123456789012LL, (uintmax_t)123456789012ULL);
+	ASSERT_FORMAT("%zu %zd %zx", (size_t)-1, (ptrdiff_t)-5, (size_t)0x1234);
+	ASSERT_FORMAT("%td %tx", (ptrdiff_t)-5, (ptrdiff_t)0x100);
+}
+
+TEST(AsyncLogTest, FloatingPoint)
+{
+	ASSERT_FORMAT("%f %e %g %a", 3.14159, -1.5e-10, 1e20, 0.5);
+	ASSERT_FORMAT("%.3f|%10.2e|%-8.1f|%+.0f|%#g", 2.71828, 12345.678, 1.25, 2.5, 1.0);
+	ASSERT_FORMAT("%F %E %G %A", 1.5, 1.5, 1.5e-5, 1.5);
+}
+
+TEST(AsyncLogTest, Star)
+{
+	ASSERT_FORMAT("%*d|%-*d|%*d", 6, 42, 6, 42, -6, 42);
+	ASSERT_FORMAT("%.*f|%*.*f", 2, 3.14159, 10, 4, 3.14159);
+	ASSERT_FORMAT("%.*f", -1, 3.14159);
+	ASSERT_FORMAT("%*.*s|", 8, 3, "abcdef");
+	ASSERT_FORMAT("%.*s|%.*s", 2, "abcdef", -1, "abcdef");
+}
+
+TEST(AsyncLogTest, Strings)
+{
+	ASSERT_FORMAT("%s|%10s|%-10s|%.3s|%.10s", "hello", "hello", "hello", "hello", "hello");
+	ASSERT_FORMAT("%s%s", "", "x");
+	ASSERT_FORMAT("%c%c%5c|%-3c|", 'a', 'b', 'c', 'd');
+	ASSERT_FORMAT("%s=%d", "key", 42);
+}
+
+TEST(AsyncLogTest, Percent)
+{
+	ASSERT_FORMAT("%%");
+	ASSERT_FORMAT("100%% %d%%", 50);
+	ASSERT_FORMAT("%%d %s", "x");
+}
+
+TEST(AsyncLogTest, Pointer)
+{
+	int i;
+	ASSERT_FORMAT("%p", (void *)&i);
+	ASSERT_FORMAT("%p", (void *)nullptr);
+}
+
+TEST(AsyncLogTest, StringTruncation)
+{
+	// Strings are truncated to fit in the record
+	std::string s(2000, 'x');
+	char out[1024];
+	ASSERT_TRUE(AsyncLogger::FormatDeferred(out, sizeof(out), "%d %s", 1, s.c_str()));
+	size_t len = strlen(out);
+	ASSERT_GT(len, 400u);
+	ASSERT_LT(len, 600u);
+	ASSERT_EQ(std::string("1 ") + s.substr(0, len - 2), std::string(out));
+
+	// Precision limits the string length that is read
+	char buf[4] = { 'a', 'b', 'c', 'd' };	// not null-terminated
+	ASSERT_TRUE(AsyncLogger::FormatDeferred(out, sizeof(out), "%.4s|", buf));
+	ASSERT_STREQ("abcd|", out);
+
+	// Output buffer
+	ASSERT_TRUE(AsyncLogger::FormatDeferred(out, 8, "%s %d", "hello", 12345));
+	ASSERT_STREQ("hello 1", out);
+}
+
+TEST(AsyncLogTest, Unsupported)
+{
+	char out[64];
+	ASSERT_FALSE(AsyncLogger::FormatDeferred(out, sizeof(out), "%Lf", (long double)1.0));
+	ASSERT_FALSE(AsyncLogger::FormatDeferred(out, sizeof(out), "%ls", L"wide"));
+	ASSERT_FALSE(AsyncLogger::FormatDeferred(out, sizeof(out), "%lc", (wint_t)L'w'));
+}
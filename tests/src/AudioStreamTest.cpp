@@ -0,0 +1,161 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "types.h"
+#include "audio/audiostream.h"
+#include "cfg/option.h"
+#include <cmath>
+
+static u64 fakeTime;
+static u64 fakeClock() {
+	return fakeTime;
+}
+
+class AudioStreamTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		savedClock = nullAudioClock;
+		nullAudioClock = fakeClock;
+		fakeTime = 1'000'000;
+		config::AudioBackend.override("null");
+		config::DynamicRateControl.override(true);
+		config::AudioBufferSize.override(2822);
+		InitAudio();
+		backend = AudioBackend::getBackend("null");
+		ASSERT_NE(nullptr, backend);
+	}
+
+	void TearDown() override
+	{
+		TermAudio();
+		config::AudioBackend.reset();
+		config::DynamicRateControl.reset();
+		config::AudioBufferSize.reset();
+		nullAudioClock = savedClock;
+	}
+
+	struct Result
+	{
+		u32 underruns;
+		u32 overruns;
+		float drift;	// average distance from half-full buffer in ms
+	};
+
+	// Emulate a game running at gameRate with the emulation paced by a display refreshing at hostRate.
+	Result play(double gameRate, double hostRate, int seconds)
+	{
+		const double samplesPerFrame = 44100.0 / gameRate;
+		const double frameTime = 1'000'000.0 / hostRate;
+		const int frames = (int)(hostRate * seconds);
+		const int settleFrames = (int)hostRate * 10;
+		double samples = 0;
+		double time = (double)fakeTime;
+		Result result {};
+		double driftSum = 0;
+		for (int frame = 0; frame < frames; frame++)
+		{
+			samples += samplesPerFrame;
+			for (; samples >= 1.0; samples -= 1.0)
+				WriteSample((s16)(frame * 64), (s16)(-frame * 64));
+			time += frameTime;
+			fakeTime = (u64)time;
+
+			AudioBackend::BufferStatus status;
+			EXPECT_TRUE(backend->getBufferStatus(status));
+			if (frame >= settleFrames)
+				driftSum += std::abs((double)status.queued - status.capacity / 2.0) * 1000.0 / 44100.0;
+			result.underruns = status.underruns;
+			result.overruns = status.overruns;
+		}
+		result.drift = (float)(driftSum / (frames - settleFrames));
+		return result;
+	}
+
+	AudioBackend *backend = nullptr;
+	u64 (*savedClock)() = nullptr;
+};
+
+TEST_F(AudioStreamTest, NtscOn60Hz)
+{
+	Result result = play(59.94, 60.0, 300);
+	ASSERT_EQ(0u, result.underruns);
+	ASSERT_EQ(0u, result.overruns);
+	ASSERT_LT(result.drift, 32.f);	// half the default buffer size
+}
+
+TEST_F(AudioStreamTest, Game60HzOnNtsc)
+{
+	Result result = play(60.0, 59.94, 300);
+	ASSERT_EQ(0u, result.underruns);
+	ASSERT_EQ(0u, result.overruns);
+	ASSERT_LT(result.drift, 32.f);	// half the default buffer size
+}
+
+TEST_F(AudioStreamTest, Pal)
+{
+	Result result = play(50.0, 50.0, 300);
+	ASSERT_EQ(0u, result.underruns);
+	ASSERT_EQ(0u, result.overruns);
+	ASSERT_LT(result.drift, 32.f);	// half the default buffer size
+}
+
+// Backend buffer stuck empty or full
+class StuckAudioBackend : public AudioBackend
+{
+public:
+	StuckAudioBackend() : AudioBackend("stuck", "Stuck") {}
+
+	bool init() override { return true; }
+	u32 push(const void *data, u32 frames, bool wait) override { return frames; }
+
+	bool getBufferStatus(BufferStatus& status) override
+	{
+		status = {};
+		status.capacity = 4096;
+		status.queued = full ? status.capacity : 0;
+		return true;
+	}
+
+	bool full = false;
+};
+static StuckAudioBackend stuckBackend;
+
+TEST_F(AudioStreamTest, RatioBounds)
+{
+	for (bool full : { false, true })
+	{
+		stuckBackend.full = full;
+		DynamicRateResampler resampler;
+		resampler.init(&stuckBackend);
+		static const s16 frames[SAMPLE_COUNT * 2] {};
+		// long enough for the integral term to saturate
+		for (int i = 0; i < 2000; i++)
+		{
+			resampler.write(frames, SAMPLE_COUNT);
+			ASSERT_LE(resampler.getRatio(), 1.f + DynamicRateResampler::MaxDeviation);
+			ASSERT_GE(resampler.getRatio(), 1.f - DynamicRateResampler::MaxDeviation);
+		}
+		if (full)
+			ASSERT_EQ(1.f + DynamicRateResampler::MaxDeviation, resampler.getRatio());
+		else
+			ASSERT_EQ(1.f - DynamicRateResampler::MaxDeviation, resampler.getRatio());
+	}
+}
@@ -0,0 +1,276 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "types.h"
+
+#if FEAT_SHREC != DYNAREC_NONE
+#include "gtest/gtest.h"
+#include "emulator.h"
+#include "cfg/option.h"
+#include "hw/mem/addrspace.h"
+#include "hw/sh4/sh4_core.h"
+#include "hw/sh4/sh4_mem.h"
+#include "hw/sh4/dyna/blockcache.h"
+#include "hw/sh4/dyna/blockmanager.h"
+#include "stdclass.h"
+#include <nowide/cstdio.hpp>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+class BlockCacheTest : public ::testing::Test
+{
+protected:
+	static constexpr u32 BaseAddr = 0x8c010000;
+	// offsets in the cache file, see blockcache.cpp
+	static constexpr long BuildHashOffset = 8;
+	static constexpr long FirstEntryOffset = 32;
+	static constexpr long FirstCodeSizeOffset = FirstEntryOffset + 16;
+	static constexpr long FirstOpOffset = FirstEntryOffset + 16 + 24 + 1 + 8;
+
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		config::DynarecBlockCache.override(true);
+		emu.init();
+		mem_map_default();
+		emu.dc_reset(true);
+		Sh4cntx.sr.FD = 0;
+		settings.content.gameId = "BLOCKCACHE-TEST";
+		cachePath = get_writable_data_path("BLOCKCACHE-TEST.sh4cache");
+		nowide::remove(cachePath.c_str());
+		blockcache::load();
+	}
+
+	void TearDown() override
+	{
+		blockcache::clear();
+		nowide::remove(cachePath.c_str());
+		settings.content.gameId.clear();
+		config::DynarecBlockCache.reset();
+	}
+
+	void writeCode(u32 addr, std::initializer_list<u16> ops)
+	{
+		for (u16 op : ops)
+		{
+			addrspace::write16(addr, op);
+			addr += 2;
+		}
+	}
+
+	void writeTestCode()
+	{
+		writeCode(BaseAddr, {
+			0xE105,		// mov #5, r1
+			0x6243,		// mov r4, r2
+			0x321C,		// add r1, r2
+			0x6322,		// mov.l @r2, r3
+			0x2432,		// mov.l r3, @r4
+			0x4108,		// shll2 r1
+			0xF12C,		// fmov fr2, fr1
+			0xF10E,		// fmac fr0, fr0, fr1
+			0x3130,		// cmp/eq r3, r1
+			0x8B02,		// bf 1a
+			0x000B,		// rts
+			0x7101,		// add #1, r1
+			0x0009,		// nop
+			0x0009,		// 1a: nop
+		});
+		writeCode(BaseAddr + 0x100, {
+			0xF548,		// fmov.s @r4, fr5
+			0xF420,		// fadd dr2, dr4
+			0xF45D,		// fabs dr4
+			0xF45A,		// fmov.s fr5, @r4
+			0xAF7A,		// bra BaseAddr
+			0x0009,		// nop
+		});
+	}
+
+	std::unique_ptr<RuntimeBlockInfo> setupBlock(u32 addr, bool doublePrecision = false)
+	{
+		std::unique_ptr<RuntimeBlockInfo> block(new RuntimeBlockInfo());
+		fpscr_t fpscr = Sh4cntx.fpscr;
+		fpscr.PR = doublePrecision;
+		EXPECT_TRUE(block->Setup(addr, fpscr));
+		EXPECT_TRUE(block->read_only);
+		return block;
+	}
+
+	void release(std::unique_ptr<RuntimeBlockInfo>& block)
+	{
+		// the block isn't registered
+		block->sh4_code_size = 0;
+		block.reset();
+	}
+
+	void assertSameParam(const shil_param& expected, const shil_param& actual)
+	{
+		ASSERT_EQ(expected.type, actual.type);
+		ASSERT_EQ(expected._imm, actual._imm);
+		if (expected.is_reg())
+		{
+			for (u32 i = 0; i < expected.count(); i++)
+				ASSERT_EQ(expected.version[i], actual.version[i]);
+		}
+	}
+
+	void assertSameBlock(const RuntimeBlockInfo& expected, const RuntimeBlockInfo& actual)
+	{
+		ASSERT_EQ(expected.sh4_code_size, actual.sh4_code_size);
+		ASSERT_EQ(expected.guest_cycles, actual.guest_cycles);
+		ASSERT_EQ(expected.guest_opcodes, actual.guest_opcodes);
+		ASSERT_EQ(expected.BranchBlock, actual.BranchBlock);
+		ASSERT_EQ(expected.NextBlock, actual.NextBlock);
+		ASSERT_EQ(expected.BlockType, actual.BlockType);
+		ASSERT_EQ(expected.has_fpu_op, actual.has_fpu_op);
+		ASSERT_EQ(expected.oplist.size(), actual.oplist.size());
+		for (size_t i = 0; i < expected.oplist.size(); i++)
+		{
+			const shil_opcode& e = expected.oplist[i];
+			const shil_opcode& a = actual.oplist[i];
+			ASSERT_EQ(e.op, a.op) << "op " << i;
+			ASSERT_EQ(e.size, a.size) << "op " << i;
+			ASSERT_EQ(e.guest_offs, a.guest_offs) << "op " << i;
+			ASSERT_EQ(e.delay_slot, a.delay_slot) << "op " << i;
+			assertSameParam(e.rd, a.rd);
+			assertSameParam(e.rd2, a.rd2);
+			assertSameParam(e.rs1, a.rs1);
+			assertSameParam(e.rs2, a.rs2);
+			assertSameParam(e.rs3, a.rs3);
+		}
+	}
+
+	// Decode and cache the test blocks, save them and reload the cache file
+	void saveAndReload(std::unique_ptr<RuntimeBlockInfo>& block0, std::unique_ptr<RuntimeBlockInfo>& block1)
+	{
+		writeTestCode();
+		block0 = setupBlock(BaseAddr);
+		block1 = setupBlock(BaseAddr + 0x100, true);
+		ASSERT_EQ(2u, blockcache::getStats().entries);
+		blockcache::save();
+		blockcache::clear();
+		ASSERT_EQ(0u, blockcache::getStats().entries);
+		blockcache::load();
+	}
+
+	void corruptFile(long offset, u8 value)
+	{
+		FILE *f = nowide::fopen(cachePath.c_str(), "r+b");
+		ASSERT_NE(nullptr, f);
+		ASSERT_EQ(0, std::fseek(f, offset, SEEK_SET));
+		ASSERT_EQ(1u, std::fwrite(&value, 1, 1, f));
+		std::fclose(f);
+	}
+
+	std::string cachePath;
+};
+
+TEST_F(BlockCacheTest, RoundTrip)
+{
+	std::unique_ptr<RuntimeBlockInfo> decoded0, decoded1;
+	saveAndReload(decoded0, decoded1);
+	ASSERT_EQ(2u, blockcache::getStats().entries);
+
+	std::unique_ptr<RuntimeBlockInfo> cached0 = setupBlock(BaseAddr);
+	std::unique_ptr<RuntimeBlockInfo> cached1 = setupBlock(BaseAddr + 0x100, true);
+	ASSERT_EQ(2u, blockcache::getStats().hits);
+	assertSameBlock(*decoded0, *cached0);
+	assertSameBlock(*decoded1, *cached1);
+	// the register allocator needs the SSA versions
+	bool hasVersions = false;
+	for (const shil_opcode& op : cached0->oplist)
+		hasVersions |= op.rd.is_reg() && op.rd.version[0] != 0;
+	ASSERT_TRUE(hasVersions);
+
+	// the fpu configuration is part of the key
+	std::unique_ptr<RuntimeBlockInfo> single = setupBlock(BaseAddr + 0x100, false);
+	ASSERT_EQ(2u, blockcache::getStats().hits);
+
+	release(decoded0);
+	release(decoded1);
+	release(cached0);
+	release(cached1);
+	release(single);
+}
+
+TEST_F(BlockCacheTest, Stale)
+{
+	std::unique_ptr<RuntimeBlockInfo> decoded0, decoded1;
+	saveAndReload(decoded0, decoded1);
+	// modify the block code
+	writeCode(BaseAddr, { 0xE107 });	// mov #7, r1
+	std::unique_ptr<RuntimeBlockInfo> block = setupBlock(BaseAddr);
+	ASSERT_EQ(0u, blockcache::getStats().hits);
+	ASSERT_EQ(1u, blockcache::getStats().stale);
+	// the stale entry is replaced
+	ASSERT_EQ(2u, blockcache::getStats().entries);
+
+	release(decoded0);
+	release(decoded1);
+	release(block);
+}
+
+TEST_F(BlockCacheTest, BuildHash)
+{
+	std::unique_ptr<RuntimeBlockInfo> decoded0, decoded1;
+	saveAndReload(decoded0, decoded1);
+	blockcache::clear();
+	// as if saved by a different build
+	corruptFile(BuildHashOffset, 0x5a);
+	blockcache::load();
+	ASSERT_EQ(0u, blockcache::getStats().entries);
+
+	release(decoded0);
+	release(decoded1);
+}
+
+TEST_F(BlockCacheTest, InvalidEntry)
+{
+	std::unique_ptr<RuntimeBlockInfo> decoded0, decoded1;
+	saveAndReload(decoded0, decoded1);
+	blockcache::clear();
+	corruptFile(FirstCodeSizeOffset + 2, 0x10);
+	blockcache::load();
+	ASSERT_EQ(1u, blockcache::getStats().entries);
+
+	// invalid entries are removed when saving
+	blockcache::save();
+	blockcache::clear();
+	blockcache::load();
+	ASSERT_EQ(1u, blockcache::getStats().entries);
+
+	release(decoded0);
+	release(decoded1);
+}
+
+TEST_F(BlockCacheTest, InvalidOp)
+{
+	std::unique_ptr<RuntimeBlockInfo> decoded0, decoded1;
+	saveAndReload(decoded0, decoded1);
+	blockcache::clear();
+	corruptFile(FirstOpOffset, 0xff);
+	blockcache::load();
+	ASSERT_EQ(1u, blockcache::getStats().entries);
+
+	release(decoded0);
+	release(decoded1);
+}
+
+#endif
@@ -0,0 +1,166 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "types.h"
+
+#if FEAT_SHREC != DYNAREC_NONE
+#include "gtest/gtest.h"
+#include "emulator.h"
+#include "hw/mem/addrspace.h"
+#include "hw/sh4/dyna/blockmanager.h"
+#include "hw/sh4/dyna/ngen.h"
+#include <chrono>
+#include <random>
+#include <vector>
+
+extern bool *unprotected_pages;
+
+class BlockManagerTest : public ::testing::Test
+{
+protected:
+	static constexpr u32 BaseAddr = 0x0c100000;
+	static constexpr u32 HostCodeSize = 64;
+
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		emu.init();
+		emu.dc_reset(true);
+		code.resize(16_MB);
+	}
+
+	void TearDown() override
+	{
+		// discard the remaining blocks and unprotect their pages
+		for (u32 addr = BaseAddr; addr < BaseAddr + 8_MB; addr += PAGE_SIZE)
+			bm_RamWriteAccess(addr);
+		bm_Periodical_1s();
+		memset(unprotected_pages, 0, RAM_SIZE / PAGE_SIZE);
+	}
+
+	// Adds a fake block. Its host code is the nth slot of the code buffer.
+	RuntimeBlockInfo *addBlock(u32 addr, u32 sh4Size, u32 n)
+	{
+		RuntimeBlockInfo *block = new RuntimeBlockInfo();
+		block->addr = addr;
+		block->vaddr = addr;
+		block->sh4_code_size = sh4Size;
+		block->code = (DynarecCodeEntryPtr)&code[n * HostCodeSize];
+		block->host_code_size = HostCodeSize;
+		block->BranchBlock = 0xFFFFFFFF;
+		block->NextBlock = 0xFFFFFFFF;
+		block->SetProtectedFlags();
+		bm_AddBlock(block);
+		return block;
+	}
+
+	void *hostCode(u32 n, u32 offset = 0) {
+		return CC_RW2RX(&code[n * HostCodeSize + offset]);
+	}
+
+	std::vector<u8> code;
+};
+
+TEST_F(BlockManagerTest, Lookup)
+{
+	RuntimeBlockInfo *block0 = addBlock(BaseAddr, 32, 0);
+	RuntimeBlockInfo *block1 = addBlock(BaseAddr + 32, 32, 1);
+	ASSERT_TRUE(block0->read_only);
+	ASSERT_EQ(block0, bm_GetBlock(hostCode(0)));
+	ASSERT_EQ(block0, bm_GetBlock(hostCode(0, HostCodeSize - 1)));
+	ASSERT_EQ(block1, bm_GetBlock(hostCode(1, 10)));
+	ASSERT_EQ(nullptr, bm_GetBlock(hostCode(2)));
+	ASSERT_EQ(block1, bm_GetBlock(BaseAddr + 32));
+
+	bm_RamWriteAccess(BaseAddr);
+	ASSERT_EQ(nullptr, bm_GetBlock(hostCode(0)));
+	ASSERT_EQ(nullptr, bm_GetBlock(hostCode(1)));
+	ASSERT_EQ(nullptr, bm_GetBlock(BaseAddr));
+}
+
+TEST_F(BlockManagerTest, MultiPageBlock)
+{
+	// spans 3 pages
+	const u32 addr = BaseAddr + PAGE_SIZE - 8;
+	RuntimeBlockInfo *block = addBlock(addr, PAGE_SIZE + 16, 0);
+	ASSERT_TRUE(block->read_only);
+	addBlock(BaseAddr + 2 * PAGE_SIZE + 64, 16, 1);
+	ASSERT_EQ(block, bm_GetBlock(addr));
+
+	// writing to the last page discards both blocks
+	bm_RamWriteAccess(BaseAddr + 2 * PAGE_SIZE);
+	ASSERT_EQ(nullptr, bm_GetBlock(addr));
+	ASSERT_EQ(nullptr, bm_GetBlock(hostCode(1)));
+
+	// the first page is still protected and its list must be empty
+	bm_RamWriteAccess(BaseAddr);
+	ASSERT_FALSE(bm_IsRamPageProtected(BaseAddr));
+}
+
+// Measures the host code lookups done on fault paths
+TEST_F(BlockManagerTest, LookupThroughput)
+{
+	constexpr u32 BlockCount = 64 * 1024;
+	for (u32 i = 0; i < BlockCount; i++)
+		addBlock(BaseAddr + i * 64, 64, i);
+
+	std::mt19937 rng(42);
+	std::vector<void *> lookups(1024 * 1024);
+	for (void *&p : lookups)
+		p = hostCode(rng() % BlockCount, rng() % HostCodeSize);
+
+	u32 found = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (void *p : lookups)
+		found += bm_GetBlock(p) != nullptr;
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	ASSERT_EQ(lookups.size(), found);
+	printf("BlockManager: %d lookups in %d blocks in %.3f s (%.1f M lookups/s)\n",
+			(int)lookups.size(), BlockCount, seconds, lookups.size() / seconds / 1e6);
+}
+
+// Self-modifying code: blocks are compiled then invalidated by writes to their pages
+TEST_F(BlockManagerTest, InvalidationThroughput)
+{
+	constexpr u32 BlocksPerPage = 32;
+	constexpr u32 PageCount = 256;
+	constexpr int Rounds = 50;
+	u64 discarded = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int round = 0; round < Rounds; round++)
+	{
+		u32 n = 0;
+		for (u32 page = 0; page < PageCount; page++)
+			for (u32 i = 0; i < BlocksPerPage; i++, n++)
+				// some blocks span 2 pages
+				addBlock(BaseAddr + page * PAGE_SIZE + i * (PAGE_SIZE / BlocksPerPage), i == BlocksPerPage - 1 ? 256 : 64, n);
+		for (u32 page = 0; page < PageCount; page++)
+			bm_RamWriteAccess(BaseAddr + page * PAGE_SIZE);
+		for (u32 i = 0; i < n; i++)
+			ASSERT_EQ(nullptr, bm_GetBlock(hostCode(i)));
+		discarded += n;
+		bm_Periodical_1s();
+		memset(unprotected_pages, 0, RAM_SIZE / PAGE_SIZE);
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	printf("BlockManager: %llu blocks added and invalidated in %.3f s (%.1f M blocks/s)\n",
+			(unsigned long long)discarded, seconds, discarded / seconds / 1e6);
+}
+
+#endif
@@ -155,6 +155,107 @@ TEST_F(MmuTest, TestMiss)
 	ASSERT_EQ(MmuError::TLB_MISS, err);
 }
 
+#ifdef FAST_MMU
+TEST_F(MmuTest, TestTranslationCache)
+{
+	u32 pa;
+	for (int i = 0; i < 2; i++)
+	{
+		UTLB[i].Address.VPN = 0x02000000 >> 10;
+		UTLB[i].Address.ASID = i + 1;
+		UTLB[i].Data.SZ0 = 1;
+		UTLB[i].Data.V = 1;
+		UTLB[i].Data.PR = 3;
+		UTLB[i].Data.D = 1;
+		UTLB[i].Data.PPN = (0x0C000000 + i * 0x100000) >> 10;
+		UTLB_Sync(i);
+	}
+	mmu_resetCacheStats();
+	for (int i = 0; i < 3; i++)
+	{
+		CCN_PTEH.ASID = 1;
+		MmuError err = mmu_data_translation<MMU_TT_DREAD>(0x02000010, pa);
+		ASSERT_EQ(MmuError::NONE, err);
+		ASSERT_EQ(0x0C000010u, pa);
+		CCN_PTEH.ASID = 2;
+		err = mmu_data_translation<MMU_TT_DREAD>(0x02000010, pa);
+		ASSERT_EQ(MmuError::NONE, err);
+		ASSERT_EQ(0x0C100010u, pa);
+	}
+	// Translations of both address spaces are kept when switching
+	MmuCacheStats stats = mmu_getCacheStats();
+	ASSERT_EQ(2u, stats.misses);
+	ASSERT_EQ(4u, stats.hits);
+
+	// New mapping for ASID 1
+	UTLB[0].Data.PPN = 0x0C200000 >> 10;
+	UTLB_Sync(0);
+	CCN_PTEH.ASID = 2;
+	MmuError err = mmu_data_translation<MMU_TT_DREAD>(0x02000020, pa);
+	ASSERT_EQ(MmuError::NONE, err);
+	ASSERT_EQ(0x0C100020u, pa);
+	CCN_PTEH.ASID = 1;
+	err = mmu_data_translation<MMU_TT_DREAD>(0x02000020, pa);
+	ASSERT_EQ(MmuError::NONE, err);
+	ASSERT_EQ(0x0C200020u, pa);
+
+	// Other ASID
+	CCN_PTEH.ASID = 3;
+	err = mmu_data_translation<MMU_TT_DREAD>(0x02000020, pa);
+	ASSERT_EQ(MmuError::TLB_MISS, err);
+}
+
+TEST_F(MmuTest, TestLutAsidSwitch)
+{
+	constexpr u32 slot0Page = 0x00010000 >> 12;
+	constexpr u32 slot2Page = 0x04010000 >> 12;
+	CCN_PTEH.ASID = 1;
+	mmuAddressLUTAdd(0x00010000, 0x0C010000);
+	mmuAddressLUTAdd(0x04010000, 0x0C020000);
+	mmuAddressLUTSwitchAsid(2);
+	CCN_PTEH.ASID = 2;
+	// only slot 0 is private
+	ASSERT_EQ(0u, mmuAddressLUT[slot0Page]);
+	ASSERT_EQ(0x0C020000u, mmuAddressLUT[slot2Page]);
+	mmuAddressLUTAdd(0x00010123, 0x0C030123);
+	ASSERT_EQ(0x0C030000u, mmuAddressLUT[slot0Page]);
+
+	// translations are restored when switching back
+	mmuAddressLUTSwitchAsid(1);
+	CCN_PTEH.ASID = 1;
+	ASSERT_EQ(0x0C010000u, mmuAddressLUT[slot0Page]);
+	mmuAddressLUTSwitchAsid(2);
+	CCN_PTEH.ASID = 2;
+	ASSERT_EQ(0x0C030000u, mmuAddressLUT[slot0Page]);
+
+	// New mapping for ASID 1
+	UTLB[0].Address.VPN = 0x00010000 >> 10;
+	UTLB[0].Address.ASID = 1;
+	UTLB[0].Data.SZ0 = 1;
+	UTLB[0].Data.V = 1;
+	UTLB[0].Data.PR = 3;
+	UTLB[0].Data.D = 1;
+	UTLB[0].Data.PPN = 0x0C040000 >> 10;
+	UTLB_Sync(0);
+	ASSERT_EQ(0u, mmuAddressLUT[slot0Page]);
+	mmuAddressLUTSwitchAsid(1);
+	CCN_PTEH.ASID = 1;
+	ASSERT_EQ(0u, mmuAddressLUT[slot0Page]);
+	mmuAddressLUTAdd(0x00010000, 0x0C040000);
+
+	// Full flush
+	mmu_flush_table();
+	ASSERT_EQ(0u, mmuAddressLUT[slot0Page]);
+	ASSERT_EQ(0u, mmuAddressLUT[slot2Page]);
+	mmuAddressLUTSwitchAsid(2);
+	CCN_PTEH.ASID = 2;
+	ASSERT_EQ(0u, mmuAddressLUT[slot0Page]);
+	mmuAddressLUTSwitchAsid(1);
+	CCN_PTEH.ASID = 1;
+	ASSERT_EQ(0u, mmuAddressLUT[slot0Page]);
+}
+#endif
+
 TEST_F(MmuTest, TestErrors)
 {
 #ifndef FAST_MMU
@@ -0,0 +1,167 @@
+#include "gtest/gtest.h"
+#include "types.h"
+#include "emulator.h"
+#include "cfg/option.h"
+#include "hw/mem/addrspace.h"
+#include "hw/mem/mem_watch.h"
+#include "hw/sh4/sh4_mem.h"
+#include "network/ggpo.h"
+#include "serialize.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <set>
+#include <vector>
+
+class RollbackTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		emu.init();
+		emu.dc_reset(true);
+	}
+
+	static void report(const char *name, std::vector<u32>& samples)
+	{
+		std::sort(samples.begin(), samples.end());
+		auto percentile = [&samples](int p) {
+			return samples[(samples.size() - 1) * p / 100];
+		};
+		printf("%s: p50 %u us, p90 %u us, p99 %u us, max %u us\n", name,
+				percentile(50), percentile(90), percentile(99), samples.back());
+	}
+};
+
+TEST_F(RollbackTest, PageArena)
+{
+	memwatch::PageArena& arena = memwatch::pageArena;
+	{
+		memwatch::PageMap pages;
+		for (u32 i = 0; i < 300; i++)
+			pages[i * PAGE_SIZE].data[0] = (u8)i;
+		ASSERT_EQ(300u, pages.size());
+		ASSERT_EQ(arena.capacity() - 300, arena.available());
+		for (u32 i = 0; i < 300; i++)
+			ASSERT_EQ((u8)i, pages[i * PAGE_SIZE].data[0]);
+	}
+	// all pages are recycled
+	ASSERT_EQ(arena.capacity(), arena.available());
+	size_t capacity = arena.capacity();
+	{
+		memwatch::PageMap pages;
+		for (u32 i = 0; i < 300; i++)
+			pages[i * PAGE_SIZE];
+	}
+	ASSERT_EQ(capacity, arena.capacity());
+	arena.clear();
+	ASSERT_EQ(0u, arena.capacity());
+}
+
+#ifdef USE_GGPO
+// Drive the ggpo save/load/free callbacks like a ggpo session does: save a state every frame with some dirty pages,
+// free the oldest state when its slot is reused, and regularly roll back a few frames and run them again.
+TEST_F(RollbackTest, Stress)
+{
+	using clock = std::chrono::steady_clock;
+	constexpr int MaxStates = 10;		// MAX_PREDICTION_FRAMES + 2 in ggpo
+	constexpr int Frames = 600;
+	constexpr int DirtyPages = 64;
+	constexpr int RollbackFrames = 4;
+	constexpr u32 WatchedPages = 256;
+
+	config::GGPOEnable.override(true);
+	config::ThreadedRendering.override(false);
+
+	struct SavedState
+	{
+		u8 *buffer = nullptr;
+		int len = 0;
+		int frame = -1;
+		std::vector<u8> ram;
+	};
+	std::array<SavedState, MaxStates> states;
+	std::set<u8 *> buffers;
+	std::vector<u32> saveTimes;
+	std::vector<u32> loadTimes;
+
+	auto saveFrame = [&](int frame) {
+		SavedState& state = states[frame % MaxStates];
+		if (state.buffer != nullptr)
+			ggpo::free_buffer(state.buffer);
+		auto start = clock::now();
+		int checksum;
+		ASSERT_TRUE(ggpo::save_game_state(&state.buffer, &state.len, &checksum, frame));
+		saveTimes.push_back((u32)std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count());
+		state.frame = frame;
+		state.ram.assign(&mem_b[0], &mem_b[WatchedPages * PAGE_SIZE]);
+		buffers.insert(state.buffer);
+	};
+	auto runFrame = [](int frame, int generation) {
+		for (int i = 0; i < DirtyPages; i++)
+		{
+			u32 offset = ((frame * 7 + i * 13) % WatchedPages) * PAGE_SIZE;
+			// what the fault handler does on the first write to a protected page
+			memwatch::writeAccess(&mem_b[offset]);
+			memset(&mem_b[offset], (u8)(frame * 3 + generation + i), PAGE_SIZE);
+		}
+	};
+
+	saveFrame(0);
+	for (int frame = 1; frame < Frames; frame++)
+	{
+		runFrame(frame, 0);
+		saveFrame(frame);
+
+		if (frame % 10 == 9)
+		{
+			int target = frame - RollbackFrames + 1;
+			const SavedState& rollback = states[target % MaxStates];
+			ASSERT_EQ(target, rollback.frame);
+			auto start = clock::now();
+			ASSERT_TRUE(ggpo::load_game_state(rollback.buffer, rollback.len));
+			loadTimes.push_back((u32)std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count());
+			ASSERT_EQ(0, memcmp(&mem_b[0], rollback.ram.data(), rollback.ram.size())) << "frame " << target;
+
+			// run the rolled back frames again with different inputs
+			for (int f = target + 1; f <= frame; f++)
+			{
+				runFrame(f, 1);
+				saveFrame(f);
+			}
+		}
+		ggpo::StateStats stats = ggpo::getStateStats();
+		ASSERT_LE(stats.snapshotBuffers, (size_t)MaxStates);
+		ASSERT_LE(stats.deltaStates, (size_t)MaxStates);
+	}
+	// the snapshot buffers are recycled
+	ASSERT_EQ((size_t)MaxStates, buffers.size());
+	ggpo::StateStats stats = ggpo::getStateStats();
+	ASSERT_EQ((size_t)MaxStates, stats.snapshotBuffers);
+	ASSERT_EQ(0u, stats.freeSnapshotBuffers);
+	// and so are the delta states
+	ASSERT_EQ(0u, stats.overwrittenDeltaStates);
+
+	// a rollback across the rerun frames restores the memory of the rerun
+	const SavedState& rollback = states[(Frames - MaxStates + 1) % MaxStates];
+	ASSERT_TRUE(ggpo::load_game_state(rollback.buffer, rollback.len));
+	ASSERT_EQ(0, memcmp(&mem_b[0], rollback.ram.data(), rollback.ram.size())) << "frame " << rollback.frame;
+
+	report("Rollback save", saveTimes);
+	report("Rollback load", loadTimes);
+
+	memwatch::unprotect();
+	memwatch::reset();
+	for (SavedState& state : states)
+		ggpo::free_buffer(state.buffer);
+	stats = ggpo::getStateStats();
+	ASSERT_EQ(0u, stats.deltaStates);
+	ASSERT_EQ((size_t)MaxStates, stats.freeSnapshotBuffers);
+	memwatch::pageArena.clear();
+	config::ThreadedRendering.reset();
+	config::GGPOEnable.reset();
+}
+#endif
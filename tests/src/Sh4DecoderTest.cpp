@@ -0,0 +1,162 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "types.h"
+
+#if FEAT_SHREC != DYNAREC_NONE
+#include "gtest/gtest.h"
+#include "emulator.h"
+#include "hw/mem/addrspace.h"
+#include "hw/sh4/sh4_mem.h"
+#include "hw/sh4/sh4_sched.h"
+#include "hw/sh4/dyna/blockmanager.h"
+#include "hw/sh4/dyna/decoder.h"
+#include <initializer_list>
+
+class Sh4DecoderTest : public ::testing::Test
+{
+protected:
+	static constexpr u32 BaseAddr = 0x8c010000;
+
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		emu.init();
+		mem_map_default();
+		emu.dc_reset(true);
+		block = new RuntimeBlockInfo();
+	}
+
+	void TearDown() override
+	{
+		// the block isn't registered
+		block->sh4_code_size = 0;
+		delete block;
+	}
+
+	void writeCode(u32 addr, std::initializer_list<u16> ops)
+	{
+		for (u16 op : ops)
+		{
+			addrspace::write16(addr, op);
+			addr += 2;
+		}
+	}
+
+	void decode(u32 addr, bool superblock)
+	{
+		block->vaddr = block->addr = addr;
+		block->fpu_cfg = {};
+		block->sh4_code_size = 0;
+		block->guest_cycles = 0;
+		block->has_fpu_op = false;
+		block->BranchBlock = NullAddress;
+		block->NextBlock = NullAddress;
+		block->BlockType = BET_SCL_Intr;
+		block->oplist.clear();
+		ASSERT_TRUE(dec_DecodeBlock(block, SH4_TIMESLICE / 2, false, superblock));
+	}
+
+	RuntimeBlockInfo *block = nullptr;
+};
+
+// bra and bsr chain with literal pools between the branches and their targets
+TEST_F(Sh4DecoderTest, BranchChain)
+{
+	writeCode(BaseAddr, {
+		0xE001,		// mov #1, r0
+		0xA005,		// bra 10
+		0x7001,		// add #1, r0
+		0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+		0x7002,		// 10: add #2, r0
+		0xB005,		// bsr 20
+		0x0009,		// nop
+		0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+		0x7003,		// 20: add #3, r0
+		0x000B,		// rts
+		0x0009,		// nop
+	});
+
+	decode(BaseAddr, false);
+	ASSERT_EQ(3u, block->guest_opcodes);
+	ASSERT_EQ(BET_StaticJump, block->BlockType);
+	ASSERT_EQ(BaseAddr + 0x10, block->BranchBlock);
+	ASSERT_EQ(6u, block->sh4_code_size);
+
+	decode(BaseAddr, true);
+	ASSERT_EQ(9u, block->guest_opcodes);
+	ASSERT_EQ(BET_DynamicRet, block->BlockType);
+	// the protected and checked range covers the literal pools
+	ASSERT_EQ(0x26u, block->sh4_code_size);
+}
+
+TEST_F(Sh4DecoderTest, BranchLimits)
+{
+	// too far
+	writeCode(BaseAddr, {
+		0xA7FF,		// bra 1002
+		0x0009,		// nop
+	});
+	decode(BaseAddr, true);
+	ASSERT_EQ(2u, block->guest_opcodes);
+	ASSERT_EQ(BET_StaticJump, block->BlockType);
+	ASSERT_EQ(BaseAddr + 0x1002, block->BranchBlock);
+
+	// backward
+	writeCode(BaseAddr + 0x10, {
+		0xAFF6,		// bra 0
+		0x0009,		// nop
+	});
+	decode(BaseAddr + 0x10, true);
+	ASSERT_EQ(2u, block->guest_opcodes);
+	ASSERT_EQ(BET_StaticJump, block->BlockType);
+	ASSERT_EQ(BaseAddr, block->BranchBlock);
+
+	// conditional branches end the block
+	writeCode(BaseAddr, {
+		0x8901,		// bt 6
+		0xA000,		// bra 6
+		0x0009,		// nop
+		0x0009,		// 6: nop
+		0x000B,		// rts
+		0x0009,		// nop
+	});
+	decode(BaseAddr, true);
+	ASSERT_EQ(1u, block->guest_opcodes);
+	ASSERT_EQ(BET_Cond_1, block->BlockType);
+}
+
+TEST_F(Sh4DecoderTest, MaxBranches)
+{
+	// each bra jumps over one word
+	for (u32 i = 0; i < 6; i++)
+		writeCode(BaseAddr + i * 6, {
+			0xA001,		// bra +6
+			0x0009,		// nop
+			0xFFFF,
+		});
+	decode(BaseAddr, true);
+	// 4 branches are followed
+	ASSERT_EQ(10u, block->guest_opcodes);
+	ASSERT_EQ(BET_StaticJump, block->BlockType);
+	ASSERT_EQ(BaseAddr + 5 * 6, block->BranchBlock);
+	ASSERT_EQ(4u * 6 + 4, block->sh4_code_size);
+}
+
+#endif
@@ -0,0 +1,176 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "types.h"
+
+#if FEAT_SHREC == DYNAREC_JIT && HOST_CPU == CPU_X64
+#include "sh4_ops.h"
+#include "emulator.h"
+#include "cfg/option.h"
+#include "hw/sh4/sh4_mem.h"
+#include "hw/sh4/sh4_sched.h"
+#include <cmath>
+#include <cstring>
+#include <random>
+
+// Runs the op tests with the dynarec
+class Sh4DynarecTest : public Sh4OpTest {
+protected:
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		config::DynarecEnabled.override(true);
+		emu.init();
+		mem_map_default();
+		emu.dc_reset(true);
+		ctx = &p_sh4rcb->cntx;
+		sh4 = emu.getSh4Executor();
+		schedId = sh4_sched_register(0, stopCpu, ctx);
+	}
+	void TearDown() override
+	{
+		sh4_sched_unregister(schedId);
+		config::DynarecEnabled.reset();
+	}
+	void PrepareOp(u16 op, u16 op2 = 0, u16 op3 = 0) override
+	{
+		u32 pc = START_PC;
+		addrspace::write16(pc, op);
+		if (op2 != 0)
+			addrspace::write16(pc += 2, op2);
+		if (op3 != 0)
+			addrspace::write16(pc += 2, op3);
+		addrspace::write16(pc + 2, 0xAFFE);	// bra $
+		addrspace::write16(pc + 4, 0x0009);	// nop
+		// discard the blocks of the previous ops
+		sh4->ResetCache();
+	}
+	// The ops are run once then the cpu loops until the end of the time slice, where it is stopped.
+	// Ops that change the pc aren't supported.
+	void RunOp(int numOp = 1) override
+	{
+		ctx->pc = START_PC;
+		ctx->cycle_counter = SH4_TIMESLICE;
+		ctx->CpuRunning = 1;
+		sh4_sched_request(schedId, 1);
+		sh4->Run();
+	}
+
+	// Runs the op with the interpreter. Must be called after PrepareOp.
+	void RunInterpreter()
+	{
+		config::DynarecEnabled.override(false);
+		Sh4Executor *interpreter = emu.getSh4Executor();
+		config::DynarecEnabled.override(true);
+		ctx->pc = START_PC;
+		interpreter->Step();
+	}
+
+	// Checks that the dynarec and the interpreter give the same results for the op
+	void CompareWithInterpreter(u16 op, std::mt19937& rng)
+	{
+		PrepareOp(op);
+		for (int n = 0; n < 20000; n++)
+		{
+			float fr[16], xf[16];
+			for (int i = 0; i < 16; i++)
+			{
+				fr[i] = randomFloat(rng, n % 4);
+				xf[i] = randomFloat(rng, n % 4);
+			}
+			if (n % 7 == 0)
+			{
+				// the large terms cancel out
+				fr[2] = -fr[0];
+				xf[8] = xf[0];
+				xf[9] = xf[1];
+			}
+			memcpy(ctx->fr, fr, sizeof(fr));
+			memcpy(ctx->xf, xf, sizeof(xf));
+			RunInterpreter();
+			float expectedFr[16], expectedXf[16];
+			memcpy(expectedFr, ctx->fr, sizeof(expectedFr));
+			memcpy(expectedXf, ctx->xf, sizeof(expectedXf));
+
+			memcpy(ctx->fr, fr, sizeof(fr));
+			memcpy(ctx->xf, xf, sizeof(xf));
+			RunOp();
+			for (int i = 0; i < 16; i++)
+			{
+				ASSERT_TRUE(sameFloat(expectedFr[i], ctx->fr[i])) << "op " << std::hex << op << std::dec << " input " << n
+						<< " fr" << i << " expected " << expectedFr[i] << " got " << ctx->fr[i];
+				ASSERT_TRUE(sameFloat(expectedXf[i], ctx->xf[i])) << "op " << std::hex << op << std::dec << " input " << n
+						<< " xf" << i << " expected " << expectedXf[i] << " got " << ctx->xf[i];
+			}
+		}
+	}
+
+	static float randomFloat(std::mt19937& rng, int kind)
+	{
+		u32 bits = rng();
+		switch (kind)
+		{
+		case 0:	// any value including infinities and NaNs
+			break;
+		case 1:	// no overflow or underflow
+			bits = (bits & 0x807fffff) | ((100 + rng() % 56) << 23);
+			break;
+		case 2:	// small integers, some of them large
+			return (float)((int)(rng() % 65) - 32) * ((rng() & 1) ? 1e8f : 1.f);
+		default:	// denormals
+			bits &= 0x807fffff;
+			break;
+		}
+		float f;
+		memcpy(&f, &bits, sizeof(f));
+		return f;
+	}
+
+	static bool sameFloat(float expected, float actual)
+	{
+		if (std::isnan(expected))
+			return std::isnan(actual);
+		return memcmp(&expected, &actual, sizeof(float)) == 0;
+	}
+
+	static int stopCpu(int tag, int sch_cycl, int jitter, void *arg)
+	{
+		((Sh4Context *)arg)->CpuRunning = 0;
+		return 0;
+	}
+
+	int schedId = -1;
+};
+
+TEST_F(Sh4DynarecTest, VectorTest)
+{
+	Sh4OpTest::VectorTest();
+}
+
+TEST_F(Sh4DynarecTest, VectorInterpreter)
+{
+	ctx->fpscr.PR = 0;
+	std::mt19937 rng(1234);
+	CompareWithInterpreter(0xF4ED, rng);	// fipr fv0, fv4
+	CompareWithInterpreter(0xFCED, rng);	// fipr fv0, fv12
+	CompareWithInterpreter(0xF1FD, rng);	// ftrv xmtrx, fv0
+	CompareWithInterpreter(0xFDFD, rng);	// ftrv xmtrx, fv12
+}
+
+#endif
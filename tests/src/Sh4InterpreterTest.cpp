@@ -98,6 +98,10 @@ TEST_F(Sh4InterpreterTest, FloatingPointTest)
 {
 	Sh4OpTest::FloatingPointTest();
 }
+TEST_F(Sh4InterpreterTest, VectorTest)
+{
+	Sh4OpTest::VectorTest();
+}
 TEST_F(Sh4InterpreterTest, DoubleFloatingPointTest)
 {
 	Sh4OpTest::DoubleFloatingPointTest();
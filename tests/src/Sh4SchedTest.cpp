@@ -0,0 +1,209 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/mem/addrspace.h"
+#include "hw/sh4/sh4_if.h"
+#include "hw/sh4/sh4_sched.h"
+#include <chrono>
+#include <vector>
+
+class Sh4SchedTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		// Unschedules the callbacks registered by other tests
+		sh4_sched_reset(true);
+		calls.clear();
+	}
+
+	void TearDown() override
+	{
+		for (int id : ids)
+			sh4_sched_unregister(id);
+		ids.clear();
+	}
+
+	int registerCallback(int tag, sh4_sched_callback *callback = recordCallback)
+	{
+		int id = sh4_sched_register(tag, callback, this);
+		ids.push_back(id);
+		return id;
+	}
+
+	// Run the scheduler like the sh4 does: one timeslice at a time
+	static void run(int cycles)
+	{
+		while (cycles > 0)
+		{
+			Sh4cntx.sh4_sched_next -= SH4_TIMESLICE;
+			if (Sh4cntx.sh4_sched_next < 0)
+				sh4_sched_tick(SH4_TIMESLICE);
+			cycles -= SH4_TIMESLICE;
+		}
+	}
+
+	static int recordCallback(int tag, int cycles, int jitter, void *arg)
+	{
+		Sh4SchedTest *test = (Sh4SchedTest *)arg;
+		test->calls.push_back({ tag, cycles, jitter });
+		return test->reschedule;
+	}
+
+	static int requestOtherCallback(int tag, int cycles, int jitter, void *arg)
+	{
+		Sh4SchedTest *test = (Sh4SchedTest *)arg;
+		test->calls.push_back({ tag, cycles, jitter });
+		if (tag == 1)
+			sh4_sched_request(test->otherId, 0);
+		return 0;
+	}
+
+	struct Call
+	{
+		int tag;
+		int cycles;
+		int jitter;
+	};
+	std::vector<Call> calls;
+	std::vector<int> ids;
+	int reschedule = 0;
+	int otherId = -1;
+};
+
+TEST_F(Sh4SchedTest, Order)
+{
+	int a = registerCallback(1);
+	int b = registerCallback(2);
+	int c = registerCallback(3);
+	sh4_sched_request(a, 1000);
+	sh4_sched_request(b, 500);
+	sh4_sched_request(c, 1000);
+	ASSERT_TRUE(sh4_sched_is_scheduled(a));
+
+	run(SH4_TIMESLICE);
+	ASSERT_EQ(0u, calls.size());
+	run(SH4_TIMESLICE);
+	ASSERT_EQ(1u, calls.size());
+	ASSERT_EQ(2, calls[0].tag);
+	ASSERT_EQ(500, calls[0].cycles);
+	ASSERT_EQ(SH4_TIMESLICE * 2 - 500, calls[0].jitter);
+	// callbacks ending at the same time are called in registration order
+	run(SH4_TIMESLICE);
+	ASSERT_EQ(3u, calls.size());
+	ASSERT_EQ(1, calls[1].tag);
+	ASSERT_EQ(3, calls[2].tag);
+	ASSERT_FALSE(sh4_sched_is_scheduled(a));
+	ASSERT_FALSE(sh4_sched_is_scheduled(b));
+	ASSERT_FALSE(sh4_sched_is_scheduled(c));
+}
+
+TEST_F(Sh4SchedTest, Cancel)
+{
+	int a = registerCallback(1);
+	int b = registerCallback(2);
+	sh4_sched_request(a, 100);
+	sh4_sched_request(b, 200);
+	sh4_sched_request(a, -1);
+	ASSERT_FALSE(sh4_sched_is_scheduled(a));
+	run(SH4_TIMESLICE);
+	ASSERT_EQ(1u, calls.size());
+	ASSERT_EQ(2, calls[0].tag);
+}
+
+TEST_F(Sh4SchedTest, Periodic)
+{
+	int a = registerCallback(1);
+	reschedule = 1000;
+	sh4_sched_request(a, 1000);
+	run(100'000);
+	// jitter is compensated
+	ASSERT_EQ(100u, calls.size());
+	reschedule = 0;
+	run(2000);
+	ASSERT_FALSE(sh4_sched_is_scheduled(a));
+}
+
+TEST_F(Sh4SchedTest, RequestFromCallback)
+{
+	int a = registerCallback(1, requestOtherCallback);
+	otherId = registerCallback(2, requestOtherCallback);
+	sh4_sched_request(a, 10);
+	run(SH4_TIMESLICE);
+	// A due callback requested during the timeslice is called immediately
+	ASSERT_EQ(2u, calls.size());
+	ASSERT_EQ(1, calls[0].tag);
+	ASSERT_EQ(2, calls[1].tag);
+}
+
+TEST_F(Sh4SchedTest, Chronological)
+{
+	int a = registerCallback(1);
+	int b = registerCallback(2);
+	sh4_sched_request(a, 400);
+	sh4_sched_request(b, 300);
+	run(SH4_TIMESLICE);
+	ASSERT_EQ(2u, calls.size());
+	ASSERT_EQ(2, calls[0].tag);
+	ASSERT_EQ(1, calls[1].tag);
+}
+
+TEST_F(Sh4SchedTest, OncePerTick)
+{
+	int a = registerCallback(1);
+	// rescheduled immediately each time it's called
+	reschedule = 1;
+	sh4_sched_request(a, 0);
+	run(SH4_TIMESLICE);
+	ASSERT_EQ(1u, calls.size());
+	run(SH4_TIMESLICE);
+	ASSERT_EQ(2u, calls.size());
+	reschedule = 0;
+}
+
+// Replays a schedule similar to a running system and reports the callback throughput
+TEST_F(Sh4SchedTest, Throughput)
+{
+	// AICA sample, SPG line, TMU x3, maple, GD-ROM, AICA DMA, RTC, ...
+	static const int periods[] = { 4535, 2850, 1024, 5000, 16000, 200000, 6000, 3000, SH4_MAIN_CLOCK, 10000, 800, 2400 };
+	static constexpr sh4_sched_callback *callback = [](int tag, int cycles, int jitter, void *arg) -> int {
+		(*(u64 *)arg)++;
+		return periods[tag];
+	};
+	u64 callCount = 0;
+	for (size_t i = 0; i < std::size(periods); i++)
+	{
+		int id = sh4_sched_register(i, callback, &callCount);
+		ids.push_back(id);
+		sh4_sched_request(id, periods[i]);
+	}
+	// idle devices: modem, bba, serial, ...
+	for (int i = 0; i < 8; i++)
+		registerCallback(100 + i);
+	constexpr int EmulatedSeconds = 10;
+	auto start = std::chrono::steady_clock::now();
+	run(SH4_MAIN_CLOCK * EmulatedSeconds);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	ASSERT_GT(callCount, 0u);
+	printf("Sh4Sched: %llu callbacks in %.3f s (%.1f M callbacks/s, %.1f emulated s/s)\n",
+			(unsigned long long)callCount, seconds, callCount / seconds / 1e6, EmulatedSeconds / seconds);
+}
@@ -0,0 +1,177 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/pvr/ta_ctx.h"
+#include "util/radix_sort.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+class TaSortTest : public ::testing::Test
+{
+protected:
+	void TearDown() override {
+		ta_radix_sort = true;
+	}
+
+	// Build a translucent list similar to a captured frame: triangle strips of various lengths,
+	// with many equal z values and a few infinite vertices
+	static void buildContext(rend_context& ctx, u32 polyCount, u32 seed)
+	{
+		std::mt19937 rng(seed);
+		ctx.Clear();
+		ctx.global_param_tr.clear();
+		ctx.verts.clear();
+		for (u32 i = 0; i < polyCount; i++)
+		{
+			PolyParam pp;
+			pp.init();
+			pp.first = ctx.verts.size();
+			pp.count = 3 + rng() % 10;
+			pp.tsp.full = rng() % 4;
+			pp.isp.CullMode = rng() % 4;
+			for (u32 j = 0; j < pp.count; j++)
+			{
+				Vertex vtx {};
+				vtx.x = (float)(rng() % 640);
+				vtx.y = (float)(rng() % 480);
+				switch (rng() % 16)
+				{
+				case 0:
+					vtx.z = -0.f;
+					break;
+				case 1:
+					vtx.z = 0.f;
+					break;
+				case 2:
+					vtx.x = 1e30f;
+					break;
+				default:
+					// quantized to get equal values
+					vtx.z = (float)(rng() % 1024) / 64.f;
+					break;
+				}
+				ctx.verts.push_back(vtx);
+			}
+			ctx.global_param_tr.push_back(pp);
+		}
+	}
+
+	static void sort(rend_context& ctx, bool radix)
+	{
+		ta_radix_sort = radix;
+		RenderPass previousPass {};
+		RenderPass pass {};
+		pass.tr_count = ctx.global_param_tr.size();
+		ctx.idx.clear();
+		ctx.sortedTriangles.clear();
+		sortTriangles(ctx, pass, previousPass);
+	}
+};
+
+TEST_F(TaSortTest, FloatKey)
+{
+	const float values[] = { -1e30f, -2.f, -1.f, -1e-30f, -0.f, 0.f, 1e-30f, 1.f, 2.f, 1e30f };
+	for (size_t i = 1; i < std::size(values); i++)
+		ASSERT_LE(radix::floatKey(values[i - 1]), radix::floatKey(values[i])) << values[i];
+	ASSERT_EQ(radix::floatKey(-0.f), radix::floatKey(0.f));
+	ASSERT_LT(radix::floatKey(-1.f), radix::floatKey(-0.5f));
+}
+
+TEST_F(TaSortTest, RadixSort)
+{
+	std::mt19937 rng(1);
+	for (size_t count : { 0, 1, 2, 100, 5000, 100000 })
+	{
+		std::vector<radix::Item> items(count);
+		for (size_t i = 0; i < count; i++)
+			items[i] = { (u32)(rng() % (count / 4 + 1)) << (rng() % 24), (u32)i };
+		std::vector<radix::Item> reference = items;
+		std::stable_sort(reference.begin(), reference.end(), [](const radix::Item& a, const radix::Item& b) {
+			return a.key < b.key;
+		});
+		std::vector<radix::Item> temp(count);
+		const radix::Item *sorted = radix::sort(items.data(), temp.data(), count);
+		for (size_t i = 0; i < count; i++)
+		{
+			ASSERT_EQ(reference[i].key, sorted[i].key);
+			ASSERT_EQ(reference[i].index, sorted[i].index);
+		}
+	}
+}
+
+TEST_F(TaSortTest, SortTriangles)
+{
+	for (u32 polyCount : { 1, 10, 500, 10000 })
+	{
+		rend_context reference;
+		buildContext(reference, polyCount, polyCount);
+		sort(reference, false);
+		rend_context radix;
+		buildContext(radix, polyCount, polyCount);
+		sort(radix, true);
+
+		ASSERT_EQ(reference.idx, radix.idx) << polyCount;
+		ASSERT_EQ(reference.sortedTriangles.size(), radix.sortedTriangles.size());
+		for (size_t i = 0; i < reference.sortedTriangles.size(); i++)
+		{
+			ASSERT_EQ(reference.sortedTriangles[i].polyIndex, radix.sortedTriangles[i].polyIndex);
+			ASSERT_EQ(reference.sortedTriangles[i].first, radix.sortedTriangles[i].first);
+			ASSERT_EQ(reference.sortedTriangles[i].count, radix.sortedTriangles[i].count);
+		}
+	}
+}
+
+TEST_F(TaSortTest, SortPolyParams)
+{
+	rend_context reference;
+	buildContext(reference, 5000, 42);
+	ta_radix_sort = false;
+	sortPolyParams(reference.global_param_tr, 0, reference.global_param_tr.size(), reference);
+	rend_context radix;
+	buildContext(radix, 5000, 42);
+	ta_radix_sort = true;
+	sortPolyParams(radix.global_param_tr, 0, radix.global_param_tr.size(), radix);
+
+	for (size_t i = 0; i < reference.global_param_tr.size(); i++)
+		ASSERT_EQ(reference.global_param_tr[i].first, radix.global_param_tr[i].first) << i;
+}
+
+TEST_F(TaSortTest, Benchmark)
+{
+	using clock = std::chrono::steady_clock;
+	for (u32 polyCount : { 2000, 20000 })
+	{
+		rend_context ctx;
+		buildContext(ctx, polyCount, 7);
+		double times[2];
+		for (int radix = 0; radix < 2; radix++)
+		{
+			constexpr int Iterations = 20;
+			auto start = clock::now();
+			for (int i = 0; i < Iterations; i++)
+				sort(ctx, radix);
+			times[radix] = std::chrono::duration<double, std::micro>(clock::now() - start).count() / Iterations;
+		}
+		printf("%u polys, %zu triangles: stable_sort %.0f us, radix sort %.0f us (x%.2f)\n", polyCount,
+				ctx.idx.size() / 3, times[0], times[1], times[0] / times[1]);
+	}
+}
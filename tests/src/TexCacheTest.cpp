@@ -0,0 +1,170 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "types.h"
+#include "emulator.h"
+#include "hw/mem/addrspace.h"
+#include "rend/TexCache.h"
+
+class TestTexture final : public BaseTextureCacheData
+{
+public:
+	TestTexture(TSP tsp, TCW tcw) : BaseTextureCacheData(tsp, tcw) {}
+	TestTexture(TestTexture&& other) = default;
+
+	std::string GetId() override { return "test"; }
+	void UploadToGPU(int width, int height, const u8 *temp_tex_buffer, bool mipmapped, bool mipmapsIncluded = false) override {}
+};
+
+class TestTextureCache final : public BaseTextureCache<TestTexture>
+{
+public:
+	bool contains(u32 startAddress) const
+	{
+		for (const auto& [id, texture] : cache)
+			if (texture.startAddress == startAddress)
+				return true;
+		return false;
+	}
+};
+
+class TexCacheTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		emu.init();
+		emu.dc_reset(true);
+	}
+
+	void TearDown() override
+	{
+		config::TextureCacheSize.reset();
+	}
+
+	// 256x256 565 twiddled texture
+	static TestTexture *getTexture(TestTextureCache& cache, u32 address)
+	{
+		TSP tsp{};
+		tsp.TexU = 5;
+		tsp.TexV = 5;
+		TCW tcw{};
+		tcw.TexAddr = address >> 3;
+		tcw.PixelFmt = Pixel565;
+		return cache.getTextureCacheData(tsp, tcw);
+	}
+};
+
+TEST_F(TexCacheTest, DataSize)
+{
+	TestTextureCache cache;
+	TestTexture *texture = getTexture(cache, 0);
+	texture->tex_type = TextureType::_565;
+	ASSERT_EQ(256u * 256 * 2, texture->textureDataSize(256, 256, false));
+	texture->tex_type = TextureType::_8888;
+	ASSERT_EQ(256u * 256 * 4, texture->textureDataSize(256, 256, false));
+	// 8x8 + 4x4 + 2x2 + 1x1
+	ASSERT_EQ(85u * 4, texture->textureDataSize(8, 8, true));
+	// 8x2 + 4x1 + 2x1 + 1x1
+	texture->tex_type = TextureType::_8;
+	ASSERT_EQ(23u, texture->textureDataSize(8, 2, true));
+}
+
+TEST_F(TexCacheTest, LruEviction)
+{
+	config::TextureCacheSize = 1;
+	TestTextureCache cache;
+	const u32 textureSize = 256 * 256 * 4;
+	for (u32 i = 0; i < 16; i++)
+	{
+		FrameCount++;
+		TestTexture *texture = getTexture(cache, i * 0x20000);
+		texture->tex_type = TextureType::_8888;
+		texture->gpuSize = texture->textureDataSize(256, 256, false);
+		ASSERT_EQ(textureSize, texture->gpuSize);
+	}
+	FrameCount += 3;
+	// the first texture is used again
+	getTexture(cache, 0);
+	cache.CollectCleanup();
+
+	const TextureCacheStats& stats = cache.getStats();
+	ASSERT_EQ(1u, stats.hits);
+	ASSERT_EQ(16u, stats.misses);
+	ASSERT_LE(stats.hostBytes + stats.gpuBytes, 1_MB);
+	ASSERT_EQ((u64)stats.count * textureSize, stats.gpuBytes);
+	ASSERT_EQ(16u, stats.count + stats.evictions);
+	ASSERT_EQ(textureCacheStats.evictions, stats.evictions);
+	// The least recently used textures are evicted first
+	ASSERT_TRUE(cache.contains(0));
+	ASSERT_TRUE(cache.contains(15 * 0x20000));
+	ASSERT_FALSE(cache.contains(1 * 0x20000));
+	for (u32 i = 1; i < 16 - (stats.count - 1); i++)
+		ASSERT_FALSE(cache.contains(i * 0x20000));
+
+	// Under budget: nothing is evicted
+	u64 evictions = stats.evictions;
+	FrameCount += 10;
+	cache.CollectCleanup();
+	ASSERT_EQ(evictions, cache.getStats().evictions);
+
+	cache.Clear();
+	ASSERT_EQ(0u, textureCacheStats.count);
+}
+
+TEST_F(TexCacheTest, CustomLoadInProgress)
+{
+	config::TextureCacheSize = 1;
+	TestTextureCache cache;
+	for (u32 i = 0; i < 8; i++)
+	{
+		FrameCount++;
+		TestTexture *texture = getTexture(cache, i * 0x20000);
+		texture->gpuSize = 256_KB;
+		if (i == 0)
+			texture->custom_load_in_progress = 1;
+	}
+	FrameCount += 3;
+	cache.CollectCleanup();
+	// the least recently used texture is being loaded and must be kept
+	ASSERT_TRUE(cache.contains(0));
+	ASSERT_FALSE(cache.contains(1 * 0x20000));
+	ASSERT_LE(cache.getStats().hostBytes + cache.getStats().gpuBytes, 1_MB);
+
+	getTexture(cache, 0)->custom_load_in_progress = 0;
+	cache.Clear();
+}
+
+TEST_F(TexCacheTest, Unlimited)
+{
+	config::TextureCacheSize = 0;
+	TestTextureCache cache;
+	for (u32 i = 0; i < 64; i++)
+	{
+		TestTexture *texture = getTexture(cache, i * 0x20000);
+		texture->gpuSize = 1_MB;
+	}
+	FrameCount += 10;
+	cache.CollectCleanup();
+	ASSERT_EQ(64u, cache.getStats().count);
+	ASSERT_EQ(0u, cache.getStats().evictions);
+	ASSERT_EQ(64 * 1_MB, cache.getStats().gpuBytes);
+}
@@ -0,0 +1,170 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "types.h"
+#include "rend/texconv.h"
+#include <chrono>
+#include <random>
+#include <vector>
+
+class TexConvTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		std::mt19937 rng(42);
+		data.resize(MaxSize * MaxSize * 2);
+		for (u8& b : data)
+			b = (u8)rng();
+		codebook.resize(VQ_CODEBOOK_SIZE);
+		for (u8& b : codebook)
+			b = (u8)rng();
+		vq_codebook = codebook.data();
+		for (u32& c : palette16_ram)
+			c = (u16)rng();
+		for (u32& c : palette32_ram)
+			c = rng();
+		palette_index = 16 * 5;
+	}
+
+	void TearDown() override
+	{
+		texconv_fastpath = true;
+		vq_codebook = nullptr;
+	}
+
+	template<typename Pixel, typename Convertor>
+	void compare(const char *name, Convertor convertor, u32 width, u32 height)
+	{
+		if (convertor == nullptr)
+			return;
+		PixelBuffer<Pixel> reference;
+		reference.init(width, height);
+		memset(reference.data(), 0, width * height * sizeof(Pixel));
+		texconv_fastpath = false;
+		convertor(&reference, data.data(), width, height);
+
+		PixelBuffer<Pixel> fast;
+		fast.init(width, height);
+		memset(fast.data(), 0xff, width * height * sizeof(Pixel));
+		texconv_fastpath = true;
+		convertor(&fast, data.data(), width, height);
+
+		ASSERT_EQ(0, memcmp(reference.data(), fast.data(), width * height * sizeof(Pixel)))
+			<< name << " " << width << "x" << height;
+	}
+
+	template<typename Pixel, typename Convertor>
+	void compareMipmaps(const char *name, Convertor convertor, u32 size)
+	{
+		if (convertor == nullptr)
+			return;
+		u32 bufferSize = 0;
+		for (u32 s = size; s != 0; s /= 2)
+			bufferSize += s * s;
+		PixelBuffer<Pixel> reference;
+		reference.init(size, size, true);
+		memset(reference.data(), 0, bufferSize * sizeof(Pixel));
+		PixelBuffer<Pixel> fast;
+		fast.init(size, size, true);
+		memset(fast.data(), 0, bufferSize * sizeof(Pixel));
+		for (u32 level = 3; (1u << level) <= size; level++)
+		{
+			reference.set_mipmap(level);
+			texconv_fastpath = false;
+			convertor(&reference, data.data(), 1 << level, 1 << level);
+			fast.set_mipmap(level);
+			texconv_fastpath = true;
+			convertor(&fast, data.data(), 1 << level, 1 << level);
+		}
+		reference.set_mipmap(0);
+		fast.set_mipmap(0);
+		ASSERT_EQ(0, memcmp(reference.data(), fast.data(), bufferSize * sizeof(Pixel))) << name << " mipmaps";
+	}
+
+	void compareAll(const PvrTexInfo *texInfo)
+	{
+		static const u32 sizes[][2] = {
+			{ 4, 4 }, { 8, 8 }, { 16, 8 }, { 8, 64 }, { 32, 32 }, { 256, 128 }, { 64, 512 }, { MaxSize, MaxSize }
+		};
+		for (int i = 0; i < 7; i++)
+		{
+			const PvrTexInfo& info = texInfo[i];
+			for (const auto& size : sizes)
+			{
+				compare<u16>(info.name, info.TW, size[0], size[1]);
+				compare<u16>(info.name, info.VQ, size[0], size[1]);
+				compare<u32>(info.name, info.TW32, size[0], size[1]);
+				compare<u32>(info.name, info.VQ32, size[0], size[1]);
+				compare<u8>(info.name, info.TW8, size[0], size[1]);
+			}
+			compareMipmaps<u16>(info.name, info.TW, 256);
+			compareMipmaps<u32>(info.name, info.VQ32, 256);
+		}
+	}
+
+	template<typename Pixel, typename Convertor>
+	double texelsPerSecond(Convertor convertor)
+	{
+		PixelBuffer<Pixel> pb;
+		pb.init(MaxSize, MaxSize);
+		constexpr int Iterations = 20;
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < Iterations; i++)
+			convertor(&pb, data.data(), MaxSize, MaxSize);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return MaxSize * MaxSize * Iterations / seconds;
+	}
+
+	template<typename Pixel, typename Convertor>
+	void benchmark(const char *name, Convertor convertor)
+	{
+		texconv_fastpath = false;
+		double reference = texelsPerSecond<Pixel>(convertor);
+		texconv_fastpath = true;
+		double fast = texelsPerSecond<Pixel>(convertor);
+		printf("%-10s reference %7.1f Mtexels/s, fast path %7.1f Mtexels/s (x%.2f)\n", name,
+				reference / 1e6, fast / 1e6, fast / reference);
+	}
+
+	static constexpr u32 MaxSize = 1024;
+	std::vector<u8> data;
+	std::vector<u8> codebook;
+};
+
+TEST_F(TexConvTest, OpenGL)
+{
+	compareAll(opengl::pvrTexInfo);
+}
+
+TEST_F(TexConvTest, DirectX)
+{
+	compareAll(directx::pvrTexInfo);
+}
+
+TEST_F(TexConvTest, Benchmark)
+{
+	benchmark<u16>("565 TW", opengl::pvrTexInfo[1].TW);
+	benchmark<u32>("565 TW32", opengl::pvrTexInfo[1].TW32);
+	benchmark<u32>("1555 VQ32", opengl::pvrTexInfo[0].VQ32);
+	benchmark<u16>("4444 VQ", opengl::pvrTexInfo[2].VQ);
+	benchmark<u32>("pal4 TW32", opengl::pvrTexInfo[5].TW32);
+	benchmark<u32>("pal8 VQ32", opengl::pvrTexInfo[6].VQ32);
+	benchmark<u8>("pal8 TW8", opengl::pvrTexInfo[6].TW8);
+}
@@ -3,8 +3,15 @@
 #include "hw/mem/addrspace.h"
 #include "hw/maple/maple_cfg.h"
 #include "hw/maple/maple_devs.h"
+#include "hw/sh4/sh4_mem.h"
 #include "emulator.h"
 #include "cfg/option.h"
+#include "oslib/directory.h"
+#include "oslib/oslib.h"
+#include "oslib/storage.h"
+#include <nowide/cstdio.hpp>
+#include <fstream>
+#include <iterator>
 
 class SerializeTest : public ::testing::Test {
 protected:
@@ -78,3 +85,131 @@ TEST(SerializerBufferTest, OffByOneOverflowThrowsException)
 	Serializer ser(buffer.data(), buffer.size());
 	ASSERT_THROW(ser.serialize(data.data(), data.size()), Serializer::Exception);
 }
+
+class IncrementalSavestateTest : public ::testing::Test {
+protected:
+	static constexpr u32 RamBase = 0x8c000000;
+
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		emu.init();
+		mem_map_default();
+		emu.dc_reset(true);
+		config::IncrementalSavestates.override(true);
+		settings.content.fileName = "DELTA-TEST.cdi";
+		statePath = hostfs::getSavestatePath(1, true);
+		basePath = statePath + ".base";
+		removeFiles();
+	}
+
+	void TearDown() override
+	{
+		removeFiles();
+		settings.content.fileName.clear();
+		config::IncrementalSavestates.reset();
+	}
+
+	void removeFiles()
+	{
+		nowide::remove(statePath.c_str());
+		nowide::remove(basePath.c_str());
+		nowide::remove((basePath + ".tmp").c_str());
+	}
+
+	// Write a value in each ram page
+	void fillRam(u32 pages, u32 value)
+	{
+		for (u32 i = 0; i < pages; i++)
+			addrspace::write32(RamBase + i * PAGE_SIZE, value + i);
+	}
+
+	void checkRam(u32 pages, u32 value)
+	{
+		for (u32 i = 0; i < pages; i++)
+			ASSERT_EQ(value + i, addrspace::read32(RamBase + i * PAGE_SIZE)) << "page " << i;
+	}
+
+	static std::vector<char> readFile(const std::string& path)
+	{
+		std::ifstream f(path, std::ios::binary);
+		return std::vector<char>(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+	}
+
+	static bool exists(const std::string& path) {
+		return hostfs::storage().exists(path);
+	}
+
+	std::string statePath;
+	std::string basePath;
+};
+
+TEST_F(IncrementalSavestateTest, BaseAndDelta)
+{
+	fillRam(256, 0x1000);
+	dc_savestate(1);
+	ASSERT_TRUE(exists(basePath));
+	ASSERT_FALSE(exists(basePath + ".tmp"));
+	std::vector<char> base = readFile(basePath);
+	ASSERT_FALSE(base.empty());
+
+	// only a few pages changed: the base is kept
+	fillRam(16, 0x2000);
+	dc_savestate(1);
+	ASSERT_EQ(base, readFile(basePath));
+
+	fillRam(256, 0x3000);
+	dc_loadstate(1);
+	checkRam(16, 0x2000);
+	for (u32 i = 16; i < 256; i++)
+		ASSERT_EQ(0x1000 + i, addrspace::read32(RamBase + i * PAGE_SIZE)) << "page " << i;
+
+	// most of ram changed: a new base is written
+	fillRam(RAM_SIZE / PAGE_SIZE, 0x4000);
+	dc_savestate(1);
+	ASSERT_NE(base, readFile(basePath));
+	ASSERT_FALSE(exists(basePath + ".tmp"));
+	fillRam(256, 0x5000);
+	dc_loadstate(1);
+	checkRam(RAM_SIZE / PAGE_SIZE, 0x4000);
+}
+
+TEST_F(IncrementalSavestateTest, FailedSaveKeepsBase)
+{
+#ifdef _WIN32
+	GTEST_SKIP() << "directories can't be removed with nowide::remove";
+#endif
+	fillRam(256, 0x1000);
+	dc_savestate(1);
+	fillRam(16, 0x2000);
+	dc_savestate(1);
+	std::vector<char> base = readFile(basePath);
+	std::vector<char> delta = readFile(statePath);
+
+	// a new base is needed but the savestate file can't be written
+	std::string savedPath = statePath + ".saved";
+	ASSERT_EQ(0, nowide::rename(statePath.c_str(), savedPath.c_str()));
+	ASSERT_EQ(0, flycast::mkdir(statePath.c_str(), 0755));
+	fillRam(RAM_SIZE / PAGE_SIZE, 0x4000);
+	dc_savestate(1);
+	ASSERT_EQ(0, nowide::remove(statePath.c_str()));
+	ASSERT_EQ(0, nowide::rename(savedPath.c_str(), statePath.c_str()));
+
+	// the previous base and delta are still valid
+	ASSERT_EQ(base, readFile(basePath));
+	ASSERT_FALSE(exists(basePath + ".tmp"));
+	dc_loadstate(1);
+	checkRam(16, 0x2000);
+
+	// and the next delta is still made against it
+	fillRam(8, 0x6000);
+	dc_savestate(1);
+	ASSERT_EQ(base, readFile(basePath));
+	ASSERT_NE(delta, readFile(statePath));
+	fillRam(256, 0x5000);
+	dc_loadstate(1);
+	checkRam(8, 0x6000);
+	for (u32 i = 8; i < 16; i++)
+		ASSERT_EQ(0x2000 + i, addrspace::read32(RamBase + i * PAGE_SIZE)) << "page " << i;
+}
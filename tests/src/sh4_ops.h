@@ -77,6 +77,7 @@ protected:
 	u32& macl() { return ctx->mac.h; }
 	sr_t& sr() { return ctx->sr; }
 	f32& fr(int regNum) { checkedRegs.insert((u32 *)&ctx->fr[regNum]); return ctx->fr[regNum]; }
+	f32& xf(int regNum) { checkedRegs.insert((u32 *)&ctx->xf[regNum]); return ctx->xf[regNum]; }
 	double getDr(int regNum) {
 		checkedRegs.insert((u32 *)&ctx->fr[regNum * 2]);
 		checkedRegs.insert((u32 *)&ctx->fr[regNum * 2 + 1]);
@@ -1349,6 +1350,59 @@ protected:
 		AssertState();
 	}
 
+	void VectorTest()
+	{
+		ctx->fpscr.PR = 0;
+
+		ClearRegs();
+		fr(0) = 1.f;
+		fr(1) = 2.f;
+		fr(2) = 3.f;
+		fr(3) = 4.f;
+		fr(4) = 5.f;
+		fr(5) = 6.f;
+		fr(6) = 7.f;
+		fr(7) = 8.f;
+		PrepareOp(0xF4ED);	// fipr fv0, fv4
+		RunOp();
+		ASSERT_EQ(fr(7), 70.f);
+		ASSERT_EQ(fr(4), 5.f);
+		ASSERT_EQ(fr(3), 4.f);
+		AssertState();
+		// intermediate results are computed in double precision
+		fr(0) = 1e8f;
+		fr(1) = 1.f;
+		fr(2) = -1e8f;
+		fr(3) = 1.f;
+		fr(4) = 1.f;
+		fr(5) = 1.f;
+		fr(6) = 1.f;
+		fr(7) = 1.f;
+		RunOp();
+		ASSERT_EQ(fr(7), 2.f);
+		AssertState();
+
+		ClearRegs();
+		for (int i = 0; i < 16; i++)
+			xf(i) = 0.f;
+		xf(0) = xf(4) = xf(8) = xf(12) = 1.f;
+		xf(1) = 2.f;
+		xf(6) = 3.f;
+		xf(15) = 0.5f;
+		fr(8) = 1e8f;
+		fr(9) = 1.f;
+		fr(10) = -1e8f;
+		fr(11) = 1.f;
+		PrepareOp(0xF9FD);	// ftrv xmtrx, fv8
+		RunOp();
+		ASSERT_EQ(fr(8), 2.f);
+		ASSERT_EQ(fr(9), 2e8f);
+		ASSERT_EQ(fr(10), 3.f);
+		ASSERT_EQ(fr(11), 0.5f);
+		ASSERT_EQ(xf(1), 2.f);
+		AssertState();
+	}
+
 	void DoubleFloatingPointTest()
 	{
 		ctx->fpscr.PR = 1;
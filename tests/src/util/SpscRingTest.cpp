@@ -0,0 +1,137 @@
+#include "gtest/gtest.h"
+#include "util/spsc_ring.h"
+#include "util/tsqueue.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+class SpscRingTest : public ::testing::Test
+{
+};
+
+TEST_F(SpscRingTest, Basic)
+{
+	SpscRing ring(16);
+	ASSERT_EQ(16u, ring.capacity());
+	ASSERT_TRUE(ring.empty());
+	ASSERT_TRUE(ring.tryPush(42));
+	ASSERT_FALSE(ring.empty());
+	ASSERT_EQ(1u, ring.size());
+	u8 b;
+	ASSERT_TRUE(ring.tryPop(b));
+	ASSERT_EQ(42, b);
+	ASSERT_FALSE(ring.tryPop(b));
+
+	const u8 data[] = { 1, 2, 3, 4, 5 };
+	ASSERT_EQ(5u, ring.tryPush(data, sizeof(data)));
+	ASSERT_EQ(5u, ring.size());
+	u8 out[8] {};
+	ASSERT_EQ(5u, ring.tryPop(out, sizeof(out)));
+	ASSERT_EQ(0, memcmp(data, out, sizeof(data)));
+	ASSERT_TRUE(ring.empty());
+}
+
+TEST_F(SpscRingTest, Capacity)
+{
+	SpscRing ring(10);
+	ASSERT_EQ(16u, ring.capacity());
+	u8 data[20];
+	for (unsigned i = 0; i < sizeof(data); i++)
+		data[i] = i;
+	ASSERT_EQ(16u, ring.available());
+	ASSERT_EQ(16u, ring.tryPush(data, sizeof(data)));
+	ASSERT_EQ(0u, ring.available());
+	ASSERT_FALSE(ring.tryPush(0));
+	u8 out[4];
+	ASSERT_EQ(4u, ring.tryPop(out, sizeof(out)));
+	ASSERT_EQ(4u, ring.available());
+	ring.clear();
+	ASSERT_TRUE(ring.empty());
+	ASSERT_EQ(16u, ring.available());
+	ASSERT_TRUE(ring.tryPush(0));
+}
+
+TEST_F(SpscRingTest, WrapAround)
+{
+	SpscRing ring(16);
+	u8 data[12];
+	u8 out[12];
+	for (int round = 0; round < 10; round++)
+	{
+		for (unsigned i = 0; i < sizeof(data); i++)
+			data[i] = round * 16 + i;
+		ASSERT_EQ(sizeof(data), ring.tryPush(data, sizeof(data)));
+		ASSERT_EQ(sizeof(out), ring.tryPop(out, sizeof(out)));
+		ASSERT_EQ(0, memcmp(data, out, sizeof(data)));
+	}
+}
+
+TEST_F(SpscRingTest, MultiThread)
+{
+	SpscRing ring(1024);
+	constexpr size_t Size = 1'000'000;
+	std::thread producer([&ring]() {
+		u8 data[100];
+		for (size_t i = 0; i < Size; i += sizeof(data))
+		{
+			for (size_t j = 0; j < sizeof(data); j++)
+				data[j] = (u8)(i + j);
+			ring.push(data, sizeof(data));
+		}
+	});
+	u8 data[77];
+	size_t count = 0;
+	bool ok = true;
+	while (count < Size)
+	{
+		size_t len = ring.tryPop(data, std::min(sizeof(data), Size - count));
+		if (len == 0)
+			std::this_thread::yield();
+		for (size_t i = 0; i < len; i++)
+			ok = ok && data[i] == (u8)(count + i);
+		count += len;
+	}
+	producer.join();
+	ASSERT_TRUE(ok);
+	ASSERT_TRUE(ring.empty());
+}
+
+// Compare the throughput of TsQueue<u8> and SpscRing between two threads
+TEST_F(SpscRingTest, Throughput)
+{
+	constexpr size_t Size = 4_MB;
+	using clock = std::chrono::steady_clock;
+
+	TsQueue<u8> queue;
+	auto start = clock::now();
+	std::thread producer([&queue]() {
+		for (size_t i = 0; i < Size; i++)
+			queue.push((u8)i);
+	});
+	for (size_t i = 0; i < Size; i++)
+		queue.pop();
+	producer.join();
+	double queueTime = std::chrono::duration<double>(clock::now() - start).count();
+
+	SpscRing ring(64_KB);
+	start = clock::now();
+	producer = std::thread([&ring]() {
+		std::vector<u8> data(1500);
+		for (size_t i = 0; i < Size; i += data.size())
+			ring.push(data.data(), std::min(data.size(), Size - i));
+	});
+	std::vector<u8> data(1500);
+	for (size_t count = 0; count < Size; )
+	{
+		size_t len = ring.tryPop(data.data(), data.size());
+		if (len == 0)
+			std::this_thread::yield();
+		count += len;
+	}
+	producer.join();
+	double ringTime = std::chrono::duration<double>(clock::now() - start).count();
+
+	printf("TsQueue<u8>: %.1f MB/s, SpscRing: %.1f MB/s\n",
+			Size / queueTime / 1_MB, Size / ringTime / 1_MB);
+	ASSERT_TRUE(ring.empty());
+}